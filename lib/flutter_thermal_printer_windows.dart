@@ -13,6 +13,7 @@ export 'src/models/exceptions.dart';
 export 'src/models/pairing_result.dart';
 export 'src/models/printer_capabilities.dart';
 export 'src/models/printer_status.dart';
+export 'src/models/provisioning.dart';
 export 'src/models/receipt.dart';
 export 'src/pairing_manager.dart';
 export 'src/printer_scanner.dart';
@@ -11,6 +11,7 @@ import 'src/models/enums.dart';
 import 'src/models/pairing_result.dart';
 import 'src/models/printer_capabilities.dart';
 import 'src/models/printer_status.dart';
+import 'src/models/provisioning.dart';
 
 /// An implementation of [FlutterThermalPrinterWindowsPlatform] that uses method channels.
 class MethodChannelFlutterThermalPrinterWindows
@@ -19,6 +20,15 @@ class MethodChannelFlutterThermalPrinterWindows
   @visibleForTesting
   final methodChannel = const MethodChannel('flutter_thermal_printer_windows');
 
+  /// Provisioning progress of all runs; each event carries its run's id.
+  @visibleForTesting
+  final provisioningChannel = const EventChannel(
+    'flutter_thermal_printer_windows/provisioning',
+  );
+
+  Stream<Map<Object?, Object?>>? _provisioningEvents;
+  int _provisioningRuns = 0;
+
   @override
   Future<String?> getPlatformVersion() async {
     final version = await methodChannel.invokeMethod<String>(
@@ -168,7 +178,53 @@ class MethodChannelFlutterThermalPrinterWindows
   ) async {
     await methodChannel.invokeMethod<void>('sendRawCommands', <String, Object?>{
       'printer': printer.toMap(),
-      'bytes': commands.toList(),
+      'bytes': commands,
+    });
+  }
+
+  @override
+  Future<void> printImage(
+    BluetoothPrinter printer,
+    Uint8List pixels,
+    int width,
+    int height, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int? targetWidth,
+    ImageResampleFilter filter = ImageResampleFilter.auto,
+    bool dither = true,
+    int threshold = 128,
+  }) async {
+    await methodChannel.invokeMethod<void>('printImage', <String, Object?>{
+      'printer': printer.toMap(),
+      'pixels': pixels,
+      'width': width,
+      'height': height,
+      'format': format.index,
+      'targetWidth': targetWidth ?? 0,
+      'filter': filter.index,
+      'dither': dither,
+      'threshold': threshold,
+    });
+  }
+
+  @override
+  Future<void> printBarcode(
+    BluetoothPrinter printer,
+    String data,
+    BarcodeType type, {
+    QrErrorCorrection errorCorrection = QrErrorCorrection.medium,
+    int? moduleSize,
+    int? height,
+    BarcodeRendering rendering = BarcodeRendering.auto,
+  }) async {
+    await methodChannel.invokeMethod<void>('printBarcode', <String, Object?>{
+      'printer': printer.toMap(),
+      'data': data,
+      'symbology': type.index,
+      'errorCorrection': errorCorrection.index,
+      'moduleSize': moduleSize ?? 0,
+      'height': height ?? 0,
+      'rendering': rendering.index,
     });
   }
 
@@ -195,6 +251,91 @@ class MethodChannelFlutterThermalPrinterWindows
     return _decodeCapabilities(result);
   }
 
+  @override
+  Future<PrinterCapabilities> probePrinterCapabilities(
+    BluetoothPrinter printer,
+  ) async {
+    final result = await methodChannel.invokeMethod<Map<Object?, Object?>>(
+      'probePrinterCapabilities',
+      printer.toMap(),
+    );
+    return _decodeCapabilities(result);
+  }
+
+  @override
+  Future<List<ProvisioningResult>> provisionPrinters(
+    List<BluetoothPrinter> printers, {
+    ProvisioningOptions options = const ProvisioningOptions(),
+    void Function(ProvisioningEvent event)? onEvent,
+  }) async {
+    final runId =
+        '${DateTime.now().microsecondsSinceEpoch}-${_provisioningRuns++}';
+    StreamSubscription<Map<Object?, Object?>>? subscription;
+    if (onEvent != null) {
+      // One native listener serves every run; listen before starting so no
+      // early event is missed.
+      _provisioningEvents ??= provisioningChannel
+          .receiveBroadcastStream()
+          .where((e) => e is Map)
+          .map((e) => e as Map<Object?, Object?>);
+      subscription = _provisioningEvents!
+          .where((e) => e['runId'] == runId)
+          .listen((e) => onEvent(_decodeProvisioningEvent(e)));
+    }
+    try {
+      final result = await methodChannel
+          .invokeMethod<List<Object?>>('provisionPrinters', <String, Object?>{
+            'runId': runId,
+            'ids': printers.map((p) => p.id).toList(),
+            'maxConcurrent': options.maxConcurrent,
+            'maxAttempts': options.maxAttempts,
+            'initialBackoffMs': options.initialBackoff.inMilliseconds,
+            'maxBackoffMs': options.maxBackoff.inMilliseconds,
+            'stepTimeoutMs': options.stepTimeout.inMilliseconds,
+            'pair': options.pair,
+            'probe': options.probe,
+            'testPrint': options.testPrint,
+            if (options.testPage != null) 'testPage': options.testPage,
+          });
+      if (result == null) return [];
+      return result
+          .whereType<Map<Object?, Object?>>()
+          .map(_decodeProvisioningResult)
+          .toList();
+    } finally {
+      await subscription?.cancel();
+    }
+  }
+
+  static ProvisioningStep _decodeProvisioningStep(Object? name) =>
+      ProvisioningStep.values.asNameMap()[name] ?? ProvisioningStep.connect;
+
+  static ProvisioningEvent _decodeProvisioningEvent(Map<Object?, Object?> m) {
+    int i(key) => (m[key] as int?) ?? 0;
+    return ProvisioningEvent(
+      printerId: (m['id'] as String?) ?? '',
+      kind:
+          ProvisioningEventKind.values.asNameMap()[m['event']] ??
+          ProvisioningEventKind.stepStarted,
+      step: _decodeProvisioningStep(m['step']),
+      attempt: i('attempt'),
+      retryIn: Duration(milliseconds: i('retryInMs')),
+      elapsed: Duration(milliseconds: i('elapsedMs')),
+    );
+  }
+
+  static ProvisioningResult _decodeProvisioningResult(
+    Map<Object?, Object?> m,
+  ) {
+    return ProvisioningResult(
+      printerId: (m['id'] as String?) ?? '',
+      isSuccess: (m['ok'] as bool?) ?? false,
+      step: _decodeProvisioningStep(m['step']),
+      attempts: (m['attempts'] as int?) ?? 0,
+      elapsed: Duration(milliseconds: (m['elapsedMs'] as int?) ?? 0),
+    );
+  }
+
   @override
   Future<PrinterStatus> getPrinterStatus(BluetoothPrinter printer) async {
     final result = await methodChannel.invokeMethod<Map<Object?, Object?>>(
@@ -204,6 +345,54 @@ class MethodChannelFlutterThermalPrinterWindows
     return _decodeStatus(result);
   }
 
+  @override
+  Future<void> startTraceCapture(String path) async {
+    await methodChannel.invokeMethod<void>('startTraceCapture', <String, Object?>{
+      'path': path,
+    });
+  }
+
+  @override
+  Future<int> stopTraceCapture() async {
+    final records = await methodChannel.invokeMethod<int>('stopTraceCapture');
+    return records ?? 0;
+  }
+
+  @override
+  Future<void> setQueryCacheTtl(Duration ttl) async {
+    await methodChannel.invokeMethod<void>('setQueryCacheTtl', <String, Object?>{
+      'ttlMs': ttl.inMilliseconds,
+    });
+  }
+
+  @override
+  Future<void> setSpanTracing(bool enabled) async {
+    await methodChannel.invokeMethod<void>('setSpanTracing', <String, Object?>{
+      'enabled': enabled,
+    });
+  }
+
+  @override
+  Future<String> exportSpanTrace({bool clear = true}) async {
+    final json = await methodChannel.invokeMethod<String>(
+      'exportSpanTrace',
+      <String, Object?>{'clear': clear},
+    );
+    return json ?? '{"traceEvents":[]}';
+  }
+
+  @override
+  Future<Map<String, int>> getNativeMetrics() async {
+    final result = await methodChannel.invokeMethod<Map<Object?, Object?>>(
+      'getNativeMetrics',
+    );
+    if (result == null) return {};
+    return {
+      for (final e in result.entries)
+        if (e.key is String && e.value is int) e.key as String: e.value as int,
+    };
+  }
+
   static PrinterCapabilities _decodeCapabilities(Map<Object?, Object?>? m) {
     if (m == null) {
       return PrinterCapabilities(
@@ -217,6 +406,16 @@ class MethodChannelFlutterThermalPrinterWindows
     Object? v(key) => m[key];
     int i(key) => (v(key) as int?) ?? 58;
     bool b(key) => (v(key) as bool?) ?? false;
+    String? str(key) {
+      final s = v(key) as String?;
+      return s == null || s.isEmpty ? null : s;
+    }
+
+    int? positive(key) {
+      final n = v(key) as int?;
+      return n == null || n <= 0 ? null : n;
+    }
+
     List<BarcodeType> bar(List<Object?>? list) {
       if (list == null) return BarcodeType.values;
       return list
@@ -243,6 +442,15 @@ class MethodChannelFlutterThermalPrinterWindows
       supportedBarcodes: bar(v('supportedBarcodes') as List<Object?>?),
       supportedFontSizes: fonts(v('supportedFontSizes') as List<Object?>?),
       supportsPartialCut: b('supportsPartialCut'),
+      isProbed: b('probed'),
+      modelName: str('modelName'),
+      manufacturer: str('manufacturer'),
+      firmwareVersion: str('firmwareVersion'),
+      dotsPerLine: positive('dotsPerLine'),
+      supportsRasterImages: (v('supportsRasterImages') as bool?) ?? true,
+      supportsStatus: b('supportsStatus'),
+      writeChunkSize: positive('writeChunkSize'),
+      supportsBarcodeCommands: b('supportsBarcodeCommands'),
     );
   }
 
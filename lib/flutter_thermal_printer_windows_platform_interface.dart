@@ -6,9 +6,11 @@ import 'flutter_thermal_printer_windows_method_channel.dart';
 import 'src/models/bluetooth_printer.dart';
 import 'src/models/connection_result.dart';
 import 'src/models/connection_state.dart';
+import 'src/models/enums.dart';
 import 'src/models/pairing_result.dart';
 import 'src/models/printer_capabilities.dart';
 import 'src/models/printer_status.dart';
+import 'src/models/provisioning.dart';
 
 abstract class FlutterThermalPrinterWindowsPlatform extends PlatformInterface {
   /// Constructs a FlutterThermalPrinterWindowsPlatform.
@@ -80,6 +82,43 @@ abstract class FlutterThermalPrinterWindowsPlatform extends PlatformInterface {
     throw UnimplementedError('sendRawCommands() has not been implemented.');
   }
 
+  /// Prints a grayscale or RGBA bitmap through the native banded raster
+  /// pipeline (scale to [targetWidth] dots, by default the paper width, with
+  /// [filter], keeping the aspect ratio; dither; GS v 0 bands). Memory use does not grow with image height
+  /// and printing starts with the first band.
+  Future<void> printImage(
+    BluetoothPrinter printer,
+    Uint8List pixels,
+    int width,
+    int height, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int? targetWidth,
+    ImageResampleFilter filter = ImageResampleFilter.auto,
+    bool dither = true,
+    int threshold = 128,
+  }) {
+    throw UnimplementedError('printImage() has not been implemented.');
+  }
+
+  /// Prints [data] as a [type] barcode or QR code on [printer].
+  ///
+  /// With [BarcodeRendering.auto], printers known to support barcode
+  /// commands draw the symbol themselves; others get a native 1bpp raster
+  /// (QR with [errorCorrection], Code 128, EAN-13, EAN-8) whose modules are
+  /// [moduleSize] dots, reduced to fit the print head. Rasters are cached by
+  /// content. [height] is the bar height in dots for linear barcodes.
+  Future<void> printBarcode(
+    BluetoothPrinter printer,
+    String data,
+    BarcodeType type, {
+    QrErrorCorrection errorCorrection = QrErrorCorrection.medium,
+    int? moduleSize,
+    int? height,
+    BarcodeRendering rendering = BarcodeRendering.auto,
+  }) {
+    throw UnimplementedError('printBarcode() has not been implemented.');
+  }
+
   /// Returns paired Bluetooth printers.
   Future<List<BluetoothPrinter>> getPairedPrinters() {
     throw UnimplementedError('getPairedPrinters() has not been implemented.');
@@ -92,8 +131,67 @@ abstract class FlutterThermalPrinterWindowsPlatform extends PlatformInterface {
     );
   }
 
+  /// Probes the connected [printer] again (model, supported commands) and
+  /// returns the persisted result. Printers are also probed automatically on
+  /// their first connection.
+  Future<PrinterCapabilities> probePrinterCapabilities(
+    BluetoothPrinter printer,
+  ) {
+    throw UnimplementedError(
+      'probePrinterCapabilities() has not been implemented.',
+    );
+  }
+
+  /// Pairs, connects, probes and test-prints each of [printers], at most
+  /// [ProvisioningOptions.maxConcurrent] at a time, retrying failed steps with
+  /// backoff. Progress is reported to [onEvent]; returns one result per
+  /// printer, in order.
+  Future<List<ProvisioningResult>> provisionPrinters(
+    List<BluetoothPrinter> printers, {
+    ProvisioningOptions options = const ProvisioningOptions(),
+    void Function(ProvisioningEvent event)? onEvent,
+  }) {
+    throw UnimplementedError('provisionPrinters() has not been implemented.');
+  }
+
   /// Returns current status for [printer] (connected, paper, error).
   Future<PrinterStatus> getPrinterStatus(BluetoothPrinter printer) {
     throw UnimplementedError('getPrinterStatus() has not been implemented.');
   }
+
+  /// Starts recording every native write, flush and status read per device,
+  /// with job boundaries, to the binary trace file at [path]. Replay it with
+  /// the `trace_replay` host tool (see `windows/tools`).
+  Future<void> startTraceCapture(String path) {
+    throw UnimplementedError('startTraceCapture() has not been implemented.');
+  }
+
+  /// Stops trace capture. Returns the number of records written.
+  Future<int> stopTraceCapture() {
+    throw UnimplementedError('stopTraceCapture() has not been implemented.');
+  }
+
+  /// Reuses scan, paired-list and LAN status results for [ttl] after they
+  /// complete. Concurrent identical queries always share one native
+  /// operation; [Duration.zero] (the default) disables the cache.
+  Future<void> setQueryCacheTtl(Duration ttl) {
+    throw UnimplementedError('setQueryCacheTtl() has not been implemented.');
+  }
+
+  /// Starts or stops recording timing spans of native stages (method
+  /// dispatch, MTA queue wait, connect, write, flush, result encoding).
+  Future<void> setSpanTracing(bool enabled) {
+    throw UnimplementedError('setSpanTracing() has not been implemented.');
+  }
+
+  /// Returns the recorded spans as Chrome trace-event JSON. With [clear],
+  /// returned spans are not returned again.
+  Future<String> exportSpanTrace({bool clear = true}) {
+    throw UnimplementedError('exportSpanTrace() has not been implemented.');
+  }
+
+  /// Returns native counters and timings (e.g. `startup.all_printers_ready_ms`).
+  Future<Map<String, int>> getNativeMetrics() {
+    throw UnimplementedError('getNativeMetrics() has not been implemented.');
+  }
 }
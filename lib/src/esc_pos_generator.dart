@@ -78,18 +78,64 @@ class EscPosGenerator {
   // --- Image: monochrome raster (GS v 0) ---
   /// Print monochrome raster image. [imageData] is 1 bit per pixel (MSB first),
   /// [width] and [height] in pixels. Each row padded to multiple of 8 bits.
+  /// Emits GS v 0 m xL xH yL yH, with x in bytes per row and y in dots.
   Uint8List printImage(Uint8List imageData, int width, int height) {
     if (width <= 0 || height <= 0) return Uint8List(0);
-    return Uint8List.fromList([
-      _gs,
-      0x76,
-      0x30,
-      (width >> 0) & 0xFF,
-      (width >> 8) & 0xFF,
-      (height >> 0) & 0xFF,
-      (height >> 8) & 0xFF,
-      ...imageData,
-    ]);
+    final rowBytes = (width + 7) >> 3;
+    final out = Uint8List(8 + imageData.length);
+    out[0] = _gs;
+    out[1] = 0x76;
+    out[2] = 0x30;
+    out[3] = 0;
+    out[4] = (rowBytes >> 0) & 0xFF;
+    out[5] = (rowBytes >> 8) & 0xFF;
+    out[6] = (height >> 0) & 0xFF;
+    out[7] = (height >> 8) & 0xFF;
+    out.setRange(8, out.length, imageData);
+    return out;
+  }
+
+  /// Scales a [width] x [height] grayscale or RGBA bitmap to [targetWidth]
+  /// dots (nearest neighbour, aspect ratio kept) and thresholds it to 1bpp
+  /// rows of `(targetWidth + 7) >> 3` bytes. Transparent pixels are white.
+  ///
+  /// Pure-Dart fallback for [PrintEngine.generateEscPosCommands]; printing
+  /// through [PrintEngine.sendPrintJob] uses the native resampler instead.
+  static Uint8List bitmapToMonochrome(
+    Uint8List pixels,
+    int width,
+    int height,
+    int targetWidth, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int threshold = 128,
+  }) {
+    if (width <= 0 || height <= 0 || targetWidth <= 0) return Uint8List(0);
+    final bpp = format == ImagePixelFormat.rgba8888 ? 4 : 1;
+    final outHeight = ((height * targetWidth + width ~/ 2) ~/ width).clamp(
+      1,
+      0xFFFF,
+    );
+    final rowBytes = (targetWidth + 7) >> 3;
+    final out = Uint8List(rowBytes * outHeight);
+    for (var y = 0; y < outHeight; y++) {
+      final sy = ((2 * y + 1) * height) ~/ (2 * outHeight);
+      for (var x = 0; x < targetWidth; x++) {
+        final sx = ((2 * x + 1) * width) ~/ (2 * targetWidth);
+        final i = (sy * width + sx) * bpp;
+        if (i + bpp > pixels.length) continue;
+        var v = pixels[i];
+        if (bpp == 4) {
+          final luma =
+              (pixels[i] * 77 + pixels[i + 1] * 150 + pixels[i + 2] * 29) >> 8;
+          final alpha = pixels[i + 3];
+          v = (luma * alpha + 255 * (255 - alpha) + 127) ~/ 255;
+        }
+        if (v < threshold) {
+          out[y * rowBytes + (x >> 3)] |= 0x80 >> (x & 7);
+        }
+      }
+    }
+    return out;
   }
 
   /// Convert RGBA or grayscale image bytes to 1bpp (black/white) for thermal.
@@ -137,7 +183,16 @@ class EscPosGenerator {
       case BarcodeType.qrCode:
         return printQrCode(data, 4);
     }
-    final bytes = utf8.encode(data);
+    List<int> bytes = utf8.encode(data);
+    if (type == BarcodeType.code128) {
+      // Function B form: the data must open with a code set selector and
+      // any literal '{' is doubled.
+      bytes = [
+        0x7B,
+        0x42,
+        for (final b in bytes) ...(b == 0x7B ? [0x7B, 0x7B] : [b]),
+      ];
+    }
     if (bytes.length > 255) return Uint8List(0);
     return Uint8List.fromList([
       _gs,
@@ -148,12 +203,16 @@ class EscPosGenerator {
     ]);
   }
 
-  /// Print QR code. [data] content, [size] module size (1-16, typically 4-8).
-  Uint8List printQrCode(String data, int size) {
+  /// Print QR code. [data] content, [size] module size (1-16, typically 4-8),
+  /// [errorCorrection] the recovery level (printer default when null).
+  Uint8List printQrCode(
+    String data,
+    int size, {
+    QrErrorCorrection? errorCorrection,
+  }) {
     final s = size.clamp(1, 16);
     final bytes = utf8.encode(data);
-    // GS ( k - QR code model/store/print
-    // Simplified: use GS ( k with model 2, store and print
+    // GS ( k - QR code model, size, level, store and print
     final len = bytes.length + 3;
     final pL = len & 0xFF;
     final pH = (len >> 8) & 0xFF;
@@ -167,9 +226,6 @@ class EscPosGenerator {
       65,
       50,
       0,
-      pL,
-      pH,
-      ...bytes,
       _gs,
       0x28,
       0x6B,
@@ -178,6 +234,25 @@ class EscPosGenerator {
       49,
       67,
       s,
+      if (errorCorrection != null) ...[
+        _gs,
+        0x28,
+        0x6B,
+        3,
+        0,
+        49,
+        69,
+        48 + errorCorrection.index,
+      ],
+      _gs,
+      0x28,
+      0x6B,
+      pL,
+      pH,
+      49,
+      80,
+      48,
+      ...bytes,
       _gs,
       0x28,
       0x6B,
@@ -13,6 +13,25 @@ class BluetoothPrinter {
     this.capabilities,
   });
 
+  /// A LAN printer on its raw print port (usually 9100). No pairing is
+  /// needed: [ThermalPrinterWindows.connect], printing and
+  /// [ThermalPrinterWindows.getPrinterStatus] work with it directly.
+  factory BluetoothPrinter.network({
+    required String host,
+    int port = 9100,
+    String? name,
+  }) {
+    final address = host.contains(':') ? '[$host]' : host;
+    return BluetoothPrinter(
+      id: 'tcp:$address:$port',
+      name: name ?? host,
+      macAddress: '',
+      signalStrength: 0,
+      isPaired: true,
+      connectionState: ConnectionState.disconnected,
+    );
+  }
+
   final String id;
   final String name;
   final String macAddress;
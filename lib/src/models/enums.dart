@@ -21,6 +21,47 @@ enum BarcodeType {
   qrCode,
 }
 
+/// QR code error correction: share of the symbol that can be damaged and
+/// still read (about 7%, 15%, 25% and 30%). Higher levels need a larger
+/// symbol for the same data.
+enum QrErrorCorrection {
+  low,
+  medium,
+  quartile,
+  high,
+}
+
+/// How a barcode or QR code is printed.
+enum BarcodeRendering {
+  /// The printer's own barcode commands when it is known to support them
+  /// (`PrinterCapabilities.supportsBarcodeCommands`), otherwise a native
+  /// raster image.
+  auto,
+
+  /// `GS k` / `GS ( k`; the printer draws the symbol.
+  printerCommands,
+
+  /// Encoded natively and printed as a 1bpp image. Code 39 is not supported.
+  raster,
+}
+
+/// Pixel layout of a source bitmap sent to the native raster pipeline.
+enum ImagePixelFormat {
+  gray8,
+  rgba8888,
+}
+
+/// How the native raster pipeline scales a bitmap to the printer dot width.
+enum ImageResampleFilter {
+  /// Area average when shrinking, bilinear when enlarging.
+  auto,
+  nearest,
+  bilinear,
+
+  /// Box average over each dot's footprint; sharpest for shrunk logos.
+  area,
+}
+
 /// Type of item in a receipt.
 enum ReceiptItemType {
   text,
@@ -1,6 +1,10 @@
 import 'enums.dart';
 
 /// Describes printer hardware capabilities.
+///
+/// Printers are probed natively on their first connection (or with
+/// `probePrinterCapabilities`); the result is persisted per device. Until
+/// then [isProbed] is false and the values are defaults.
 class PrinterCapabilities {
   const PrinterCapabilities({
     required this.maxPaperWidth,
@@ -9,6 +13,15 @@ class PrinterCapabilities {
     required this.supportedBarcodes,
     required this.supportedFontSizes,
     this.supportsPartialCut = false,
+    this.isProbed = false,
+    this.modelName,
+    this.manufacturer,
+    this.firmwareVersion,
+    this.dotsPerLine,
+    this.supportsRasterImages = true,
+    this.supportsStatus = false,
+    this.writeChunkSize,
+    this.supportsBarcodeCommands = false,
   });
 
   final int maxPaperWidth;
@@ -17,4 +30,30 @@ class PrinterCapabilities {
   final List<BarcodeType> supportedBarcodes;
   final List<FontSize> supportedFontSizes;
   final bool supportsPartialCut;
+
+  /// Whether the values come from probing the printer.
+  final bool isProbed;
+
+  /// Model, maker and firmware as reported by the printer (`GS I`), if any.
+  final String? modelName;
+  final String? manufacturer;
+  final String? firmwareVersion;
+
+  /// Print head width in dots, if known. Native image printing never
+  /// exceeds it.
+  final int? dotsPerLine;
+
+  /// Whether the printer takes `GS v 0` raster images; otherwise images are
+  /// sent as `ESC *` strips.
+  final bool supportsRasterImages;
+
+  /// Whether the printer answers real-time status requests (`DLE EOT`).
+  final bool supportsStatus;
+
+  /// Receive buffer in bytes, if known. Image bands are sized to fit it.
+  final int? writeChunkSize;
+
+  /// Whether the printer is known to draw barcodes and QR codes itself
+  /// (`GS k`, `GS ( k`). Otherwise `printBarcode` sends them as images.
+  final bool supportsBarcodeCommands;
 }
@@ -0,0 +1,107 @@
+import 'dart:typed_data';
+
+/// Stages of provisioning one printer, in the order they run.
+enum ProvisioningStep { pair, connect, probe, testPrint }
+
+/// Kind of a [ProvisioningEvent].
+enum ProvisioningEventKind {
+  stepStarted,
+  stepSucceeded,
+
+  /// The step failed and runs again after [ProvisioningEvent.retryIn].
+  stepRetrying,
+
+  /// Every step succeeded.
+  deviceSucceeded,
+
+  /// A step failed on its last attempt; later steps were skipped.
+  deviceFailed,
+}
+
+/// Settings for `provisionPrinters`.
+class ProvisioningOptions {
+  const ProvisioningOptions({
+    this.maxConcurrent = 4,
+    this.maxAttempts = 3,
+    this.initialBackoff = const Duration(seconds: 1),
+    this.maxBackoff = const Duration(seconds: 16),
+    this.stepTimeout = const Duration(seconds: 60),
+    this.pair = true,
+    this.probe = true,
+    this.testPrint = true,
+    this.testPage,
+  });
+
+  /// Printers worked on at once.
+  final int maxConcurrent;
+
+  /// Attempts per step before the printer is given up.
+  final int maxAttempts;
+
+  /// Delay before the first retry of a step; doubled for each later retry up
+  /// to [maxBackoff].
+  final Duration initialBackoff;
+  final Duration maxBackoff;
+
+  /// A step still running after this counts as a failed attempt.
+  /// [Duration.zero] disables the timeout.
+  final Duration stepTimeout;
+
+  /// Pair Bluetooth printers first (LAN printers skip pairing).
+  final bool pair;
+
+  /// Probe capabilities after connecting.
+  final bool probe;
+
+  /// Print [testPage] (or a short built-in page) last.
+  final bool testPrint;
+
+  /// ESC/POS bytes for the test print.
+  final Uint8List? testPage;
+}
+
+/// Progress of one printer during `provisionPrinters`.
+class ProvisioningEvent {
+  const ProvisioningEvent({
+    required this.printerId,
+    required this.kind,
+    required this.step,
+    this.attempt = 0,
+    this.retryIn = Duration.zero,
+    this.elapsed = Duration.zero,
+  });
+
+  final String printerId;
+  final ProvisioningEventKind kind;
+
+  /// Step concerned; for device events the last step attempted.
+  final ProvisioningStep step;
+
+  /// 1-based attempt of [step].
+  final int attempt;
+  final Duration retryIn;
+
+  /// Time since this printer started provisioning.
+  final Duration elapsed;
+}
+
+/// Outcome for one printer of `provisionPrinters`.
+class ProvisioningResult {
+  const ProvisioningResult({
+    required this.printerId,
+    required this.isSuccess,
+    required this.step,
+    this.attempts = 0,
+    this.elapsed = Duration.zero,
+  });
+
+  final String printerId;
+  final bool isSuccess;
+
+  /// Step that failed, or the last one run on success.
+  final ProvisioningStep step;
+
+  /// Attempts over all steps, retries included.
+  final int attempts;
+  final Duration elapsed;
+}
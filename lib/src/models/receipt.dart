@@ -3,12 +3,45 @@ import 'dart:typed_data';
 import 'enums.dart';
 import 'exceptions.dart';
 
+/// Checks that [data] holds whole rows of a [width]-pixel [format] bitmap.
+/// A null [width] means [data] is already packed 1bpp at the paper width.
+void _validateBitmap(
+  Uint8List? data,
+  int? width,
+  ImagePixelFormat format,
+  String what,
+) {
+  if (width == null || data == null || data.isEmpty) return;
+  final rowBytes = width * (format == ImagePixelFormat.rgba8888 ? 4 : 1);
+  if (width <= 0 || data.length % rowBytes != 0) {
+    throw ValidationException(
+      '$what: imageData length ${data.length} is not a whole number of '
+      '$width-pixel ${format.name} rows',
+    );
+  }
+}
+
 /// Header section of a receipt (e.g. logo, store name).
+///
+/// [imageData] is packed 1bpp at the paper width, unless [imageWidth] is
+/// set: then it is a grayscale or RGBA bitmap ([imageFormat]) of any size,
+/// scaled to the paper width when printed.
 class ReceiptHeader {
-  const ReceiptHeader({this.text, this.imageData});
+  const ReceiptHeader({
+    this.text,
+    this.imageData,
+    this.imageWidth,
+    this.imageFormat = ImagePixelFormat.gray8,
+  });
 
   final String? text;
   final Uint8List? imageData;
+  final int? imageWidth;
+  final ImagePixelFormat imageFormat;
+
+  /// Throws [ValidationException] if the image bitmap is malformed.
+  void validate() =>
+      _validateBitmap(imageData, imageWidth, imageFormat, 'Header');
 }
 
 /// Footer section of a receipt (e.g. thank you message).
@@ -40,21 +73,34 @@ class BarcodeData {
     required this.type,
     this.height,
     this.width,
+    this.errorCorrection = QrErrorCorrection.medium,
   });
 
   final String data;
   final BarcodeType type;
+
+  /// Bar height in dots (linear barcodes).
   final int? height;
+
+  /// Dots per QR module or per narrowest bar.
   final int? width;
+
+  /// QR codes only.
+  final QrErrorCorrection errorCorrection;
 }
 
 /// A single item in a receipt (text, image, barcode, etc.).
+///
+/// Image items follow the same [imageData] / [imageWidth] rules as
+/// [ReceiptHeader].
 class ReceiptItem {
   const ReceiptItem({
     required this.type,
     this.text,
     this.style,
     this.imageData,
+    this.imageWidth,
+    this.imageFormat = ImagePixelFormat.gray8,
     this.barcodeData,
   });
 
@@ -62,6 +108,8 @@ class ReceiptItem {
   final String? text;
   final TextStyle? style;
   final Uint8List? imageData;
+  final int? imageWidth;
+  final ImagePixelFormat imageFormat;
   final BarcodeData? barcodeData;
 
   /// Validates item; throws [ValidationException] if type and content mismatch.
@@ -80,6 +128,7 @@ class ReceiptItem {
             'ReceiptItem type is image but imageData is null or empty',
           );
         }
+        _validateBitmap(imageData, imageWidth, imageFormat, 'ReceiptItem');
         break;
       case ReceiptItemType.barcode:
       case ReceiptItemType.qrCode:
@@ -142,6 +191,7 @@ class Receipt {
   /// Validates receipt; throws [ValidationException] if invalid.
   void validate() {
     settings.validate();
+    header?.validate();
     for (var i = 0; i < items.length; i++) {
       try {
         items[i].validate();
@@ -34,72 +34,129 @@ class PrintEngine {
   final Map<String, Future<void>> _printerQueues = {};
 
   /// Converts [receipt] to ESC/POS command bytes.
+  ///
+  /// Bitmap images (`imageWidth` set) are scaled and thresholded in Dart
+  /// here, and barcodes use the printer's own commands; [sendPrintJob] hands
+  /// both to the native pipeline instead.
   /// Throws [ValidationException] if [receipt] is invalid.
   Uint8List generateEscPosCommands(Receipt receipt) {
+    final out = BytesBuilder(copy: false);
+    for (final part in _receiptParts(receipt, native: false)) {
+      out.add(part as Uint8List);
+    }
+    return out.takeBytes();
+  }
+
+  /// Splits [receipt] into ESC/POS byte chunks and, when [native] is true,
+  /// [_ReceiptBitmap]s and [BarcodeData] to be printed through the native
+  /// pipeline.
+  List<Object> _receiptParts(Receipt receipt, {required bool native}) {
     receipt.validate();
-    final out = <int>[];
-    out.addAll(_generator.initializePrinter());
-    out.addAll(_generator.setAlignment(receipt.settings.defaultAlignment));
-
-    if (receipt.header != null) {
-      if (receipt.header!.text != null && receipt.header!.text!.isNotEmpty) {
-        out.addAll(_generator.setAlignment(TextAlignment.center));
-        out.addAll(_generator.printText(receipt.header!.text!));
-        out.addAll(_generator.setAlignment(receipt.settings.defaultAlignment));
+    final parts = <Object>[];
+    final out = BytesBuilder(copy: false);
+    final dots = receipt.settings.paperWidth * 8;
+
+    void addImage(Uint8List data, int? width, ImagePixelFormat format) {
+      if (width == null) {
+        // Legacy: packed 1bpp, already at the paper width.
+        final h = (data.length * 8 / dots).ceil().clamp(1, 0xFFFF);
+        out.add(_generator.printImage(data, dots, h));
+        return;
+      }
+      final bpp = format == ImagePixelFormat.rgba8888 ? 4 : 1;
+      final height = data.length ~/ (width * bpp);
+      if (native) {
+        if (out.isNotEmpty) parts.add(out.takeBytes());
+        parts.add(_ReceiptBitmap(data, width, height, format, dots));
+        return;
+      }
+      final mono = EscPosGenerator.bitmapToMonochrome(
+        data,
+        width,
+        height,
+        dots,
+        format: format,
+      );
+      final rows = mono.length ~/ ((dots + 7) >> 3);
+      out.add(_generator.printImage(mono, dots, rows));
+    }
+
+    void addBarcode(BarcodeData barcode) {
+      if (native) {
+        if (out.isNotEmpty) parts.add(out.takeBytes());
+        parts.add(barcode);
+        return;
       }
-      if (receipt.header!.imageData != null &&
-          receipt.header!.imageData!.isNotEmpty) {
-        final w = receipt.settings.paperWidth * 8;
-        final h = (receipt.header!.imageData!.length * 8 / w).ceil().clamp(
-          1,
-          0xFFFF,
+      if (barcode.type == BarcodeType.qrCode) {
+        out.add(
+          _generator.printQrCode(
+            barcode.data,
+            barcode.width ?? 4,
+            errorCorrection: barcode.errorCorrection,
+          ),
         );
-        out.addAll(_generator.printImage(receipt.header!.imageData!, w, h));
+      } else {
+        out.add(_generator.printBarcode(barcode.data, barcode.type));
+      }
+    }
+
+    out.add(_generator.initializePrinter());
+    out.add(_generator.setAlignment(receipt.settings.defaultAlignment));
+
+    final header = receipt.header;
+    if (header != null) {
+      if (header.text != null && header.text!.isNotEmpty) {
+        out.add(_generator.setAlignment(TextAlignment.center));
+        out.add(_generator.printText(header.text!));
+        out.add(_generator.setAlignment(receipt.settings.defaultAlignment));
+      }
+      if (header.imageData != null && header.imageData!.isNotEmpty) {
+        addImage(header.imageData!, header.imageWidth, header.imageFormat);
       }
     }
 
     for (final item in receipt.items) {
       final style = item.style;
       if (style != null) {
-        out.addAll(_generator.setBold(style.bold));
-        out.addAll(_generator.setUnderline(style.underline));
-        out.addAll(_generator.setFontSize(style.fontSize));
-        out.addAll(_generator.setAlignment(style.alignment));
+        out.add(_generator.setBold(style.bold));
+        out.add(_generator.setUnderline(style.underline));
+        out.add(_generator.setFontSize(style.fontSize));
+        out.add(_generator.setAlignment(style.alignment));
       }
       switch (item.type) {
         case ReceiptItemType.text:
           if (item.text != null && item.text!.isNotEmpty) {
-            out.addAll(_generator.printText(item.text!));
+            out.add(_generator.printText(item.text!));
           }
           break;
         case ReceiptItemType.image:
           if (item.imageData != null && item.imageData!.isNotEmpty) {
-            final w = receipt.settings.paperWidth * 8;
-            final h = (item.imageData!.length * 8 / w).ceil().clamp(1, 0xFFFF);
-            out.addAll(_generator.printImage(item.imageData!, w, h));
+            addImage(item.imageData!, item.imageWidth, item.imageFormat);
           }
           break;
         case ReceiptItemType.barcode:
-          if (item.barcodeData != null) {
-            out.addAll(
-              _generator.printBarcode(
-                item.barcodeData!.data,
-                item.barcodeData!.type,
-              ),
-            );
-          }
+          if (item.barcodeData != null) addBarcode(item.barcodeData!);
           break;
         case ReceiptItemType.qrCode:
-          if (item.barcodeData != null) {
-            final size = item.barcodeData!.width ?? 4;
-            out.addAll(_generator.printQrCode(item.barcodeData!.data, size));
+          final barcode = item.barcodeData;
+          if (barcode != null) {
+            addBarcode(
+              barcode.type == BarcodeType.qrCode
+                  ? barcode
+                  : BarcodeData(
+                      data: barcode.data,
+                      type: BarcodeType.qrCode,
+                      width: barcode.width,
+                      errorCorrection: barcode.errorCorrection,
+                    ),
+            );
           }
           break;
         case ReceiptItemType.line:
-          out.addAll(_generator.feedLines(1));
+          out.add(_generator.feedLines(1));
           break;
         case ReceiptItemType.spacer:
-          out.addAll(_generator.feedLines(2));
+          out.add(_generator.feedLines(2));
           break;
       }
     }
@@ -107,30 +164,49 @@ class PrintEngine {
     if (receipt.footer != null &&
         receipt.footer!.text != null &&
         receipt.footer!.text!.isNotEmpty) {
-      out.addAll(_generator.setAlignment(TextAlignment.center));
-      out.addAll(_generator.printText(receipt.footer!.text!));
-      out.addAll(_generator.setAlignment(receipt.settings.defaultAlignment));
+      out.add(_generator.setAlignment(TextAlignment.center));
+      out.add(_generator.printText(receipt.footer!.text!));
+      out.add(_generator.setAlignment(receipt.settings.defaultAlignment));
     }
 
-    out.addAll(_generator.feedLines(receipt.settings.feedLinesAfterCut));
+    out.add(_generator.feedLines(receipt.settings.feedLinesAfterCut));
     if (receipt.settings.autoCut) {
-      out.addAll(_generator.cutPaper());
+      out.add(_generator.cutPaper());
     }
-    return Uint8List.fromList(out);
+    parts.add(out.takeBytes());
+    return parts;
   }
 
   /// Sends [job] to [printer]. Queued per printer; runs sequentially.
   Future<void> sendPrintJob(BluetoothPrinter printer, PrintJob job) {
     return _enqueue(printer.id, () async {
-      Uint8List bytes;
       if (job.receipt != null) {
-        bytes = generateEscPosCommands(job.receipt!);
+        for (final part in _receiptParts(job.receipt!, native: true)) {
+          if (part is _ReceiptBitmap) {
+            await _platform.printImage(
+              printer,
+              part.pixels,
+              part.width,
+              part.height,
+              format: part.format,
+              targetWidth: part.targetWidth,
+            );
+          } else if (part is BarcodeData) {
+            await _platform.printBarcode(
+              printer,
+              part.data,
+              part.type,
+              errorCorrection: part.errorCorrection,
+              moduleSize: part.width,
+              height: part.height,
+            );
+          } else {
+            await _platform.sendRawCommands(printer, part as Uint8List);
+          }
+        }
       } else if (job.rawBytes != null && job.rawBytes!.isNotEmpty) {
-        bytes = job.rawBytes!;
-      } else {
-        return;
+        await _platform.sendRawCommands(printer, job.rawBytes!);
       }
-      await _platform.sendRawCommands(printer, bytes);
     });
   }
 
@@ -139,6 +215,59 @@ class PrintEngine {
     return sendPrintJob(printer, PrintJob.raw(commands));
   }
 
+  /// Prints a bitmap through the native pipeline (queued like
+  /// [sendPrintJob], so its bands do not interleave with other jobs for
+  /// [printer]).
+  Future<void> printImage(
+    BluetoothPrinter printer,
+    Uint8List pixels,
+    int width,
+    int height, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int? targetWidth,
+    ImageResampleFilter filter = ImageResampleFilter.auto,
+    bool dither = true,
+  }) {
+    return _enqueue(
+      printer.id,
+      () => _platform.printImage(
+        printer,
+        pixels,
+        width,
+        height,
+        format: format,
+        targetWidth: targetWidth,
+        filter: filter,
+        dither: dither,
+      ),
+    );
+  }
+
+  /// Prints a barcode or QR code natively (queued like [sendPrintJob]); see
+  /// [FlutterThermalPrinterWindowsPlatform.printBarcode].
+  Future<void> printBarcode(
+    BluetoothPrinter printer,
+    String data,
+    BarcodeType type, {
+    QrErrorCorrection errorCorrection = QrErrorCorrection.medium,
+    int? moduleSize,
+    int? height,
+    BarcodeRendering rendering = BarcodeRendering.auto,
+  }) {
+    return _enqueue(
+      printer.id,
+      () => _platform.printBarcode(
+        printer,
+        data,
+        type,
+        errorCorrection: errorCorrection,
+        moduleSize: moduleSize,
+        height: height,
+        rendering: rendering,
+      ),
+    );
+  }
+
   Future<void> _enqueue(String printerId, Future<void> Function() work) async {
     final previous = _printerQueues[printerId] ?? Future.value();
     final next = previous.then((_) => work());
@@ -149,3 +278,20 @@ class PrintEngine {
     }
   }
 }
+
+/// A receipt image sent to the native raster pipeline as-is.
+class _ReceiptBitmap {
+  const _ReceiptBitmap(
+    this.pixels,
+    this.width,
+    this.height,
+    this.format,
+    this.targetWidth,
+  );
+
+  final Uint8List pixels;
+  final int width;
+  final int height;
+  final ImagePixelFormat format;
+  final int targetWidth;
+}
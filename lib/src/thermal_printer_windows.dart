@@ -10,6 +10,7 @@ import 'models/enums.dart';
 import 'models/exceptions.dart';
 import 'models/printer_capabilities.dart';
 import 'models/printer_status.dart';
+import 'models/provisioning.dart';
 import 'pairing_manager.dart';
 import 'print_engine.dart';
 import 'printer_scanner.dart';
@@ -32,7 +33,18 @@ class ThermalPrinterWindows {
 
   PrinterScanner get _scanner => PrinterScanner(platform: _platform);
   PairingManager get _pairingManager => PairingManager(platform: _platform);
-  PrintEngine get _printEngine => PrintEngine(platform: _platform);
+  /// One engine per platform instance: its per-printer queue is what keeps
+  /// receipts, raw bytes and images from interleaving on the wire.
+  PrintEngine? _engine;
+  FlutterThermalPrinterWindowsPlatform? _enginePlatform;
+  PrintEngine get _printEngine {
+    final platform = _platform;
+    if (_engine == null || !identical(_enginePlatform, platform)) {
+      _engine = PrintEngine(platform: platform);
+      _enginePlatform = platform;
+    }
+    return _engine!;
+  }
 
   /// Default scan timeout (30 seconds per requirements).
   static const Duration defaultScanTimeout = Duration(seconds: 30);
@@ -180,14 +192,161 @@ class ThermalPrinterWindows {
     }
   }
 
+  /// Prints a [width] x [height] bitmap ([format] grayscale or RGBA) on
+  /// [printer], scaled to [targetWidth] dots (e.g. 384 for 58 mm paper) with
+  /// [filter], keeping the aspect ratio. Without [targetWidth] the image fills
+  /// the printer's paper width; it is never printed wider than the head.
+  ///
+  /// Conversion runs natively in fixed-height bands, so large images do not
+  /// need to be converted to 1bpp in Dart first.
+  Future<void> printImage(
+    BluetoothPrinter printer,
+    Uint8List pixels,
+    int width,
+    int height, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int? targetWidth,
+    ImageResampleFilter filter = ImageResampleFilter.auto,
+    bool dither = true,
+  }) async {
+    try {
+      await _printEngine.printImage(
+        printer,
+        pixels,
+        width,
+        height,
+        format: format,
+        targetWidth: targetWidth,
+        filter: filter,
+        dither: dither,
+      );
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
+  /// Prints [data] as a [type] barcode or QR code on [printer].
+  ///
+  /// Printers that do not draw barcodes themselves (most unbranded units)
+  /// get a native raster of the symbol at whole-dot module sizes, cached by
+  /// content; see [BarcodeRendering] to force either way.
+  Future<void> printBarcode(
+    BluetoothPrinter printer,
+    String data,
+    BarcodeType type, {
+    QrErrorCorrection errorCorrection = QrErrorCorrection.medium,
+    int? moduleSize,
+    int? height,
+    BarcodeRendering rendering = BarcodeRendering.auto,
+  }) async {
+    try {
+      await _printEngine.printBarcode(
+        printer,
+        data,
+        type,
+        errorCorrection: errorCorrection,
+        moduleSize: moduleSize,
+        height: height,
+        rendering: rendering,
+      );
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
   /// Returns capabilities for [printer].
   Future<PrinterCapabilities> getPrinterCapabilities(
     BluetoothPrinter printer,
   ) => _platform.getPrinterCapabilities(printer);
 
+  /// Probes the connected [printer] again (model, supported commands,
+  /// receive buffer) and returns the stored result. Printers are probed
+  /// automatically on their first connection; call this after a firmware
+  /// update or when a different printer took over the same address.
+  Future<PrinterCapabilities> probePrinterCapabilities(
+    BluetoothPrinter printer,
+  ) async {
+    try {
+      return await _platform.probePrinterCapabilities(printer);
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
+  /// Sets up a batch of printers (e.g. a new store): pairs, connects, probes
+  /// and test-prints each one, [ProvisioningOptions.maxConcurrent] at a time.
+  /// A failed step is retried with exponential backoff; a printer that still
+  /// fails does not hold up the others. [onEvent] receives per-printer
+  /// progress. Returns one result per printer, in the order given.
+  Future<List<ProvisioningResult>> provisionPrinters(
+    List<BluetoothPrinter> printers, {
+    ProvisioningOptions options = const ProvisioningOptions(),
+    void Function(ProvisioningEvent event)? onEvent,
+  }) async {
+    try {
+      return await _platform.provisionPrinters(
+        printers,
+        options: options,
+        onEvent: onEvent,
+      );
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
   /// Returns current status for [printer].
   Future<PrinterStatus> getPrinterStatus(BluetoothPrinter printer) =>
       _platform.getPrinterStatus(printer);
+
+  /// Starts capturing native printer traffic to the binary trace file at
+  /// [path], for reproducing slow or garbled prints with `trace_replay`.
+  Future<void> startTraceCapture(String path) async {
+    try {
+      await _platform.startTraceCapture(path);
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
+  /// Stops trace capture and returns the number of records written.
+  Future<int> stopTraceCapture() => _platform.stopTraceCapture();
+
+  /// Lets repeated scans, paired-printer lists and LAN status checks reuse a
+  /// result for [ttl] (e.g. several screens refreshing at once). Concurrent
+  /// identical queries share one native operation regardless of the TTL.
+  Future<void> setQueryCacheTtl(Duration ttl) async {
+    try {
+      await _platform.setQueryCacheTtl(ttl);
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
+  /// Starts or stops recording timing spans of the native hot paths. Off by
+  /// default; recording costs a few hundred nanoseconds per span.
+  Future<void> setSpanTracing(bool enabled) async {
+    try {
+      await _platform.setSpanTracing(enabled);
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
+  /// Returns the spans recorded since the last export as Chrome trace-event
+  /// JSON; save it to a file and open it in https://ui.perfetto.dev or
+  /// chrome://tracing.
+  Future<String> exportSpanTrace({bool clear = true}) async {
+    try {
+      return await _platform.exportSpanTrace(clear: clear);
+    } on PlatformException catch (e) {
+      throw ThermalPrinterException.fromPlatform(e);
+    }
+  }
+
+  /// Returns native counters and timings, such as time-to-ready after startup
+  /// (`startup.worker_ready_ms`, `startup.first_printer_ready_ms`,
+  /// `startup.all_printers_ready_ms`).
+  Future<Map<String, int>> getNativeMetrics() => _platform.getNativeMetrics();
 }
 
 /// Formats [error] as a user-friendly string for [operation].
@@ -90,6 +90,21 @@ void main() {
     });
   });
 
+  group('BluetoothPrinter.network', () {
+    test('uses a tcp id with the raw port by default', () {
+      final p = BluetoothPrinter.network(host: '192.168.1.50');
+      expect(p.id, 'tcp:192.168.1.50:9100');
+      expect(p.name, '192.168.1.50');
+      expect(p.isPaired, isTrue);
+    });
+
+    test('brackets IPv6 hosts', () {
+      final p = BluetoothPrinter.network(host: 'fe80::1', port: 9101, name: 'Bar');
+      expect(p.id, 'tcp:[fe80::1]:9101');
+      expect(p.name, 'Bar');
+    });
+  });
+
   group('PrinterCapabilities', () {
     test('maxPaperWidth 0 is allowed by model', () {
       const c = PrinterCapabilities(
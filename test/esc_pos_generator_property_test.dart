@@ -74,9 +74,31 @@ void main() {
         final rowBytes = (8 + 7) >> 3;
         final data = Uint8List(rowBytes * 8);
         final cmd = generator.printImage(data, 8, 8);
-        expect(cmd.length, greaterThanOrEqualTo(7 + data.length));
-        expect(cmd[0], 0x1D);
-        expect(cmd[1], 0x76);
+        expect(cmd.length, 8 + data.length);
+        // GS v 0 m xL xH yL yH: width in bytes, height in dots.
+        expect(cmd.sublist(0, 8), [0x1D, 0x76, 0x30, 0, 1, 0, 8, 0]);
+      });
+
+      test('bitmapToMonochrome scales to the target width', () {
+        // 4x2 gray: left half black, right half white.
+        final pixels = Uint8List.fromList([0, 0, 255, 255, 0, 0, 255, 255]);
+        final mono = EscPosGenerator.bitmapToMonochrome(pixels, 4, 2, 16);
+        expect(mono.length, 2 * 8); // 16 dots = 2 bytes, 8 rows
+        for (var y = 0; y < 8; y++) {
+          expect(mono.sublist(y * 2, y * 2 + 2), [0xFF, 0x00]);
+        }
+        // Fully transparent RGBA prints nothing.
+        final rgba = Uint8List(4 * 4);
+        expect(
+          EscPosGenerator.bitmapToMonochrome(
+            rgba,
+            2,
+            2,
+            8,
+            format: ImagePixelFormat.rgba8888,
+          ),
+          everyElement(0),
+        );
       });
 
       test('printBarcode returns non-empty bytes for Code128 and Code39', () {
@@ -100,6 +122,26 @@ void main() {
         expect(generator.printQrCode('', 1), isNotEmpty);
       });
 
+      test('printQrCode stores data with fn 80 and sets the level', () {
+        final bytes = generator.printQrCode(
+          'hi',
+          4,
+          errorCorrection: QrErrorCorrection.high,
+        );
+        String hex(List<int> b) => b.map((v) => '$v,').join();
+        expect(hex(bytes), contains(hex([0x1D, 0x28, 0x6B, 3, 0, 49, 69, 51])));
+        expect(
+          hex(bytes),
+          contains(hex([0x1D, 0x28, 0x6B, 5, 0, 49, 80, 48, 0x68, 0x69])),
+        );
+      });
+
+      test('printBarcode selects a Code128 code set', () {
+        expect(generator.printBarcode('A{', BarcodeType.code128), [
+          0x1D, 0x6B, 73, 5, 0x7B, 0x42, 0x41, 0x7B, 0x7B, //
+        ]);
+      });
+
       test('imageToMonochrome produces 1bpp bitmap', () {
         final pixels = Uint8List.fromList(List.filled(16 * 16, 0));
         for (var i = 0; i < 64; i++) {
@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_test/flutter_test.dart';
 import 'package:flutter_thermal_printer_windows/flutter_thermal_printer_windows.dart';
@@ -130,4 +132,247 @@ void main() {
     final state = await platform.getConnectionState(printer);
     expect(state, ConnectionState.connected);
   });
+
+  test('getNativeMetrics decodes int metrics from channel', () async {
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          if (methodCall.method == 'getNativeMetrics') {
+            return <String, Object?>{
+              'startup.worker_ready_ms': 12,
+              'startup.all_printers_ready_ms': 850,
+            };
+          }
+          return null;
+        });
+    final metrics = await platform.getNativeMetrics();
+    expect(metrics['startup.worker_ready_ms'], 12);
+    expect(metrics['startup.all_printers_ready_ms'], 850);
+  });
+
+  test('span tracing toggles and exports through the channel', () async {
+    final calls = <MethodCall>[];
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          calls.add(methodCall);
+          if (methodCall.method == 'exportSpanTrace') {
+            return '{"displayTimeUnit":"ms","traceEvents":[]}';
+          }
+          return null;
+        });
+    await platform.setSpanTracing(true);
+    final json = await platform.exportSpanTrace(clear: false);
+    expect(calls[0].method, 'setSpanTracing');
+    expect(calls[0].arguments, {'enabled': true});
+    expect(calls[1].method, 'exportSpanTrace');
+    expect(calls[1].arguments, {'clear': false});
+    expect(json, contains('traceEvents'));
+  });
+
+  test('printImage sends pixels as bytes with size and format', () async {
+    MethodCall? call;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          call = methodCall;
+          return null;
+        });
+    final printer = BluetoothPrinter(
+      id: 'p1',
+      name: 'POS',
+      macAddress: 'AA:BB:CC:DD:EE:FF',
+      signalStrength: -50,
+      isPaired: true,
+      connectionState: ConnectionState.connected,
+      capabilities: null,
+    );
+    final pixels = Uint8List(4 * 2 * 2);
+    await platform.printImage(
+      printer,
+      pixels,
+      2,
+      2,
+      format: ImagePixelFormat.rgba8888,
+      targetWidth: 384,
+      filter: ImageResampleFilter.area,
+    );
+    expect(call?.method, 'printImage');
+    final args = call!.arguments as Map<Object?, Object?>;
+    expect(args['pixels'], isA<Uint8List>());
+    expect(args['width'], 2);
+    expect(args['height'], 2);
+    expect(args['format'], ImagePixelFormat.rgba8888.index);
+    expect(args['targetWidth'], 384);
+    expect(args['filter'], ImageResampleFilter.area.index);
+  });
+
+  test('printBarcode sends symbology, level and sizes', () async {
+    MethodCall? call;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          call = methodCall;
+          return null;
+        });
+    final printer = BluetoothPrinter.network(host: '10.0.0.9');
+    await platform.printBarcode(
+      printer,
+      'https://example.com',
+      BarcodeType.qrCode,
+      errorCorrection: QrErrorCorrection.high,
+      moduleSize: 6,
+      rendering: BarcodeRendering.raster,
+    );
+    expect(call?.method, 'printBarcode');
+    final args = call!.arguments as Map<Object?, Object?>;
+    expect(args['data'], 'https://example.com');
+    expect(args['symbology'], BarcodeType.qrCode.index);
+    expect(args['errorCorrection'], QrErrorCorrection.high.index);
+    expect(args['moduleSize'], 6);
+    expect(args['height'], 0);
+    expect(args['rendering'], BarcodeRendering.raster.index);
+  });
+
+  test('probePrinterCapabilities decodes probed fields', () async {
+    MethodCall? call;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          call = methodCall;
+          return <String, Object?>{
+            'maxPaperWidth': 80,
+            'supportsCutting': true,
+            'supportsImages': true,
+            'supportsPartialCut': true,
+            'probed': true,
+            'modelName': 'TM-T20II',
+            'manufacturer': 'EPSON',
+            'firmwareVersion': '',
+            'dotsPerLine': 576,
+            'supportsRasterImages': true,
+            'supportsStatus': true,
+            'writeChunkSize': 4096,
+          };
+        });
+    final caps = await platform.probePrinterCapabilities(
+      BluetoothPrinter(
+        id: 'id1',
+        name: 'POS',
+        macAddress: 'AA:BB:CC:DD:EE:FF',
+        signalStrength: -50,
+        isPaired: true,
+        connectionState: ConnectionState.connected,
+      ),
+    );
+    expect(call?.method, 'probePrinterCapabilities');
+    expect((call!.arguments as Map<Object?, Object?>)['id'], 'id1');
+    expect(caps.isProbed, isTrue);
+    expect(caps.maxPaperWidth, 80);
+    expect(caps.modelName, 'TM-T20II');
+    expect(caps.manufacturer, 'EPSON');
+    expect(caps.firmwareVersion, isNull);
+    expect(caps.dotsPerLine, 576);
+    expect(caps.supportsStatus, isTrue);
+    expect(caps.writeChunkSize, 4096);
+  });
+
+  test('provisionPrinters sends options and routes events by run', () async {
+    const events = EventChannel('flutter_thermal_printer_windows/provisioning');
+    MockStreamHandlerEventSink? sink;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockStreamHandler(
+          events,
+          MockStreamHandler.inline(
+            onListen: (Object? arguments, MockStreamHandlerEventSink events) {
+              sink = events;
+            },
+          ),
+        );
+    MethodCall? call;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          call = methodCall;
+          final runId =
+              (methodCall.arguments as Map<Object?, Object?>)['runId'];
+          sink!.success(<String, Object?>{
+            'runId': 'another-run',
+            'id': 'other',
+            'event': 'stepStarted',
+            'step': 'pair',
+          });
+          sink!.success(<String, Object?>{
+            'runId': runId,
+            'id': 'tcp:10.0.0.5:9100',
+            'event': 'stepRetrying',
+            'step': 'connect',
+            'attempt': 1,
+            'retryInMs': 500,
+            'elapsedMs': 40,
+          });
+          await Future<void>.delayed(Duration.zero);
+          return <Object?>[
+            <String, Object?>{
+              'id': 'tcp:10.0.0.5:9100',
+              'ok': true,
+              'step': 'testPrint',
+              'attempts': 4,
+              'elapsedMs': 900,
+            },
+          ];
+        });
+    final received = <ProvisioningEvent>[];
+    final results = await platform.provisionPrinters(
+      [BluetoothPrinter.network(host: '10.0.0.5')],
+      options: const ProvisioningOptions(
+        maxConcurrent: 2,
+        initialBackoff: Duration(milliseconds: 500),
+        pair: false,
+      ),
+      onEvent: received.add,
+    );
+    expect(call?.method, 'provisionPrinters');
+    final args = call!.arguments as Map<Object?, Object?>;
+    expect(args['ids'], ['tcp:10.0.0.5:9100']);
+    expect(args['maxConcurrent'], 2);
+    expect(args['initialBackoffMs'], 500);
+    expect(args['pair'], isFalse);
+    expect(args.containsKey('testPage'), isFalse);
+    expect(received, hasLength(1));
+    expect(received.single.kind, ProvisioningEventKind.stepRetrying);
+    expect(received.single.step, ProvisioningStep.connect);
+    expect(received.single.retryIn, const Duration(milliseconds: 500));
+    expect(results.single.isSuccess, isTrue);
+    expect(results.single.step, ProvisioningStep.testPrint);
+    expect(results.single.attempts, 4);
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockStreamHandler(events, null);
+  });
+
+  test('setQueryCacheTtl sends milliseconds', () async {
+    MethodCall? call;
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          call = methodCall;
+          return null;
+        });
+    await platform.setQueryCacheTtl(const Duration(seconds: 2));
+    expect(call?.method, 'setQueryCacheTtl');
+    expect((call!.arguments as Map<Object?, Object?>)['ttlMs'], 2000);
+  });
+
+  test('trace capture passes path and returns record count', () async {
+    final calls = <MethodCall>[];
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(channel, (MethodCall methodCall) async {
+          calls.add(methodCall);
+          if (methodCall.method == 'stopTraceCapture') return 42;
+          return null;
+        });
+    await platform.startTraceCapture('C:/traces/store1.ftpt');
+    expect(await platform.stopTraceCapture(), 42);
+    expect(calls.map((c) => c.method), [
+      'startTraceCapture',
+      'stopTraceCapture',
+    ]);
+    expect(
+      (calls.first.arguments as Map<Object?, Object?>)['path'],
+      'C:/traces/store1.ftpt',
+    );
+  });
 }
@@ -53,6 +53,30 @@ class MockFlutterThermalPrinterWindowsPlatform
   Future<void> sendRawCommands(BluetoothPrinter printer, Uint8List commands) =>
       Future.value();
 
+  @override
+  Future<void> printImage(
+    BluetoothPrinter printer,
+    Uint8List pixels,
+    int width,
+    int height, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int? targetWidth,
+    ImageResampleFilter filter = ImageResampleFilter.auto,
+    bool dither = true,
+    int threshold = 128,
+  }) => Future.value();
+
+  @override
+  Future<void> printBarcode(
+    BluetoothPrinter printer,
+    String data,
+    BarcodeType type, {
+    QrErrorCorrection errorCorrection = QrErrorCorrection.medium,
+    int? moduleSize,
+    int? height,
+    BarcodeRendering rendering = BarcodeRendering.auto,
+  }) => Future.value();
+
   @override
   Future<List<BluetoothPrinter>> getPairedPrinters() =>
       Future.value(scanResult ?? []);
@@ -70,6 +94,25 @@ class MockFlutterThermalPrinterWindowsPlatform
     ),
   );
 
+  @override
+  Future<PrinterCapabilities> probePrinterCapabilities(
+    BluetoothPrinter printer,
+  ) => getPrinterCapabilities(printer);
+
+  @override
+  Future<List<ProvisioningResult>> provisionPrinters(
+    List<BluetoothPrinter> printers, {
+    ProvisioningOptions options = const ProvisioningOptions(),
+    void Function(ProvisioningEvent event)? onEvent,
+  }) => Future.value([
+    for (final p in printers)
+      ProvisioningResult(
+        printerId: p.id,
+        isSuccess: true,
+        step: ProvisioningStep.testPrint,
+      ),
+  ]);
+
   @override
   Future<PrinterStatus> getPrinterStatus(BluetoothPrinter printer) =>
       Future.value(
@@ -77,6 +120,27 @@ class MockFlutterThermalPrinterWindowsPlatform
           isConnected: connectionState == ConnectionState.connected,
         ),
       );
+
+  @override
+  Future<void> startTraceCapture(String path) => Future.value();
+
+  @override
+  Future<int> stopTraceCapture() => Future.value(0);
+
+  @override
+  Future<void> setQueryCacheTtl(Duration ttl) => Future.value();
+
+  @override
+  Future<void> setSpanTracing(bool enabled) => Future.value();
+
+  @override
+  Future<String> exportSpanTrace({bool clear = true}) =>
+      Future.value('{"traceEvents":[]}');
+
+  Map<String, int>? nativeMetrics;
+  @override
+  Future<Map<String, int>> getNativeMetrics() =>
+      Future.value(nativeMetrics ?? {});
 }
 
 void main() {
@@ -47,6 +47,115 @@ void main() {
           expect(order.length, 5);
         },
       );
+
+      test('bitmap receipt images go to the native pipeline in order', () async {
+        final sent = <String>[];
+        final mock = MockPrintPlatform((printer, bytes) async {
+          sent.add('raw');
+        });
+        mock.onImage = (width, height, targetWidth) {
+          sent.add('image ${width}x$height -> $targetWidth');
+        };
+        final printer = BluetoothPrinter.network(host: '10.0.0.9');
+        final receipt = Receipt(
+          items: [
+            ReceiptItem(type: ReceiptItemType.text, text: 'Before'),
+            ReceiptItem(
+              type: ReceiptItemType.image,
+              imageData: Uint8List(4 * 300 * 100),
+              imageWidth: 300,
+              imageFormat: ImagePixelFormat.rgba8888,
+            ),
+            ReceiptItem(type: ReceiptItemType.text, text: 'After'),
+          ],
+          settings: ReceiptSettings(paperWidth: 48),
+        );
+        await PrintEngine(
+          platform: mock,
+        ).sendPrintJob(printer, PrintJob.receipt(receipt));
+        expect(sent, ['raw', 'image 300x100 -> 384', 'raw']);
+
+        // The Dart fallback scales the same image into one GS v 0 block of
+        // 384 dots (48 bytes) x 128 rows.
+        final bytes = PrintEngine().generateEscPosCommands(receipt);
+        final gsv = bytes.indexOf(0x76);
+        expect(bytes.sublist(gsv - 1, gsv + 7), [0x1D, 0x76, 0x30, 0, 48, 0, 128, 0]);
+      });
+
+      test('printImage waits for earlier jobs on the same printer', () async {
+        final sent = <String>[];
+        final mock = MockPrintPlatform((printer, bytes) async {
+          sent.add('raw start');
+          await Future.delayed(Duration(milliseconds: 10));
+          sent.add('raw end');
+        });
+        mock.onImage = (width, height, targetWidth) => sent.add('image');
+        final printer = BluetoothPrinter.network(host: '10.0.0.9');
+        final engine = PrintEngine(platform: mock);
+        await Future.wait([
+          engine.sendRawCommands(printer, Uint8List.fromList([0x0A])),
+          engine.printImage(printer, Uint8List(4), 2, 2),
+        ]);
+        expect(sent, ['raw start', 'raw end', 'image']);
+      });
+
+      test('printBarcode waits for earlier jobs on the same printer', () async {
+        final sent = <String>[];
+        final mock = MockPrintPlatform((printer, bytes) async {
+          sent.add('raw start');
+          await Future.delayed(Duration(milliseconds: 10));
+          sent.add('raw end');
+        });
+        mock.onBarcode = (data, type, level, moduleSize) => sent.add(data);
+        final printer = BluetoothPrinter.network(host: '10.0.0.9');
+        final engine = PrintEngine(platform: mock);
+        await Future.wait([
+          engine.sendRawCommands(printer, Uint8List.fromList([0x0A])),
+          engine.printBarcode(printer, 'table 12', BarcodeType.qrCode),
+        ]);
+        expect(sent, ['raw start', 'raw end', 'table 12']);
+      });
+
+      test('barcodes go to native printBarcode with their settings', () async {
+        final sent = <String>[];
+        final mock = MockPrintPlatform((printer, bytes) async {
+          sent.add('raw');
+        });
+        mock.onBarcode = (data, type, level, moduleSize) {
+          sent.add('${type.name} $data ${level.name} $moduleSize');
+        };
+        final receipt = Receipt(
+          items: [
+            ReceiptItem(
+              type: ReceiptItemType.barcode,
+              barcodeData: BarcodeData(
+                data: '4006381333931',
+                type: BarcodeType.ean13,
+              ),
+            ),
+            ReceiptItem(
+              type: ReceiptItemType.qrCode,
+              barcodeData: BarcodeData(
+                data: 'https://example.com',
+                type: BarcodeType.qrCode,
+                width: 6,
+                errorCorrection: QrErrorCorrection.high,
+              ),
+            ),
+          ],
+          settings: ReceiptSettings(),
+        );
+        await PrintEngine(platform: mock).sendPrintJob(
+          BluetoothPrinter.network(host: '10.0.0.9'),
+          PrintJob.receipt(receipt),
+        );
+        expect(sent, [
+          'raw',
+          'ean13 4006381333931 medium null',
+          'qrCode https://example.com high 6',
+          'raw',
+        ]);
+      });
     },
   );
 }
@@ -88,6 +197,8 @@ class MockPrintPlatform extends FlutterThermalPrinterWindowsPlatform
   Stream<ConnectionState> watchConnectionState(BluetoothPrinter printer) =>
       Stream.value(ConnectionState.connected);
 
+  void Function(int width, int height, int? targetWidth)? onImage;
+
   @override
   Future<void> sendRawCommands(
     BluetoothPrinter printer,
@@ -95,4 +206,40 @@ class MockPrintPlatform extends FlutterThermalPrinterWindowsPlatform
   ) async {
     await _onSend(printer, commands.toList());
   }
+
+  @override
+  Future<void> printImage(
+    BluetoothPrinter printer,
+    Uint8List pixels,
+    int width,
+    int height, {
+    ImagePixelFormat format = ImagePixelFormat.gray8,
+    int? targetWidth,
+    ImageResampleFilter filter = ImageResampleFilter.auto,
+    bool dither = true,
+    int threshold = 128,
+  }) async {
+    onImage?.call(width, height, targetWidth);
+  }
+
+  void Function(
+    String data,
+    BarcodeType type,
+    QrErrorCorrection level,
+    int? moduleSize,
+  )?
+  onBarcode;
+
+  @override
+  Future<void> printBarcode(
+    BluetoothPrinter printer,
+    String data,
+    BarcodeType type, {
+    QrErrorCorrection errorCorrection = QrErrorCorrection.medium,
+    int? moduleSize,
+    int? height,
+    BarcodeRendering rendering = BarcodeRendering.auto,
+  }) async {
+    onBarcode?.call(data, type, errorCorrection, moduleSize);
+  }
 }
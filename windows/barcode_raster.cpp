@@ -0,0 +1,456 @@
+#include "barcode_raster.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr int kDefaultQrModuleDots = 4;
+constexpr int kDefaultLinearModuleDots = 3;
+constexpr int kDefaultBarHeightDots = 162;
+constexpr int kMaxBarHeightDots = 1024;
+/// GS ( k module size and GS w bar width ranges.
+constexpr int kMaxQrCommandModule = 16;
+constexpr int kMinBarCommandWidth = 2;
+constexpr int kMaxBarCommandWidth = 6;
+constexpr size_t kMaxBarCommandBytes = 255;
+constexpr size_t kMaxQrCommandBytes = 7089;
+
+/// Quiet zones in modules: 4 around QR codes, 10 beside Code 128, 11 left
+/// and 7 right of EAN.
+constexpr int kQrQuietModules = 4;
+constexpr int kCode128QuietModules = 10;
+constexpr int kEanQuietLeft = 11;
+constexpr int kEanQuietRight = 7;
+
+/// Bar and space widths of Code 128 values 0..105, then the stop symbol.
+constexpr const char* kCode128Patterns[107] = {
+    "212222", "222122", "222221", "121223", "121322", "131222", "122213", "122312", "132212", "221213",
+    "221312", "231212", "112232", "122132", "122231", "113222", "123122", "123221", "223211", "221132",
+    "221231", "213212", "223112", "312131", "311222", "321122", "321221", "312212", "322112", "322211",
+    "212123", "212321", "232121", "111323", "131123", "131321", "112313", "132113", "132311", "211313",
+    "231113", "231311", "112133", "112331", "132131", "113123", "113321", "133121", "313121", "211331",
+    "231131", "213113", "213311", "213131", "311123", "311321", "331121", "312113", "312311", "332111",
+    "314111", "221411", "431111", "111224", "111422", "121124", "121421", "141122", "141221", "112214",
+    "112412", "122114", "122411", "142112", "142211", "241211", "221114", "413111", "241112", "134111",
+    "111242", "121142", "121241", "114212", "124112", "124211", "411212", "421112", "421211", "212141",
+    "214121", "412121", "111143", "111341", "131141", "114113", "114311", "411113", "411311", "113141",
+    "114131", "311141", "411131", "211412", "211214", "211232", "2331112",
+};
+
+constexpr int kCode128Shift = 98;
+constexpr int kCode128CodeC = 99;
+constexpr int kCode128CodeB = 100;
+constexpr int kCode128CodeA = 101;
+constexpr int kCode128StartA = 103;
+constexpr int kCode128StartB = 104;
+constexpr int kCode128StartC = 105;
+constexpr int kCode128Stop = 106;
+
+/// EAN left-hand odd parity (L) digit codes, 7 modules each; right-hand (R)
+/// codes are their complement and even parity (G) codes R reversed.
+constexpr uint8_t kEanL[10] = {0x0D, 0x19, 0x13, 0x3D, 0x23, 0x31, 0x2F, 0x3B, 0x37, 0x0B};
+
+/// L/G parity of EAN-13 digits 2..7, selected by the first digit.
+constexpr const char* kEan13Parity[10] = {
+    "LLLLLL", "LLGLGG", "LLGGLG", "LLGGGL", "LGLLGG", "LGGLLG", "LGGGLL", "LGLGLG", "LGLGGL", "LGGLGL",
+};
+
+enum class CodeSet { kA, kB, kC };
+
+bool InSet(CodeSet set, unsigned char c) {
+  return set == CodeSet::kA ? c < 96 : (c >= 32 && c < 128);
+}
+
+int ValueIn(CodeSet set, unsigned char c) {
+  if (set == CodeSet::kA && c < 32) return c + 64;
+  return c - 32;
+}
+
+size_t DigitRun(const std::string& data, size_t at) {
+  size_t end = at;
+  while (end < data.size() && data[end] >= '0' && data[end] <= '9') end++;
+  return end - at;
+}
+
+/// A or B for the text starting at [at]: A if a control character comes
+/// before any lower-case letter.
+CodeSet TextSetFor(const std::string& data, size_t at) {
+  for (size_t i = at; i < data.size(); i++) {
+    const unsigned char c = static_cast<unsigned char>(data[i]);
+    if (c < 32) return CodeSet::kA;
+    if (c >= 96) return CodeSet::kB;
+  }
+  return CodeSet::kB;
+}
+
+/// Digit runs are worth code set C when they are this long (fewer at the
+/// ends of the data, where no switch back is needed).
+bool WorthCodeC(const std::string& data, size_t at, size_t run) {
+  const bool reaches_end = at + run == data.size();
+  if (at == 0) return reaches_end ? run == 2 || run >= 4 : run >= 4;
+  return run >= (reaches_end ? 4u : 6u);
+}
+
+void AppendPattern(const char* widths, std::vector<uint8_t>* modules) {
+  bool bar = true;
+  for (const char* w = widths; *w; w++) {
+    modules->insert(modules->end(), static_cast<size_t>(*w - '0'), bar ? 1 : 0);
+    bar = !bar;
+  }
+}
+
+void AppendEanDigit(uint8_t code, std::vector<uint8_t>* modules) {
+  for (int bit = 6; bit >= 0; bit--) modules->push_back((code >> bit) & 1);
+}
+
+uint8_t EanR(int digit) {
+  return static_cast<uint8_t>(~kEanL[digit] & 0x7F);
+}
+
+uint8_t EanG(int digit) {
+  const uint8_t r = EanR(digit);
+  uint8_t g = 0;
+  for (int bit = 0; bit < 7; bit++) {
+    if (r & (1 << bit)) g |= static_cast<uint8_t>(1 << (6 - bit));
+  }
+  return g;
+}
+
+/// Digits of an EAN number with its check digit, or empty if [data] is not
+/// one of the [length] - 1 or [length] digits with a right check digit.
+std::vector<int> EanDigits(const std::string& data, size_t length) {
+  if (data.size() != length && data.size() != length - 1) return {};
+  std::vector<int> digits;
+  for (char c : data) {
+    if (c < '0' || c > '9') return {};
+    digits.push_back(c - '0');
+  }
+  int sum = 0;
+  for (size_t i = 0; i < length - 1; i++) {
+    // Weights 3, 1, 3, ... from the digit next to the check digit.
+    sum += digits[length - 2 - i] * (i % 2 == 0 ? 3 : 1);
+  }
+  const int check = (10 - sum % 10) % 10;
+  if (digits.size() == length) return digits[length - 1] == check ? digits : std::vector<int>();
+  digits.push_back(check);
+  return digits;
+}
+
+bool EncodeEanModules(const std::vector<int>& digits, std::vector<uint8_t>* modules) {
+  const bool ean13 = digits.size() == 13;
+  const size_t half = ean13 ? 6 : 4;
+  const size_t first = ean13 ? 1 : 0;
+  AppendPattern("111", modules);
+  for (size_t i = 0; i < half; i++) {
+    const int digit = digits[first + i];
+    const bool even = ean13 && kEan13Parity[digits[0]][i] == 'G';
+    AppendEanDigit(even ? EanG(digit) : kEanL[digit], modules);
+  }
+  modules->insert(modules->end(), {0, 1, 0, 1, 0});  // centre guard
+  for (size_t i = 0; i < half; i++) AppendEanDigit(EanR(digits[first + half + i]), modules);
+  AppendPattern("111", modules);
+  return true;
+}
+
+void QuietZone(Symbology symbology, int* left, int* right) {
+  switch (symbology) {
+    case Symbology::kQrCode:
+      *left = *right = kQrQuietModules;
+      return;
+    case Symbology::kEan13:
+    case Symbology::kEan8:
+      *left = kEanQuietLeft;
+      *right = kEanQuietRight;
+      return;
+    default:
+      *left = *right = kCode128QuietModules;
+      return;
+  }
+}
+
+/// Largest module size up to [wanted] that fits [modules] in [max_width];
+/// 0 if none does.
+int FitModuleDots(int wanted, int modules, int max_width) {
+  if (max_width <= 0) return wanted;
+  return std::min(wanted, max_width / modules);
+}
+
+void SetDots(uint8_t* row, int x, int count) {
+  for (int i = 0; i < count; i++, x++) row[x >> 3] |= static_cast<uint8_t>(0x80 >> (x & 7));
+}
+
+void AppendLittleEndian16(size_t value, std::vector<uint8_t>* out) {
+  out->push_back(static_cast<uint8_t>(value & 0xFF));
+  out->push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+
+}  // namespace
+
+bool Code128Values(const std::string& data, std::vector<int>* values) {
+  if (!values || data.empty()) return false;
+  for (char c : data) {
+    if (static_cast<unsigned char>(c) >= 128) return false;
+  }
+  std::vector<int> out;
+  CodeSet set;
+  size_t i = 0;
+  if (WorthCodeC(data, 0, DigitRun(data, 0))) {
+    set = CodeSet::kC;
+    out.push_back(kCode128StartC);
+  } else {
+    set = TextSetFor(data, 0);
+    out.push_back(set == CodeSet::kA ? kCode128StartA : kCode128StartB);
+  }
+  while (i < data.size()) {
+    if (set == CodeSet::kC) {
+      if (DigitRun(data, i) >= 2) {
+        out.push_back((data[i] - '0') * 10 + (data[i + 1] - '0'));
+        i += 2;
+        continue;
+      }
+      set = TextSetFor(data, i);
+      out.push_back(set == CodeSet::kA ? kCode128CodeA : kCode128CodeB);
+      continue;
+    }
+    const size_t run = DigitRun(data, i);
+    if (WorthCodeC(data, i, run)) {
+      // An odd run leaves its first digit in the current set.
+      if (run % 2) out.push_back(ValueIn(set, static_cast<unsigned char>(data[i++])));
+      set = CodeSet::kC;
+      out.push_back(kCode128CodeC);
+      continue;
+    }
+    const unsigned char c = static_cast<unsigned char>(data[i]);
+    if (!InSet(set, c)) {
+      const CodeSet other = set == CodeSet::kA ? CodeSet::kB : CodeSet::kA;
+      const bool single = i + 1 >= data.size() || InSet(set, static_cast<unsigned char>(data[i + 1]));
+      if (single) {
+        out.push_back(kCode128Shift);
+        out.push_back(ValueIn(other, c));
+        i++;
+        continue;
+      }
+      set = other;
+      out.push_back(set == CodeSet::kA ? kCode128CodeA : kCode128CodeB);
+    }
+    out.push_back(ValueIn(set, static_cast<unsigned char>(data[i++])));
+  }
+  int checksum = out[0];
+  for (size_t k = 1; k < out.size(); k++) checksum += static_cast<int>(k) * out[k];
+  out.push_back(checksum % 103);
+  out.push_back(kCode128Stop);
+  *values = std::move(out);
+  return true;
+}
+
+bool EncodeLinearModules(Symbology symbology, const std::string& data, std::vector<uint8_t>* modules) {
+  if (!modules) return false;
+  modules->clear();
+  switch (symbology) {
+    case Symbology::kCode128: {
+      std::vector<int> values;
+      if (!Code128Values(data, &values)) return false;
+      for (int value : values) AppendPattern(kCode128Patterns[value], modules);
+      return true;
+    }
+    case Symbology::kEan13:
+    case Symbology::kEan8: {
+      const std::vector<int> digits = EanDigits(data, symbology == Symbology::kEan13 ? 13 : 8);
+      return !digits.empty() && EncodeEanModules(digits, modules);
+    }
+    default:
+      return false;
+  }
+}
+
+bool CanRasterizeSymbology(Symbology symbology) {
+  return symbology == Symbology::kCode128 || symbology == Symbology::kEan13 || symbology == Symbology::kEan8 ||
+         symbology == Symbology::kQrCode;
+}
+
+bool RasterizeBarcode(const BarcodeSpec& spec, BarcodeBitmap* out) {
+  if (!out || !CanRasterizeSymbology(spec.symbology)) return false;
+  int quiet_left = 0;
+  int quiet_right = 0;
+  QuietZone(spec.symbology, &quiet_left, &quiet_right);
+  BarcodeBitmap bitmap;
+
+  if (spec.symbology == Symbology::kQrCode) {
+    QrSymbol symbol;
+    if (!EncodeQrCode(spec.data, spec.error_correction, &symbol)) return false;
+    const int modules = symbol.size + quiet_left + quiet_right;
+    const int dots = FitModuleDots(spec.module_dots > 0 ? spec.module_dots : kDefaultQrModuleDots, modules,
+                                   spec.max_width_dots);
+    if (dots < 1) return false;
+    bitmap.width = bitmap.height = modules * dots;
+    bitmap.module_dots = dots;
+    bitmap.row_bytes = static_cast<size_t>(bitmap.width + 7) / 8;
+    bitmap.bits.assign(bitmap.row_bytes * bitmap.height, 0);
+    for (int y = 0; y < symbol.size; y++) {
+      uint8_t* row = bitmap.bits.data() + static_cast<size_t>((quiet_left + y) * dots) * bitmap.row_bytes;
+      for (int x = 0; x < symbol.size; x++) {
+        if (symbol.Dark(x, y)) SetDots(row, (quiet_left + x) * dots, dots);
+      }
+      // Every module row is [dots] identical dot rows.
+      for (int r = 1; r < dots; r++) std::memcpy(row + r * bitmap.row_bytes, row, bitmap.row_bytes);
+    }
+    *out = std::move(bitmap);
+    return true;
+  }
+
+  std::vector<uint8_t> bars;
+  if (!EncodeLinearModules(spec.symbology, spec.data, &bars)) return false;
+  const int modules = static_cast<int>(bars.size()) + quiet_left + quiet_right;
+  const int dots = FitModuleDots(spec.module_dots > 0 ? spec.module_dots : kDefaultLinearModuleDots, modules,
+                                 spec.max_width_dots);
+  if (dots < 1) return false;
+  bitmap.width = modules * dots;
+  bitmap.height = std::clamp(spec.height_dots > 0 ? spec.height_dots : kDefaultBarHeightDots, 1, kMaxBarHeightDots);
+  bitmap.module_dots = dots;
+  bitmap.row_bytes = static_cast<size_t>(bitmap.width + 7) / 8;
+  bitmap.bits.assign(bitmap.row_bytes * bitmap.height, 0);
+  uint8_t* first = bitmap.bits.data();
+  for (size_t i = 0; i < bars.size(); i++) {
+    if (bars[i]) SetDots(first, (quiet_left + static_cast<int>(i)) * dots, dots);
+  }
+  for (int y = 1; y < bitmap.height; y++) std::memcpy(first + y * bitmap.row_bytes, first, bitmap.row_bytes);
+  *out = std::move(bitmap);
+  return true;
+}
+
+bool EncodeBarcodeCommands(const BarcodeSpec& spec, std::vector<uint8_t>* out) {
+  if (!out || spec.data.empty()) return false;
+  out->clear();
+  if (spec.symbology == Symbology::kQrCode) {
+    if (spec.data.size() > kMaxQrCommandBytes) return false;
+    const int module = std::clamp(spec.module_dots > 0 ? spec.module_dots : kDefaultQrModuleDots, 1,
+                                  kMaxQrCommandModule);
+    // GS ( k: model 2, module size, error correction, store, print.
+    const uint8_t setup[] = {
+        0x1D, 0x28, 0x6B, 4, 0, 49, 65, 50, 0,
+        0x1D, 0x28, 0x6B, 3, 0, 49, 67, static_cast<uint8_t>(module),
+        0x1D, 0x28, 0x6B, 3, 0, 49, 69, static_cast<uint8_t>(48 + static_cast<int>(spec.error_correction)),
+        0x1D, 0x28, 0x6B,
+    };
+    out->assign(setup, setup + sizeof(setup));
+    AppendLittleEndian16(spec.data.size() + 3, out);
+    out->insert(out->end(), {49, 80, 48});
+    out->insert(out->end(), spec.data.begin(), spec.data.end());
+    out->insert(out->end(), {0x1D, 0x28, 0x6B, 3, 0, 49, 81, 48});
+    return true;
+  }
+
+  std::string payload = spec.data;
+  uint8_t m = 73;
+  switch (spec.symbology) {
+    case Symbology::kCode128:
+      // GS k 73 takes code set B text after "{B"; a literal '{' is "{{".
+      payload = "{B";
+      for (char c : spec.data) {
+        if (static_cast<unsigned char>(c) < 32 || static_cast<unsigned char>(c) >= 128) return false;
+        payload.push_back(c);
+        if (c == '{') payload.push_back(c);
+      }
+      break;
+    case Symbology::kCode39:
+      m = 69;
+      break;
+    case Symbology::kEan13:
+      m = 67;
+      if (EanDigits(spec.data, 13).empty()) return false;
+      break;
+    case Symbology::kEan8:
+      m = 68;
+      if (EanDigits(spec.data, 8).empty()) return false;
+      break;
+    default:
+      return false;
+  }
+  if (payload.size() > kMaxBarCommandBytes) return false;
+  const int height = std::clamp(spec.height_dots > 0 ? spec.height_dots : kDefaultBarHeightDots, 1, 255);
+  out->insert(out->end(), {0x1D, 0x68, static_cast<uint8_t>(height)});
+  if (spec.module_dots > 0) {
+    const int width = std::clamp(spec.module_dots, kMinBarCommandWidth, kMaxBarCommandWidth);
+    out->insert(out->end(), {0x1D, 0x77, static_cast<uint8_t>(width)});
+  }
+  out->insert(out->end(), {0x1D, 0x6B, m, static_cast<uint8_t>(payload.size())});
+  out->insert(out->end(), payload.begin(), payload.end());
+  return true;
+}
+
+BarcodeRendering ChooseBarcodeRendering(const BarcodeSpec& spec,
+                                        const RegisteredPrinter& printer,
+                                        BarcodeRendering requested) {
+  if (requested != BarcodeRendering::kAuto) return requested;
+  std::vector<uint8_t> commands;
+  if (printer.supports_barcode_commands && EncodeBarcodeCommands(spec, &commands)) {
+    return BarcodeRendering::kPrinterCommands;
+  }
+  if (printer.supports_images && CanRasterizeSymbology(spec.symbology)) return BarcodeRendering::kRaster;
+  return BarcodeRendering::kPrinterCommands;
+}
+
+std::string BarcodeBitmapCache::Key(const BarcodeSpec& spec) {
+  std::string key = std::to_string(static_cast<int>(spec.symbology)) + ',' +
+                    std::to_string(static_cast<int>(spec.error_correction)) + ',' +
+                    std::to_string(spec.module_dots) + ',' + std::to_string(spec.height_dots) + ',' +
+                    std::to_string(spec.max_width_dots) + ':';
+  return key + spec.data;
+}
+
+std::shared_ptr<const BarcodeBitmap> BarcodeBitmapCache::Get(const BarcodeSpec& spec, bool* hit) {
+  const std::string key = Key(spec);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      if (hit) *hit = true;
+      return it->second->second;
+    }
+  }
+  if (hit) *hit = false;
+  auto bitmap = std::make_shared<BarcodeBitmap>();
+  if (!RasterizeBarcode(spec, bitmap.get())) return nullptr;
+  const size_t size = bitmap->bits.size() + key.size();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.count(key) || size > max_bytes_) return bitmap;  // raced with another render, or too big to keep
+  entries_.emplace_front(key, bitmap);
+  index_[key] = entries_.begin();
+  bytes_ += size;
+  while (bytes_ > max_bytes_) {
+    const Entry& last = entries_.back();
+    bytes_ -= last.second->bits.size() + last.first.size();
+    index_.erase(last.first);
+    entries_.pop_back();
+  }
+  return bitmap;
+}
+
+size_t BarcodeBitmapCache::entries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+size_t BarcodeBitmapCache::bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_;
+}
+
+void BarcodeBitmapCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  index_.clear();
+  bytes_ = 0;
+}
+
+BarcodeBitmapCache& GetBarcodeBitmapCache() {
+  // About a hundred receipt-sized symbols.
+  static auto* cache = new BarcodeBitmapCache(2 * 1024 * 1024);
+  return *cache;
+}
+
+}  // namespace flutter_thermal_printer_windows
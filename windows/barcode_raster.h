@@ -0,0 +1,131 @@
+#ifndef FLUTTER_PLUGIN_BARCODE_RASTER_H_
+#define FLUTTER_PLUGIN_BARCODE_RASTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "device_registry.h"
+#include "qr_code.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Values match the Dart BarcodeType index.
+enum class Symbology : int {
+  kCode128 = 0,
+  kCode39 = 1,
+  kEan13 = 2,
+  kEan8 = 3,
+  kQrCode = 4,
+};
+
+/// How a barcode reaches the paper. Values match the Dart BarcodeRendering
+/// index.
+enum class BarcodeRendering : int {
+  /// Printer commands when the printer is known to draw the symbology,
+  /// otherwise a raster image.
+  kAuto = 0,
+  /// GS k / GS ( k; the firmware draws the symbol.
+  kPrinterCommands = 1,
+  /// Encoded here and sent as a 1bpp image.
+  kRaster = 2,
+};
+
+struct BarcodeSpec {
+  Symbology symbology = Symbology::kCode128;
+  std::string data;
+  /// QR codes only.
+  QrErrorCorrection error_correction = QrErrorCorrection::kMedium;
+  /// Dots per QR module or per narrowest bar; 0 = 4 for QR, 3 for linear
+  /// symbols (the GS ( k and GS w defaults). Rasters lower it until the
+  /// symbol fits [max_width_dots]; every module keeps the same whole number
+  /// of dots so scanners see exact ratios.
+  int module_dots = 0;
+  /// Bar height of linear symbols in dots; 0 = 162 (the GS h default).
+  int height_dots = 0;
+  /// Widest raster the printer takes (its head width); 0 = no limit.
+  int max_width_dots = 0;
+};
+
+/// 1bpp symbol including its quiet zone. Rows are row_bytes apart, MSB is
+/// the leftmost dot, 1 = black.
+struct BarcodeBitmap {
+  int width = 0;
+  int height = 0;
+  size_t row_bytes = 0;
+  /// Dots per module actually used.
+  int module_dots = 0;
+  std::vector<uint8_t> bits;
+};
+
+/// Code 128 symbol values including start, checksum and stop, switching
+/// between code sets A, B and C to keep the symbol short. Returns false for
+/// characters outside ASCII.
+bool Code128Values(const std::string& data, std::vector<int>* values);
+
+/// Modules of a linear symbol, left to right (1 = bar), without quiet zone.
+/// EAN takes 12 (EAN-13) or 7 (EAN-8) digits and appends the check digit,
+/// or the full number, whose check digit must then be right.
+bool EncodeLinearModules(Symbology symbology, const std::string& data, std::vector<uint8_t>* modules);
+
+/// Whether [symbology] has an encoder here (all but Code 39).
+bool CanRasterizeSymbology(Symbology symbology);
+
+/// Renders [spec] at module-aligned dot sizes. Returns false for data the
+/// symbology cannot encode or a symbol wider than [max_width_dots] even at
+/// one dot per module.
+bool RasterizeBarcode(const BarcodeSpec& spec, BarcodeBitmap* out);
+
+/// GS k / GS ( k commands printing [spec] with the printer's own encoder.
+/// Returns false for data the command cannot carry (e.g. more than 255
+/// bytes for GS k).
+bool EncodeBarcodeCommands(const BarcodeSpec& spec, std::vector<uint8_t>* out);
+
+/// Resolves kAuto for [printer]: printer commands if its firmware draws
+/// barcodes and can take [spec], else a raster when it prints images and
+/// the symbology has an encoder here, else printer commands as a last
+/// resort. Explicit choices are returned unchanged.
+BarcodeRendering ChooseBarcodeRendering(const BarcodeSpec& spec,
+                                        const RegisteredPrinter& printer,
+                                        BarcodeRendering requested);
+
+/// Rendered bitmaps keyed by content and settings, least recently used
+/// dropped first once they hold more than max_bytes. Thread-safe; rendering
+/// happens outside the lock.
+class BarcodeBitmapCache {
+ public:
+  explicit BarcodeBitmapCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  /// Cached or freshly rendered bitmap for [spec]; nullptr if it cannot be
+  /// rasterized. [hit] tells which.
+  std::shared_ptr<const BarcodeBitmap> Get(const BarcodeSpec& spec, bool* hit = nullptr);
+
+  size_t entries() const;
+  size_t bytes() const;
+  void Clear();
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<const BarcodeBitmap>>;
+
+  static std::string Key(const BarcodeSpec& spec);
+
+  const size_t max_bytes_;
+  mutable std::mutex mutex_;
+  /// Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  size_t bytes_ = 0;
+};
+
+/// Process-wide cache used by printBarcode.
+BarcodeBitmapCache& GetBarcodeBitmapCache();
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_BARCODE_RASTER_H_
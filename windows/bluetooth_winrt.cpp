@@ -1,4 +1,10 @@
 #include "bluetooth_winrt.h"
+#include "device_registry.h"
+#include "native_metrics.h"
+#include "printer_capabilities.h"
+#include "printer_transport.h"
+#include "trace_capture.h"
+#include "trace_spans.h"
 
 #include <windows.h>
 
@@ -11,16 +17,22 @@
 #include <winrt/Windows.Devices.Enumeration.h>
 #include <winrt/Windows.Devices.Bluetooth.h>
 #include <winrt/Windows.Devices.Bluetooth.Rfcomm.h>
+#include <winrt/Windows.Networking.h>
 #include <winrt/Windows.Networking.Sockets.h>
 #include <winrt/Windows.Storage.Streams.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_set>
 
 namespace flutter_thermal_printer_windows {
 
@@ -55,15 +67,19 @@ static void BtLog(const std::string& msg) {
 #define BT_VERBOSE(x) ((void)0)
 #endif
 
-static std::unordered_map<std::string, winrt_win::Networking::Sockets::StreamSocket> g_sockets;
-/// Reuse one DataWriter per socket - creating multiple on same stream can fail.
-static std::unordered_map<std::string, winrt_win::Storage::Streams::DataWriter> g_writers;
+/// Open connections by device id (RfcommTransport wrapped in TracingTransport). Worker thread only.
+static std::unordered_map<std::string, std::unique_ptr<PrinterTransport>> g_transports;
+/// Keys of g_transports, kept in step with it so connection state can be
+/// answered on the platform thread without queueing behind running jobs.
+static std::mutex g_connected_mutex;
+static std::unordered_set<std::string> g_connected;
 static std::once_flag g_worker_once;
 static std::thread g_worker;
 static std::mutex g_mutex;
 static std::condition_variable g_cv_task;
 static std::condition_variable g_cv_done;
-static std::function<void()> g_pending_task;
+/// FIFO of posted tasks; a single slot would let back-to-back async calls overwrite each other.
+static std::deque<std::function<void()>> g_tasks;
 static bool g_quit = false;
 
 static void MtaWorkerThread() {
@@ -75,14 +91,17 @@ static void MtaWorkerThread() {
   } catch (...) {
     BT_LOG("MtaWorkerThread ERROR: init_apartment failed");
   }
+  MetricsSetOnce("startup.worker_ready_ms", MetricsNowMs());
+  SpanSetThreadName("mta-worker");
   std::unique_lock<std::mutex> lock(g_mutex);
   for (;;) {
-    g_cv_task.wait(lock, [] { return g_pending_task != nullptr || g_quit; });
+    g_cv_task.wait(lock, [] { return !g_tasks.empty() || g_quit; });
     if (g_quit) break;
-    std::function<void()> task = std::move(g_pending_task);
-    g_pending_task = nullptr;
+    std::function<void()> task = std::move(g_tasks.front());
+    g_tasks.pop_front();
     lock.unlock();
     try {
+      ScopedSpan span("MtaTask");
       task();
     } catch (const std::exception& e) {
       BT_LOG("MtaWorkerThread ERROR: " << e.what());
@@ -90,24 +109,52 @@ static void MtaWorkerThread() {
       BT_LOG("MtaWorkerThread ERROR: task threw unknown");
     }
     lock.lock();
-    g_cv_done.notify_one();
   }
 }
 
-/// Run WinRT work on a dedicated MTA thread. Blocking .get() on IAsyncOperation
-/// is not allowed on STA; running on MTA avoids the !is_sta_thread() assertion.
-static void RunOnMta(std::function<void()> f) {
+static void StartMtaWorker() {
   std::call_once(g_worker_once, []() {
     g_worker = std::thread(MtaWorkerThread);
     g_worker.detach();
   });
-  std::unique_lock<std::mutex> lock(g_mutex);
-  g_pending_task = std::move(f);
+}
+
+/// Post task to worker; returns immediately. Tasks run in posting order.
+static void RunOnMtaAsync(std::function<void()> f) {
+  StartMtaWorker();
+  if (SpansActive()) {
+    f = [f = std::move(f), posted_us = SpanNowUs()]() {
+      SpanRecordAsync("RunOnMtaAsync.wait", posted_us, SpanNowUs() - posted_us);
+      f();
+    };
+  }
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_tasks.push_back(std::move(f));
   g_cv_task.notify_one();
-  g_cv_done.wait(lock, [] { return g_pending_task == nullptr; });
 }
 
-void BluetoothWinRtInit() {}
+/// Run WinRT work on a dedicated MTA thread. Blocking .get() on IAsyncOperation
+/// is not allowed on STA; running on MTA avoids the !is_sta_thread() assertion.
+static void RunOnMta(std::function<void()> f) {
+  StartMtaWorker();
+  bool done = false;
+  const int64_t posted_us = SpansActive() ? SpanNowUs() : -1;
+  std::unique_lock<std::mutex> lock(g_mutex);
+  g_tasks.push_back([&f, &done, posted_us]() {
+    if (posted_us >= 0) SpanRecordAsync("RunOnMta.wait", posted_us, SpanNowUs() - posted_us);
+    struct MarkDone {
+      bool& done;
+      ~MarkDone() {
+        std::lock_guard<std::mutex> done_lock(g_mutex);
+        done = true;
+        g_cv_done.notify_all();
+      }
+    } mark{done};
+    f();
+  });
+  g_cv_task.notify_one();
+  g_cv_done.wait(lock, [&done] { return done; });
+}
 
 static std::string HStringToUtf8(const winrt::hstring& hs) {
   if (hs.empty()) return "";
@@ -125,6 +172,122 @@ static std::string HStringToUtf8(const winrt::hstring& hs) {
   }
 }
 
+/// PrinterTransport over an RFCOMM StreamSocket. Reuses one DataWriter per
+/// socket - creating multiple on same stream can fail.
+class RfcommTransport : public PrinterTransport {
+ public:
+  /// [span_detail] labels this connection's spans (an interned device id).
+  RfcommTransport(winrt_win::Networking::Sockets::StreamSocket socket, const char* span_detail)
+      : socket_(std::move(socket)),
+        writer_(winrt_win::Storage::Streams::DataWriter(socket_.OutputStream())),
+        span_detail_(span_detail) {}
+
+  ~RfcommTransport() override { Close(); }
+
+  bool Write(const uint8_t* data, size_t size) override {
+    if (!socket_) return false;
+    try {
+      {
+        ScopedSpan span("WriteBytes", span_detail_);
+        writer_.WriteBytes(winrt::array_view<const uint8_t>(data, data + size));
+      }
+      ScopedSpan span("StoreAsync", span_detail_);
+      writer_.StoreAsync().get();
+      return true;
+    } catch (const winrt::hresult_error& e) {
+      BT_LOG("RfcommTransport::Write ERROR: 0x" << std::hex << e.code() << " " << HStringToUtf8(e.message()));
+      failed_ = true;
+      return false;
+    } catch (...) {
+      BT_LOG("RfcommTransport::Write ERROR: unknown");
+      failed_ = true;
+      return false;
+    }
+  }
+
+  bool Flush() override {
+    if (!socket_) return false;
+    try {
+      ScopedSpan span("FlushAsync", span_detail_);
+      writer_.FlushAsync().get();
+      return true;
+    } catch (const winrt::hresult_error& e) {
+      BT_LOG("RfcommTransport::Flush ERROR: 0x" << std::hex << e.code() << " " << HStringToUtf8(e.message()));
+      failed_ = true;
+      return false;
+    } catch (...) {
+      BT_LOG("RfcommTransport::Flush ERROR: unknown");
+      failed_ = true;
+      return false;
+    }
+  }
+
+  int Read(uint8_t* buffer, size_t capacity, int timeout_ms) override {
+    using winrt_win::Foundation::AsyncStatus;
+    using winrt_win::Storage::Streams::DataReader;
+    using winrt_win::Storage::Streams::InputStreamOptions;
+    if (!socket_ || capacity == 0) return socket_ ? 0 : -1;
+    try {
+      if (!reader_) {
+        reader_ = DataReader(socket_.InputStream());
+        reader_.InputStreamOptions(InputStreamOptions::Partial);
+      }
+      if (reader_.UnconsumedBufferLength() == 0) {
+        auto load = reader_.LoadAsync(static_cast<uint32_t>(capacity));
+        if (load.wait_for(std::chrono::milliseconds(timeout_ms)) != AsyncStatus::Completed) {
+          // A cancelled load leaves the reader unusable; start a fresh one next time.
+          load.Cancel();
+          reader_.DetachStream();
+          reader_ = nullptr;
+          return 0;
+        }
+        if (load.GetResults() == 0) {  // stream closed
+          failed_ = true;
+          return -1;
+        }
+      }
+      uint32_t n = (std::min)(static_cast<uint32_t>(capacity), reader_.UnconsumedBufferLength());
+      reader_.ReadBytes(winrt::array_view<uint8_t>(buffer, buffer + n));
+      return static_cast<int>(n);
+    } catch (const winrt::hresult_error& e) {
+      BT_LOG("RfcommTransport::Read ERROR: 0x" << std::hex << e.code() << " " << HStringToUtf8(e.message()));
+      failed_ = true;
+      return -1;
+    } catch (...) {
+      BT_LOG("RfcommTransport::Read ERROR: unknown");
+      failed_ = true;
+      return -1;
+    }
+  }
+
+  void Close() override {
+    if (!socket_) return;
+    try { socket_.Close(); } catch (...) {}
+    socket_ = nullptr;
+    writer_ = nullptr;
+    reader_ = nullptr;
+  }
+
+  bool IsAlive() override { return socket_ && !failed_; }
+
+ private:
+  winrt_win::Networking::Sockets::StreamSocket socket_;
+  winrt_win::Storage::Streams::DataWriter writer_;
+  winrt_win::Storage::Streams::DataReader reader_{nullptr};
+  const char* span_detail_;
+  /// An I/O call failed; the link is treated as dropped.
+  bool failed_ = false;
+};
+
+/// Worker thread only. Wrap a connected socket and register it for [device_id].
+static void InstallTransport(const std::string& device_id,
+                             winrt_win::Networking::Sockets::StreamSocket socket) {
+  g_transports[device_id] = std::make_unique<TracingTransport>(
+      device_id, std::make_unique<RfcommTransport>(std::move(socket), SpanInternName(device_id)));
+  std::lock_guard<std::mutex> lock(g_connected_mutex);
+  g_connected.insert(device_id);
+}
+
 static std::vector<SppDeviceInfo> BluetoothFindAllSppDevicesImpl() {
   std::vector<SppDeviceInfo> out;
   try {
@@ -143,7 +306,7 @@ static std::vector<SppDeviceInfo> BluetoothFindAllSppDevicesImpl() {
         info.signal_strength = -50;
         info.is_paired = false;
         info.mac_address = info.id;
-        info.is_connected = (g_sockets.find(info.id) != g_sockets.end());
+        info.is_connected = (g_transports.find(info.id) != g_transports.end());
         out.push_back(std::move(info));
       } catch (const std::exception& e) {
         BT_LOG("FindAllSppDevicesImpl: skip device " << i << ": " << e.what());
@@ -165,17 +328,6 @@ std::vector<SppDeviceInfo> BluetoothFindAllSppDevices() {
   return result;
 }
 
-/// Post task to worker; callback runs on worker thread when scan completes.
-static void RunOnMtaAsync(std::function<void()> f) {
-  std::call_once(g_worker_once, []() {
-    g_worker = std::thread(MtaWorkerThread);
-    g_worker.detach();
-  });
-  std::lock_guard<std::mutex> lock(g_mutex);
-  g_pending_task = std::move(f);
-  g_cv_task.notify_one();
-}
-
 void BluetoothFindAllSppDevicesAsync(std::function<void(std::vector<SppDeviceInfo>)> callback) {
   RunOnMtaAsync([callback]() {
     std::vector<SppDeviceInfo> result = BluetoothFindAllSppDevicesImpl();
@@ -295,11 +447,14 @@ void BluetoothPairDeviceAsyncSta(const std::string& device_id,
 }
 
 static void BluetoothDisconnectImpl(const std::string& device_id) {
-  g_writers.erase(device_id);
-  auto it = g_sockets.find(device_id);
-  if (it != g_sockets.end()) {
-    try { it->second.Close(); } catch (...) {}
-    g_sockets.erase(it);
+  {
+    std::lock_guard<std::mutex> lock(g_connected_mutex);
+    g_connected.erase(device_id);
+  }
+  auto it = g_transports.find(device_id);
+  if (it != g_transports.end()) {
+    it->second->Close();
+    g_transports.erase(it);
   }
 }
 
@@ -312,6 +467,8 @@ static bool BluetoothUnpairDeviceImpl(const std::string& device_id) {
     auto di = async_di.get();
     auto pairing = di.Pairing();
     pairing.UnpairAsync().get();
+    GetDeviceRegistry().Remove(device_id);
+    GetDeviceRegistry().Save();
     return true;
   } catch (...) {
     return false;
@@ -338,25 +495,83 @@ void BluetoothUnpairDeviceAsync(const std::string& device_id,
   });
 }
 
+/// Remember a successful connection so the next startup can reconnect without FromIdAsync.
+static void RecordConnected(const std::string& device_id,
+                            const std::string& host_name,
+                            const std::string& service_name,
+                            int64_t connect_ms) {
+  DeviceRegistry& registry = GetDeviceRegistry();
+  registry.Update(device_id, [&](RegisteredPrinter& printer, bool) {
+    printer.host_name = host_name;
+    printer.service_name = service_name;
+    printer.last_connect_ms = connect_ms;
+    printer.auto_reconnect = true;
+  });
+  if (!registry.Save()) {
+    BT_LOG("RecordConnected ERROR: could not save " << registry.path());
+  }
+  MetricsAdd("connect.count", 1);
+  MetricsSet("connect.last_ms", connect_ms);
+}
+
+/// Worker thread only. True if [device_id] has a connection that has not failed.
+static bool HasLiveTransport(const std::string& device_id) {
+  auto it = g_transports.find(device_id);
+  return it != g_transports.end() && it->second->IsAlive();
+}
+
+/// Worker thread only. Adopt a socket connected off-worker unless the app connected meanwhile.
+static bool AdoptSocket(const std::string& device_id,
+                        winrt_win::Networking::Sockets::StreamSocket socket) {
+  if (HasLiveTransport(device_id)) {
+    try { socket.Close(); } catch (...) {}
+    return true;
+  }
+  BluetoothDisconnectImpl(device_id);
+  try {
+    InstallTransport(device_id, std::move(socket));
+    return true;
+  } catch (const std::exception& e) {
+    BT_LOG("AdoptSocket ERROR: " << e.what());
+    return false;
+  } catch (...) {
+    BT_LOG("AdoptSocket ERROR: unknown");
+    return false;
+  }
+}
+
+/// Worker thread only. Keeps a live connection (e.g. one opened by the startup
+/// reconnect) and only replaces a missing or failed one.
 static bool BluetoothConnectImpl(const std::string& device_id) {
+  if (HasLiveTransport(device_id)) return true;
   BluetoothDisconnectImpl(device_id);
+  int64_t start_ms = MetricsNowMs();
   try {
     winrt::hstring id(winrt::to_hstring(device_id));
-    auto async_svc = winrt_win::Devices::Bluetooth::Rfcomm::RfcommDeviceService::FromIdAsync(id);
-    auto service = async_svc.get();
+    const char* span_detail = SpansActive() ? SpanInternName(device_id) : nullptr;
+    winrt_win::Devices::Bluetooth::Rfcomm::RfcommDeviceService service{nullptr};
+    {
+      ScopedSpan span("FromIdAsync", span_detail);
+      service = winrt_win::Devices::Bluetooth::Rfcomm::RfcommDeviceService::FromIdAsync(id).get();
+    }
     if (!service) {
       BT_LOG("ConnectImpl ERROR: FromIdAsync returned null");
       return false;
     }
     winrt_win::Networking::Sockets::StreamSocket socket;
-    socket.ConnectAsync(
-        service.ConnectionHostName(),
-        service.ConnectionServiceName(),
-        winrt_win::Networking::Sockets::SocketProtectionLevel::BluetoothEncryptionAllowNullAuthentication
-    ).get();
-    g_sockets[device_id] = std::move(socket);
-    g_writers[device_id] = winrt_win::Storage::Streams::DataWriter(
-        g_sockets[device_id].OutputStream());
+    {
+      ScopedSpan span("ConnectAsync", span_detail);
+      socket.ConnectAsync(
+          service.ConnectionHostName(),
+          service.ConnectionServiceName(),
+          winrt_win::Networking::Sockets::SocketProtectionLevel::BluetoothEncryptionAllowNullAuthentication
+      ).get();
+    }
+    InstallTransport(device_id, std::move(socket));
+    RecordConnected(device_id,
+                    HStringToUtf8(service.ConnectionHostName().RawName()),
+                    HStringToUtf8(service.ConnectionServiceName()),
+                    MetricsNowMs() - start_ms);
     return true;
   } catch (const std::exception& e) {
     BT_LOG("ConnectImpl ERROR: " << e.what());
@@ -387,44 +602,238 @@ void BluetoothConnectAsync(const std::string& device_id,
   });
 }
 
+void BluetoothConnectConcurrentAsync(const std::string& device_id,
+                                     std::function<void(bool)> callback) {
+  using AsyncStatus = winrt_win::Foundation::AsyncStatus;
+  using winrt_win::Devices::Bluetooth::Rfcomm::RfcommDeviceService;
+  using winrt_win::Networking::Sockets::SocketProtectionLevel;
+  using winrt_win::Networking::Sockets::StreamSocket;
+  auto finish = [callback](bool connected) {
+    try {
+      callback(connected);
+    } catch (const std::exception& e) {
+      BT_LOG("BluetoothConnectConcurrentAsync ERROR: " << e.what());
+    } catch (...) {
+      BT_LOG("BluetoothConnectConcurrentAsync ERROR: callback threw");
+    }
+  };
+  auto fail = [finish]() { RunOnMtaAsync([finish]() { finish(false); }); };
+  int64_t start_ms = MetricsNowMs();
+  const char* span_detail = SpansActive() ? SpanInternName(device_id) : nullptr;
+  const int64_t find_us = span_detail ? SpanNowUs() : -1;
+  try {
+    auto find = RfcommDeviceService::FromIdAsync(winrt::to_hstring(device_id));
+    find.Completed([device_id, start_ms, span_detail, find_us, finish, fail](auto const& op, AsyncStatus status) {
+      if (find_us >= 0) SpanRecordAsync("FromIdAsync", find_us, SpanNowUs() - find_us, span_detail);
+      RfcommDeviceService service{nullptr};
+      try {
+        if (status == AsyncStatus::Completed) service = op.GetResults();
+      } catch (...) {
+      }
+      if (!service) {
+        BT_LOG("ConnectConcurrent ERROR: FromIdAsync failed for " << device_id << ", status=" << (int)status);
+        fail();
+        return;
+      }
+      try {
+        StreamSocket socket;
+        const int64_t connect_us = span_detail ? SpanNowUs() : -1;
+        auto connect = socket.ConnectAsync(service.ConnectionHostName(),
+                                           service.ConnectionServiceName(),
+                                           SocketProtectionLevel::BluetoothEncryptionAllowNullAuthentication);
+        std::string host_name = HStringToUtf8(service.ConnectionHostName().RawName());
+        std::string service_name = HStringToUtf8(service.ConnectionServiceName());
+        connect.Completed([socket, device_id, host_name, service_name, start_ms, span_detail, connect_us, finish,
+                           fail](auto const&, AsyncStatus status) {
+          if (connect_us >= 0) SpanRecordAsync("ConnectAsync", connect_us, SpanNowUs() - connect_us, span_detail);
+          if (status != AsyncStatus::Completed) {
+            BT_LOG("ConnectConcurrent ERROR: ConnectAsync failed for " << device_id << ", status=" << (int)status);
+            try { socket.Close(); } catch (...) {}
+            fail();
+            return;
+          }
+          int64_t connect_ms = MetricsNowMs() - start_ms;
+          RunOnMtaAsync([socket, device_id, host_name, service_name, connect_ms, finish]() {
+            bool ok = AdoptSocket(device_id, socket);
+            if (ok) RecordConnected(device_id, host_name, service_name, connect_ms);
+            finish(ok);
+          });
+        });
+      } catch (const std::exception& e) {
+        BT_LOG("ConnectConcurrent ERROR: " << e.what());
+        fail();
+      } catch (...) {
+        BT_LOG("ConnectConcurrent ERROR: unknown");
+        fail();
+      }
+    });
+  } catch (const std::exception& e) {
+    BT_LOG("ConnectConcurrent ERROR: " << e.what());
+    fail();
+  } catch (...) {
+    BT_LOG("ConnectConcurrent ERROR: unknown");
+    fail();
+  }
+}
+
 void BluetoothDisconnect(const std::string& device_id) {
-  RunOnMta([device_id]() { BluetoothDisconnectImpl(device_id); });
+  // Reported as disconnected right away; the socket closes once the worker
+  // has finished the jobs queued before this call.
+  {
+    std::lock_guard<std::mutex> lock(g_connected_mutex);
+    g_connected.erase(device_id);
+  }
+  RunOnMtaAsync([device_id]() {
+    BluetoothDisconnectImpl(device_id);
+    // An explicit disconnect means "do not bring this one back on startup".
+    // Saved here rather than on the caller's (platform) thread.
+    DeviceRegistry& registry = GetDeviceRegistry();
+    bool changed = false;
+    registry.Update(
+        device_id,
+        [&changed](RegisteredPrinter& printer, bool) {
+          changed = printer.auto_reconnect;
+          printer.auto_reconnect = false;
+        },
+        /*create=*/false);
+    if (changed && !registry.Save()) {
+      BT_LOG("BluetoothDisconnect ERROR: could not save " << registry.path());
+    }
+  });
+}
+
+/// Startup reconnect of one registered printer. Runs off the worker using
+/// Completed handlers so all printers connect in parallel; only the final
+/// socket hand-off is posted to the worker. Uses the cached RFCOMM host and
+/// service when present and falls back to the full FromIdAsync path.
+static void ReconnectRegisteredAsync(const RegisteredPrinter& printer,
+                                     std::function<void(bool)> done) {
+  using AsyncStatus = winrt_win::Foundation::AsyncStatus;
+  using winrt_win::Networking::Sockets::SocketProtectionLevel;
+  using winrt_win::Networking::Sockets::StreamSocket;
+  std::string device_id = printer.device_id;
+  int64_t start_ms = MetricsNowMs();
+  auto fallback = [device_id, done]() {
+    RunOnMtaAsync([device_id, done]() { done(BluetoothConnectImpl(device_id)); });
+  };
+  if (printer.host_name.empty() || printer.service_name.empty()) {
+    fallback();
+    return;
+  }
+  try {
+    StreamSocket socket;
+    const char* span_detail = SpansActive() ? SpanInternName(device_id) : nullptr;
+    const int64_t connect_us = span_detail ? SpanNowUs() : -1;
+    auto op = socket.ConnectAsync(
+        winrt_win::Networking::HostName(winrt::to_hstring(printer.host_name)),
+        winrt::to_hstring(printer.service_name),
+        SocketProtectionLevel::BluetoothEncryptionAllowNullAuthentication);
+    op.Completed([socket, device_id, start_ms, span_detail, connect_us, done, fallback](auto const&,
+                                                                                       AsyncStatus status) {
+      if (connect_us >= 0) SpanRecordAsync("ConnectAsync", connect_us, SpanNowUs() - connect_us, span_detail);
+      if (status != AsyncStatus::Completed) {
+        BT_LOG("ReconnectRegistered: cached connect failed for " << device_id << ", status=" << (int)status);
+        try { socket.Close(); } catch (...) {}
+        fallback();
+        return;
+      }
+      int64_t connect_ms = MetricsNowMs() - start_ms;
+      RunOnMtaAsync([socket, device_id, connect_ms, done]() {
+        bool ok = AdoptSocket(device_id, socket);
+        if (ok) {
+          MetricsAdd("connect.count", 1);
+          MetricsSet("connect.last_ms", connect_ms);
+        }
+        done(ok);
+      });
+    });
+  } catch (const std::exception& e) {
+    BT_LOG("ReconnectRegistered ERROR: " << e.what());
+    fallback();
+  } catch (...) {
+    BT_LOG("ReconnectRegistered ERROR: unknown");
+    fallback();
+  }
+}
+
+/// Directory for persisted plugin state: %LOCALAPPDATA%\flutter_thermal_printer_windows
+/// (falls back to the temp directory).
+static std::string PluginDataDirectory() {
+  char buffer[MAX_PATH];
+  DWORD n = GetEnvironmentVariableA("LOCALAPPDATA", buffer, MAX_PATH);
+  std::string base;
+  if (n > 0 && n < MAX_PATH) {
+    base = std::string(buffer, n) + "\\";
+  } else if (GetTempPathA(MAX_PATH, buffer) > 0) {
+    base = buffer;
+  } else {
+    return "";
+  }
+  std::string dir = base + "flutter_thermal_printer_windows";
+  CreateDirectoryA(dir.c_str(), nullptr);
+  return dir;
+}
+
+void BluetoothWinRtInit() {
+  static std::once_flag init_once;
+  std::call_once(init_once, []() {
+    // Apartment init happens while the app is still starting, not on the first call.
+    StartMtaWorker();
+
+    int64_t load_start_ms = MetricsNowMs();
+    DeviceRegistry& registry = GetDeviceRegistry();
+    std::string dir = PluginDataDirectory();
+    if (!dir.empty()) {
+      registry.SetPath(dir + "\\devices.ini");
+      registry.Load();
+    }
+    std::vector<RegisteredPrinter> targets;
+    for (const auto& p : registry.All()) {
+      if (p.auto_reconnect) targets.push_back(p);
+    }
+    MetricsSet("startup.registry_load_ms", MetricsNowMs() - load_start_ms);
+    MetricsSet("startup.registered_printers", static_cast<int64_t>(targets.size()));
+    if (targets.empty()) {
+      MetricsSetOnce("startup.all_printers_ready_ms", MetricsNowMs());
+      return;
+    }
+    auto remaining = std::make_shared<std::atomic<int>>(static_cast<int>(targets.size()));
+    RunOnMtaAsync([targets, remaining]() {
+      for (const auto& p : targets) {
+        ReconnectRegisteredAsync(p, [remaining](bool ok) {
+          int64_t now_ms = MetricsNowMs();
+          if (ok) {
+            MetricsSetOnce("startup.first_printer_ready_ms", now_ms);
+            MetricsAdd("startup.reconnected_printers", 1);
+          } else {
+            MetricsAdd("startup.reconnect_failures", 1);
+          }
+          if (remaining->fetch_sub(1) == 1) {
+            MetricsSetOnce("startup.all_printers_ready_ms", now_ms);
+          }
+        });
+      }
+    });
+  });
 }
 
 bool BluetoothIsConnected(const std::string& device_id) {
-  bool result = false;
-  RunOnMta([&]() { result = (g_sockets.find(device_id) != g_sockets.end()); });
-  return result;
+  std::lock_guard<std::mutex> lock(g_connected_mutex);
+  return g_connected.count(device_id) != 0;
 }
 
 static bool BluetoothSendImpl(const std::string& device_id, const uint8_t* data, size_t size) {
-  auto it = g_sockets.find(device_id);
-  if (it == g_sockets.end()) {
+  auto it = g_transports.find(device_id);
+  if (it == g_transports.end()) {
     BT_LOG("BluetoothSendImpl ERROR: socket not found");
     return false;
   }
   if (size == 0) return true;
-  auto wit = g_writers.find(device_id);
-  if (wit == g_writers.end()) {
-    BT_LOG("BluetoothSendImpl ERROR: no DataWriter");
-    return false;
-  }
-  try {
-    std::vector<uint8_t> vec(data, data + size);
-    wit->second.WriteBytes(winrt::array_view<uint8_t>(vec));
-    wit->second.StoreAsync().get();
-    wit->second.FlushAsync().get();
-    return true;
-  } catch (const winrt::hresult_error& e) {
-    BT_LOG("BluetoothSendImpl ERROR: 0x" << std::hex << e.code() << " " << HStringToUtf8(e.message()));
-    return false;
-  } catch (const std::exception& e) {
-    BT_LOG("BluetoothSendImpl ERROR: " << e.what());
-    return false;
-  } catch (...) {
-    BT_LOG("BluetoothSendImpl ERROR: unknown");
-    return false;
-  }
+  // Printers with a small receive buffer drop what does not fit; the probe
+  // records its size.
+  RegisteredPrinter printer;
+  const size_t chunk_size = GetDeviceRegistry().Find(device_id, &printer) ? printer.write_chunk_size : 0;
+  return WriteInChunks(it->second.get(), data, size, chunk_size);
 }
 
 bool BluetoothSend(const std::string& device_id, const uint8_t* data, size_t size) {
@@ -451,4 +860,25 @@ void BluetoothSendAsync(const std::string& device_id,
   });
 }
 
+/// Per reply. A printer that ignores GS I costs two of these, once: the
+/// result is persisted.
+static constexpr int kProbeTimeoutMs = 300;
+
+void BluetoothProbeAsync(const std::string& device_id,
+                         std::function<void(bool, const PrinterIdentity&)> callback) {
+  RunOnMtaAsync([device_id, callback]() {
+    PrinterIdentity identity;
+    auto it = g_transports.find(device_id);
+    bool ok = it != g_transports.end() &&
+              ProbePrinterIdentity(it->second.get(), kProbeTimeoutMs, &identity);
+    try {
+      callback(ok, identity);
+    } catch (const std::exception& e) {
+      BT_LOG("BluetoothProbeAsync ERROR: " << e.what());
+    } catch (...) {
+      BT_LOG("BluetoothProbeAsync ERROR: callback threw");
+    }
+  });
+}
+
 }  // namespace flutter_thermal_printer_windows
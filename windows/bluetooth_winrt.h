@@ -7,6 +7,8 @@
 #include <unordered_map>
 #include <cstdint>
 
+#include "printer_capabilities.h"
+
 namespace flutter_thermal_printer_windows {
 
 struct SppDeviceInfo {
@@ -18,7 +20,9 @@ struct SppDeviceInfo {
   bool is_connected = false;
 };
 
-/// Initialize WinRT (call once, e.g. from plugin constructor).
+/// Initialize WinRT (call once, e.g. from plugin constructor). Starts the MTA
+/// worker, loads the device registry and reconnects registered printers in
+/// parallel in the background. Progress is reported as startup.* metrics.
 void BluetoothWinRtInit();
 
 /// Discover SPP (Serial Port Profile) Bluetooth devices (thermal printers).
@@ -49,16 +53,28 @@ void BluetoothUnpairDeviceAsync(const std::string& device_id,
                                 std::function<void(bool)> callback);
 
 /// Connect to SPP service. Returns true if connected. Socket stored internally.
+/// A connection that is already open and has not failed is kept as is.
 bool BluetoothConnect(const std::string& device_id);
 
 /// Async version: runs on worker, invokes callback(bool connected).
 void BluetoothConnectAsync(const std::string& device_id,
                            std::function<void(bool)> callback);
 
-/// Disconnect and close socket for device.
+/// Like BluetoothConnectAsync, but FromIdAsync and ConnectAsync complete on
+/// their Completed handlers instead of blocking the MTA worker, so several
+/// devices connect in parallel; only the socket hand-off runs on the worker.
+/// Keeps an existing connection. Invokes callback(bool connected) on the
+/// worker.
+void BluetoothConnectConcurrentAsync(const std::string& device_id,
+                                     std::function<void(bool)> callback);
+
+/// Disconnect and close socket for device. Returns without waiting: the
+/// device reads as disconnected at once and its socket is closed on the
+/// worker after the work already queued for it.
 void BluetoothDisconnect(const std::string& device_id);
 
-/// True if we have an open socket for this device.
+/// True if we have an open socket for this device. Does not wait for the
+/// worker.
 bool BluetoothIsConnected(const std::string& device_id);
 
 /// Send raw bytes to the device. Returns true on success.
@@ -70,6 +86,12 @@ void BluetoothSendAsync(const std::string& device_id,
                         size_t size,
                         std::function<void(bool)> callback);
 
+/// Probes the connected printer (GS I, DLE EOT) on the MTA worker, in order
+/// with queued sends, and invokes callback(ok, identity) there. ok is false
+/// if the device is not connected or the link failed.
+void BluetoothProbeAsync(const std::string& device_id,
+                         std::function<void(bool, const PrinterIdentity&)> callback);
+
 }  // namespace flutter_thermal_printer_windows
 
 #endif  // FLUTTER_PLUGIN_BLUETOOTH_WINRT_H_
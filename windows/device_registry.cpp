@@ -0,0 +1,231 @@
+#include "device_registry.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <filesystem>
+#include <system_error>
+#endif
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr const char* kRegistryHeader = "# flutter_thermal_printer_windows device registry v1";
+constexpr const char* kRecordStart = "[device]";
+
+/// Values are one line each; drop anything that would break the format.
+std::string SanitizeValue(const std::string& value) {
+  std::string out;
+  out.reserve(value.size());
+  for (char c : value) {
+    if (c != '\n' && c != '\r') out.push_back(c);
+  }
+  return out;
+}
+
+int64_t ParseInt(const std::string& value, int64_t fallback) {
+  if (value.empty()) return fallback;
+  char* end = nullptr;
+  long long v = std::strtoll(value.c_str(), &end, 10);
+  return (end && *end == '\0') ? static_cast<int64_t>(v) : fallback;
+}
+
+void ApplyField(RegisteredPrinter& p, const std::string& key, const std::string& value) {
+  if (key == "id") {
+    p.device_id = value;
+  } else if (key == "host") {
+    p.host_name = value;
+  } else if (key == "service") {
+    p.service_name = value;
+  } else if (key == "paperWidth") {
+    p.paper_width_mm = static_cast<int>(ParseInt(value, p.paper_width_mm));
+  } else if (key == "cutting") {
+    p.supports_cutting = ParseInt(value, 1) != 0;
+  } else if (key == "partialCut") {
+    p.supports_partial_cut = ParseInt(value, 0) != 0;
+  } else if (key == "images") {
+    p.supports_images = ParseInt(value, 1) != 0;
+  } else if (key == "probed") {
+    p.capabilities_probed = ParseInt(value, 0) != 0;
+  } else if (key == "model") {
+    p.model_name = value;
+  } else if (key == "maker") {
+    p.manufacturer = value;
+  } else if (key == "firmware") {
+    p.firmware_version = value;
+  } else if (key == "dotsPerLine") {
+    int64_t v = ParseInt(value, 0);
+    p.dots_per_line = v > 0 ? static_cast<int>(v) : 0;
+  } else if (key == "raster") {
+    p.supports_raster = ParseInt(value, 1) != 0;
+  } else if (key == "barcodeCommands") {
+    p.supports_barcode_commands = ParseInt(value, 0) != 0;
+  } else if (key == "status") {
+    p.supports_status = ParseInt(value, 0) != 0;
+  } else if (key == "chunkSize") {
+    int64_t v = ParseInt(value, 0);
+    p.write_chunk_size = v > 0 ? static_cast<size_t>(v) : 0;
+  } else if (key == "lastConnectMs") {
+    p.last_connect_ms = ParseInt(value, 0);
+  } else if (key == "autoReconnect") {
+    p.auto_reconnect = ParseInt(value, 1) != 0;
+  }
+  // Unknown keys are ignored so newer files still load.
+}
+
+}  // namespace
+
+void DeviceRegistry::SetPath(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  path_ = path;
+}
+
+bool DeviceRegistry::Load() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  printers_.clear();
+  if (path_.empty()) return false;
+  std::ifstream in(path_);
+  if (!in) return false;
+  std::string line;
+  bool have_record = false;
+  RegisteredPrinter current;
+  auto finish = [&]() {
+    if (have_record && !current.device_id.empty()) printers_.push_back(current);
+    current = RegisteredPrinter();
+    have_record = false;
+  };
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+    if (line == kRecordStart) {
+      finish();
+      have_record = true;
+      continue;
+    }
+    size_t eq = line.find('=');
+    if (!have_record || eq == std::string::npos) continue;
+    ApplyField(current, line.substr(0, eq), line.substr(eq + 1));
+  }
+  finish();
+  return true;
+}
+
+bool DeviceRegistry::Save() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (path_.empty()) return false;
+  std::ostringstream out;
+  out << kRegistryHeader << "\n";
+  for (const auto& p : printers_) {
+    out << kRecordStart << "\n"
+        << "id=" << SanitizeValue(p.device_id) << "\n"
+        << "host=" << SanitizeValue(p.host_name) << "\n"
+        << "service=" << SanitizeValue(p.service_name) << "\n"
+        << "paperWidth=" << p.paper_width_mm << "\n"
+        << "cutting=" << (p.supports_cutting ? 1 : 0) << "\n"
+        << "partialCut=" << (p.supports_partial_cut ? 1 : 0) << "\n"
+        << "images=" << (p.supports_images ? 1 : 0) << "\n"
+        << "probed=" << (p.capabilities_probed ? 1 : 0) << "\n"
+        << "model=" << SanitizeValue(p.model_name) << "\n"
+        << "maker=" << SanitizeValue(p.manufacturer) << "\n"
+        << "firmware=" << SanitizeValue(p.firmware_version) << "\n"
+        << "dotsPerLine=" << p.dots_per_line << "\n"
+        << "raster=" << (p.supports_raster ? 1 : 0) << "\n"
+        << "barcodeCommands=" << (p.supports_barcode_commands ? 1 : 0) << "\n"
+        << "status=" << (p.supports_status ? 1 : 0) << "\n"
+        << "chunkSize=" << p.write_chunk_size << "\n"
+        << "lastConnectMs=" << p.last_connect_ms << "\n"
+        << "autoReconnect=" << (p.auto_reconnect ? 1 : 0) << "\n";
+  }
+  std::string tmp = path_ + ".tmp";
+  {
+    std::ofstream f(tmp, std::ios::trunc);
+    if (!f) return false;
+    f << out.str();
+    f.flush();
+    if (!f) return false;
+  }
+  // Replace in one step so a crash leaves either the old or the new file.
+#ifdef _WIN32
+  return MoveFileExA(tmp.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  std::error_code error;
+  std::filesystem::rename(tmp, path_, error);
+  return !error;
+#endif
+}
+
+std::vector<RegisteredPrinter> DeviceRegistry::All() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return printers_;
+}
+
+bool DeviceRegistry::Find(const std::string& device_id, RegisteredPrinter* out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& p : printers_) {
+    if (p.device_id == device_id) {
+      if (out) *out = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+void DeviceRegistry::Upsert(const RegisteredPrinter& printer) {
+  if (printer.device_id.empty()) return;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& p : printers_) {
+    if (p.device_id == printer.device_id) {
+      p = printer;
+      return;
+    }
+  }
+  printers_.push_back(printer);
+}
+
+bool DeviceRegistry::Update(const std::string& device_id,
+                            const std::function<void(RegisteredPrinter& printer, bool existed)>& fn,
+                            bool create) {
+  if (device_id.empty()) return false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& p : printers_) {
+    if (p.device_id == device_id) {
+      fn(p, true);
+      p.device_id = device_id;
+      return true;
+    }
+  }
+  if (!create) return false;
+  RegisteredPrinter printer;
+  printer.device_id = device_id;
+  fn(printer, false);
+  printer.device_id = device_id;
+  printers_.push_back(std::move(printer));
+  return true;
+}
+
+void DeviceRegistry::Remove(const std::string& device_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = printers_.begin(); it != printers_.end(); ++it) {
+    if (it->device_id == device_id) {
+      printers_.erase(it);
+      return;
+    }
+  }
+}
+
+DeviceRegistry& GetDeviceRegistry() {
+  static DeviceRegistry registry;
+  return registry;
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,95 @@
+#ifndef FLUTTER_PLUGIN_DEVICE_REGISTRY_H_
+#define FLUTTER_PLUGIN_DEVICE_REGISTRY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+/// A printer we have connected to before. Persisted so the plugin can
+/// reconnect on startup without scanning or resolving the RFCOMM service again.
+struct RegisteredPrinter {
+  std::string device_id;
+  /// Resolved RFCOMM service: ConnectionHostName().RawName() and ConnectionServiceName().
+  std::string host_name;
+  std::string service_name;
+  /// Capabilities reported by getPrinterCapabilities.
+  int paper_width_mm = 58;
+  bool supports_cutting = true;
+  bool supports_partial_cut = false;
+  bool supports_images = true;
+  /// Set once the printer has been probed (see printer_capabilities.h); the
+  /// fields below keep their defaults until then.
+  bool capabilities_probed = false;
+  /// GS I model, maker and firmware strings; empty if not reported.
+  std::string model_name;
+  std::string manufacturer;
+  std::string firmware_version;
+  /// Print head width in dots; 0 = unknown.
+  int dots_per_line = 0;
+  /// Accepts GS v 0 raster images; otherwise images go out as ESC * strips.
+  bool supports_raster = true;
+  /// Firmware draws GS k barcodes (Code128 beyond a few dozen bytes
+  /// included) and GS ( k QR codes. Only set for known models; barcodes for
+  /// other printers are rasterized (see barcode_raster.h).
+  bool supports_barcode_commands = false;
+  /// Answers DLE EOT real-time status requests.
+  bool supports_status = false;
+  /// Last-good settings: write chunk size (the printer's receive buffer;
+  /// 0 = whole job) and connect latency. Bluetooth sends are written and
+  /// flushed in pieces of this size, and image bands are sized to fit it.
+  /// LAN sends ignore it: TCP flow control already paces them.
+  size_t write_chunk_size = 0;
+  int64_t last_connect_ms = 0;
+  /// Cleared on explicit disconnect so startup does not reconnect it.
+  bool auto_reconnect = true;
+};
+
+/// Small line-based store of RegisteredPrinter records. Thread-safe.
+class DeviceRegistry {
+ public:
+  DeviceRegistry() = default;
+
+  /// Set the backing file. Does not load it.
+  void SetPath(const std::string& path);
+  const std::string& path() const { return path_; }
+
+  /// Replace in-memory records with the file contents. Returns false if the
+  /// file is missing or unreadable (records are then empty).
+  bool Load();
+
+  /// Write all records to the file via a temp file that atomically replaces
+  /// it. Returns false on I/O error.
+  bool Save() const;
+
+  std::vector<RegisteredPrinter> All() const;
+  bool Find(const std::string& device_id, RegisteredPrinter* out) const;
+  void Upsert(const RegisteredPrinter& printer);
+
+  /// Read-modify-write of one record under the registry lock, so callers
+  /// changing different fields of the same printer concurrently keep each
+  /// other's changes. [fn] gets the record and whether it existed; a missing
+  /// record is added (device_id set, other fields default) unless [create]
+  /// is false, in which case fn is not called and false is returned. [fn]
+  /// must not call back into the registry.
+  bool Update(const std::string& device_id,
+              const std::function<void(RegisteredPrinter& printer, bool existed)>& fn,
+              bool create = true);
+  void Remove(const std::string& device_id);
+
+ private:
+  mutable std::mutex mutex_;
+  std::string path_;
+  std::vector<RegisteredPrinter> printers_;
+};
+
+/// Process-wide registry used by the plugin and the Bluetooth layer.
+DeviceRegistry& GetDeviceRegistry();
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_DEVICE_REGISTRY_H_
@@ -0,0 +1,326 @@
+#include "escpos_optimizer.h"
+
+#include <cstring>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr uint8_t kLf = 0x0A;
+constexpr uint8_t kDle = 0x10;
+constexpr uint8_t kEsc = 0x1B;
+constexpr uint8_t kFs = 0x1C;
+constexpr uint8_t kGs = 0x1D;
+
+/// Returned by CommandLength for commands we cannot size.
+constexpr size_t kUnknownLength = 0;
+constexpr size_t kNoFeed = static_cast<size_t>(-1);
+
+/// Byte length of the command starting at [p], kUnknownLength if not
+/// recognised, or more than [remaining] if truncated.
+size_t CommandLength(const uint8_t* p, size_t remaining) {
+  if (remaining < 2) return remaining + 1;
+  const uint8_t c = p[1];
+  auto byte = [&](size_t k) -> int { return k < remaining ? p[k] : -1; };
+  switch (p[0]) {
+    case kEsc:
+      switch (c) {
+        case '@': case '2': case '<': case 'S': case 'L':
+          return 2;
+        case 'E': case '-': case 'a': case 'd': case '!': case '3': case 'J':
+        case 't': case 'R': case 'M': case 'G': case ' ': case '{': case 'V':
+        case 'U': case 'e': case 'r':
+          return 3;
+        case '$': case '\\':
+          return 4;
+        case 'c': {
+          int sub = byte(2);
+          if (sub < 0) return remaining + 1;
+          return (sub == '3' || sub == '4' || sub == '5') ? 4 : kUnknownLength;
+        }
+        case 'p':
+          return 5;
+        default:
+          return kUnknownLength;
+      }
+    case kGs:
+      switch (c) {
+        case '!': case 'h': case 'w': case 'H': case 'f': case 'B': case 'a':
+        case 'I': case 'r': case 'b':
+          return 3;
+        case 'L': case 'W': case 'P': case '$': case '\\':
+          return 4;
+        case 'V': {
+          int m = byte(2);
+          if (m < 0) return remaining + 1;
+          if (m == 0 || m == 1 || m == 48 || m == 49) return 3;
+          if (m == 65 || m == 66 || m == 97 || m == 98 || m == 103 || m == 104) return 4;
+          return kUnknownLength;
+        }
+        case 'v': {
+          if (remaining < 8) return remaining + 1;
+          if (p[2] != '0') return kUnknownLength;
+          size_t x = p[4] | (p[5] << 8);
+          size_t y = p[6] | (p[7] << 8);
+          return 8 + x * y;
+        }
+        case 'k': {
+          int m = byte(2);
+          if (m < 0) return remaining + 1;
+          if (m <= 6) {
+            const void* nul = std::memchr(p + 3, 0, remaining > 3 ? remaining - 3 : 0);
+            if (!nul) return remaining + 1;
+            return static_cast<size_t>(static_cast<const uint8_t*>(nul) - p) + 1;
+          }
+          if (m >= 65 && m <= 79) {
+            int n = byte(3);
+            if (n < 0) return remaining + 1;
+            return 4 + static_cast<size_t>(n);
+          }
+          return kUnknownLength;
+        }
+        case '(': {
+          if (remaining < 5) return remaining + 1;
+          return 5 + (p[3] | (p[4] << 8));
+        }
+        default:
+          return kUnknownLength;
+      }
+    case kDle:
+      return (c == 0x04 || c == 0x05) ? 3 : kUnknownLength;
+    case kFs:
+      if (c == '&' || c == '.') return 2;
+      if (c == 'p') return 4;
+      return kUnknownLength;
+    default:
+      return kUnknownLength;
+  }
+}
+
+/// ESC - / ESC a accept 0-2 or '0'-'2'. Returns -1 for anything else.
+int NormalizeTriState(uint8_t n) {
+  if (n <= 2) return n;
+  if (n >= '0' && n <= '2') return n - '0';
+  return -1;
+}
+
+enum Mode { kBold = 0, kUnderline, kSize, kAlign, kModeCount };
+
+struct ModeSlot {
+  bool known = false;
+  uint8_t value = 0;
+  bool pending = false;
+  uint8_t pending_value = 0;
+  uint8_t command[3] = {0, 0, 0};
+};
+
+class EscPosOptimizer {
+ public:
+  EscPosOptimizer(const uint8_t* data, size_t size, EscPosOptimizeStats* stats)
+      : data_(data), size_(size), stats_(stats) {
+    out_.reserve(size);
+  }
+
+  std::vector<uint8_t> Run() {
+    size_t i = 0;
+    while (i < size_) {
+      const uint8_t b = data_[i];
+      if (b >= 0x20) {
+        size_t end = i + 1;
+        while (end < size_ && data_[end] >= 0x20) end++;
+        FlushAll();
+        Emit(data_ + i, end - i);
+        line_empty_ = false;
+        i = end;
+        continue;
+      }
+      if (b == kLf) {
+        // No mode change moves across a line break: some firmware applies a
+        // mid-line ESC a to the line it is on, and an empty line's height
+        // depends on the character size.
+        FlushAll();
+        Emit(data_ + i, 1);
+        line_empty_ = true;
+        i++;
+        continue;
+      }
+      if (b != kEsc && b != kGs && b != kDle && b != kFs) {
+        FlushAll();
+        Emit(data_ + i, 1);
+        line_empty_ = false;
+        i++;
+        continue;
+      }
+      const size_t len = CommandLength(data_ + i, size_ - i);
+      if (len == kUnknownLength || len > size_ - i) {
+        // Cannot resynchronise after this point: keep the rest byte for byte.
+        FlushAll();
+        Emit(data_ + i, size_ - i);
+        break;
+      }
+      HandleCommand(data_ + i, len);
+      i += len;
+    }
+    FlushAll();
+    if (stats_) {
+      stats_->input_bytes += size_;
+      stats_->output_bytes += out_.size();
+    }
+    return std::move(out_);
+  }
+
+ private:
+  void HandleCommand(const uint8_t* p, size_t len) {
+    const uint8_t c = p[1];
+    if (p[0] == kEsc) {
+      switch (c) {
+        case '@':
+          // Reset makes every pending change dead. Power-on defaults can be
+          // changed by memory switches, so the state after it stays unknown.
+          for (auto& slot : slots_) {
+            if (slot.pending) CountRemoved();
+            slot = ModeSlot();
+          }
+          Emit(p, len);
+          line_empty_ = true;
+          return;
+        case 'E':
+          SetMode(kBold, p[2] & 1, p);
+          return;
+        case '-':
+        case 'a': {
+          Mode mode = (c == '-') ? kUnderline : kAlign;
+          int v = NormalizeTriState(p[2]);
+          if (v >= 0) {
+            SetMode(mode, static_cast<uint8_t>(v), p);
+          } else {
+            PassThroughInvalidating(p, len, mode);
+          }
+          return;
+        }
+        case '!':
+          // ESC ! rewrites bold, underline and size together.
+          FlushAll();
+          Emit(p, len);
+          slots_[kBold].known = false;
+          slots_[kUnderline].known = false;
+          slots_[kSize].known = false;
+          return;
+        case 'd':
+          Feed(p);
+          return;
+        case 'p':
+          Emit(p, len);  // cash drawer pulse: prints nothing
+          return;
+        default:
+          break;
+      }
+    } else if (p[0] == kGs) {
+      switch (c) {
+        case '!':
+          SetMode(kSize, p[2], p);
+          return;
+        case 'v':
+          // Raster images follow justification only.
+          FlushMode(kAlign);
+          Emit(p, len);
+          line_empty_ = true;
+          return;
+        case 'V':
+        case 'I':
+        case 'r':
+          Emit(p, len);  // cut and status/ID queries print nothing
+          return;
+        default:
+          break;
+      }
+    } else if (p[0] == kDle) {
+      Emit(p, len);  // real-time requests
+      return;
+    }
+    FlushAll();
+    Emit(p, len);
+    line_empty_ = false;
+  }
+
+  void SetMode(Mode mode, uint8_t value, const uint8_t* command) {
+    ModeSlot& slot = slots_[mode];
+    if (slot.pending) CountRemoved();  // overwritten before anything used it
+    slot.pending = true;
+    slot.pending_value = value;
+    std::memcpy(slot.command, command, 3);
+  }
+
+  void PassThroughInvalidating(const uint8_t* p, size_t len, Mode mode) {
+    FlushAll();
+    Emit(p, len);
+    slots_[mode].known = false;
+  }
+
+  void FlushMode(Mode mode) {
+    ModeSlot& slot = slots_[mode];
+    if (!slot.pending) return;
+    slot.pending = false;
+    if (slot.known && slot.value == slot.pending_value) {
+      CountRemoved();
+      return;
+    }
+    Emit(slot.command, 3);
+    slot.known = true;
+    slot.value = slot.pending_value;
+  }
+
+  void FlushAll() {
+    for (int m = 0; m < kModeCount; m++) FlushMode(static_cast<Mode>(m));
+  }
+
+  void Feed(const uint8_t* command) {
+    const uint8_t n = command[2];
+    if (n == 0 && line_empty_) {
+      CountMergedFeed();  // prints nothing, so pending modes stay pending
+      return;
+    }
+    FlushAll();  // prints the line, like LF
+    if (last_feed_pos_ != kNoFeed && out_[last_feed_pos_ + 2] + n <= 255) {
+      out_[last_feed_pos_ + 2] = static_cast<uint8_t>(out_[last_feed_pos_ + 2] + n);
+      CountMergedFeed();
+      return;
+    }
+    Emit(command, 3);
+    last_feed_pos_ = out_.size() - 3;
+    line_empty_ = true;
+  }
+
+  void Emit(const uint8_t* p, size_t n) {
+    out_.insert(out_.end(), p, p + n);
+    last_feed_pos_ = kNoFeed;
+  }
+
+  void CountRemoved() {
+    if (stats_) stats_->removed_mode_changes++;
+  }
+
+  void CountMergedFeed() {
+    if (stats_) stats_->merged_feeds++;
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+  EscPosOptimizeStats* stats_;
+  std::vector<uint8_t> out_;
+  ModeSlot slots_[kModeCount];
+  /// Output offset of the last command if it was an ESC d, else kNoFeed.
+  size_t last_feed_pos_ = kNoFeed;
+  /// True when the print buffer is known to be empty (start of line).
+  bool line_empty_ = false;
+};
+
+}  // namespace
+
+std::vector<uint8_t> OptimizeEscPos(const uint8_t* data, size_t size,
+                                    EscPosOptimizeStats* stats) {
+  if (!data || size == 0) return {};
+  return EscPosOptimizer(data, size, stats).Run();
+}
+
+}  // namespace flutter_thermal_printer_windows
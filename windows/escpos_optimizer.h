@@ -0,0 +1,32 @@
+#ifndef FLUTTER_PLUGIN_ESCPOS_OPTIMIZER_H_
+#define FLUTTER_PLUGIN_ESCPOS_OPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+struct EscPosOptimizeStats {
+  size_t input_bytes = 0;
+  size_t output_bytes = 0;
+  /// Mode commands (ESC E, ESC -, ESC a, GS !) dropped as redundant or overwritten.
+  size_t removed_mode_changes = 0;
+  /// ESC d feeds folded into the previous feed or dropped as no-ops.
+  size_t merged_feeds = 0;
+};
+
+/// Peephole pass over an ESC/POS job. Tracks bold, underline, alignment and
+/// character size, emits a mode change only right before the output it can
+/// affect (never later than the end of its line) and only if it differs from
+/// the printer's known state, and merges adjacent ESC d feeds. Printer state
+/// is unknown at the start of every job.
+///
+/// The printed result is unchanged: anything the parser does not recognise is
+/// copied verbatim (and, for unknown command lengths, so is the rest of the job).
+std::vector<uint8_t> OptimizeEscPos(const uint8_t* data, size_t size,
+                                    EscPosOptimizeStats* stats = nullptr);
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_ESCPOS_OPTIMIZER_H_
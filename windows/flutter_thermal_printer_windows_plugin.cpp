@@ -1,16 +1,35 @@
 #include "flutter_thermal_printer_windows_plugin.h"
+#include "barcode_raster.h"
 #include "bluetooth_winrt.h"
+#include "device_registry.h"
+#include "escpos_optimizer.h"
+#include "native_metrics.h"
+#include "printer_capabilities.h"
+#include "printer_job_queue.h"
+#include "provisioning.h"
+#include "raster_pipeline.h"
+#include "single_flight.h"
+#include "tcp_printers.h"
+#include "trace_capture.h"
+#include "trace_spans.h"
 
+#ifdef _WIN32
 #include <windows.h>
 #include <VersionHelpers.h>
+#endif
 
 #include <flutter/method_channel.h>
 
+#include <algorithm>
+#include <condition_variable>
 #include <exception>
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace {
+#ifdef _WIN32
 void PluginLog(const std::string& msg) {
   OutputDebugStringA("[ThermalPlugin] ");
   OutputDebugStringA(msg.c_str());
@@ -25,10 +44,18 @@ void PluginLog(const std::string& msg) {
     }
   }
 }
+#else
+// Host builds (load harness) run headless; logging would only skew timings.
+void PluginLog(const std::string&) {}
+#endif
 #define PLUGIN_LOG(x) do { std::ostringstream _s; _s << x; PluginLog(_s.str()); } while(0)
 }  // namespace
+#ifdef _WIN32
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
+#endif
 
 #include <memory>
 #include <sstream>
@@ -70,8 +97,388 @@ std::string GetPrinterIdFromArgs(const flutter::EncodableValue* args_value) {
   return s ? *s : "";
 }
 
+int GetIntArg(const flutter::EncodableMap& args, const char* key, int fallback) {
+  auto it = args.find(flutter::EncodableValue(key));
+  if (it == args.end()) return fallback;
+  if (const auto* i = std::get_if<int32_t>(&it->second)) return *i;
+  if (const auto* l = std::get_if<int64_t>(&it->second)) return static_cast<int>(*l);
+  return fallback;
+}
+
+bool GetBoolArg(const flutter::EncodableMap& args, const char* key, bool fallback) {
+  auto it = args.find(flutter::EncodableValue(key));
+  if (it == args.end()) return fallback;
+  const auto* b = std::get_if<bool>(&it->second);
+  return b ? *b : fallback;
+}
+
+/// Answer of a DLE EOT status query to a LAN printer.
+struct StatusAnswer {
+  bool answered = false;
+  PrinterStatusReport report;
+};
+
+/// One SPP enumeration serves every concurrent scanForPrinters and
+/// getPairedPrinters call; the enumeration otherwise runs once per caller,
+/// back to back on the MTA worker.
+SingleFlight<std::vector<SppDeviceInfo>>& SppScans() {
+  static auto* flights = new SingleFlight<std::vector<SppDeviceInfo>>();
+  return *flights;
+}
+
+/// Concurrent status queries to the same LAN printer share one round trip.
+SingleFlight<StatusAnswer>& StatusQueries() {
+  static auto* flights = new SingleFlight<StatusAnswer>();
+  return *flights;
+}
+
+/// Result of probing a printer: the capability record after the probe
+/// (ok == false if the printer was not connected or the link failed).
+struct ProbeAnswer {
+  bool ok = false;
+  RegisteredPrinter printer;
+};
+
+/// Concurrent probes of the same printer (connect + explicit probe) share one.
+SingleFlight<ProbeAnswer>& CapabilityProbes() {
+  static auto* flights = new SingleFlight<ProbeAnswer>();
+  return *flights;
+}
+
+constexpr char kSppScanKey[] = "spp";
+
+void RecordFlight(const std::string& query, FlightJoin join) {
+  switch (join) {
+    case FlightJoin::kStarted:
+      MetricsAdd("query." + query + ".started", 1);
+      break;
+    case FlightJoin::kJoined:
+      MetricsAdd("query." + query + ".joined", 1);
+      break;
+    case FlightJoin::kCached:
+      MetricsAdd("query." + query + ".cached", 1);
+      break;
+  }
+}
+
+void FindSppDevicesShared(std::function<void(const std::vector<SppDeviceInfo>&)> callback) {
+  FlightJoin join = SppScans().Do(kSppScanKey, std::move(callback), [](auto done) {
+    BluetoothFindAllSppDevicesAsync([done](std::vector<SppDeviceInfo> devices) { done(devices); });
+  });
+  RecordFlight("scan", join);
+}
+
+/// Pairing and connection changes make cached scans and status stale.
+void InvalidateQueries(const std::string& id) {
+  SppScans().Invalidate(kSppScanKey);
+  StatusQueries().Invalidate(id);
+}
+
+/// Persisted capabilities of [id]; defaults for printers never seen before.
+RegisteredPrinter FindCapabilities(const std::string& id) {
+  RegisteredPrinter printer;
+  if (!GetDeviceRegistry().Find(id, &printer)) printer.device_id = id;
+  return printer;
+}
+
+RegisteredPrinter RecordCapabilities(const std::string& id, const PrinterIdentity& identity) {
+  DeviceRegistry& registry = GetDeviceRegistry();
+  RegisteredPrinter printer;
+  registry.Update(id, [&](RegisteredPrinter& record, bool existed) {
+    // LAN printers and printers probed before their first connect record
+    // only capabilities; startup reconnects Bluetooth records with a host.
+    if (!existed) record.auto_reconnect = false;
+    ApplyPrinterIdentity(identity, &record);
+    printer = record;
+  });
+  registry.Save();
+  MetricsAdd(identity.answered ? "capabilities.identified" : "capabilities.silent", 1);
+  return printer;
+}
+
+/// Probes [id] over its open connection and persists the result.
+void ProbeCapabilitiesShared(const std::string& id, std::function<void(const ProbeAnswer&)> callback) {
+  FlightJoin join = CapabilityProbes().Do(id, std::move(callback), [id](auto done) {
+    auto finish = [id, done](bool ok, const PrinterIdentity& identity) {
+      ProbeAnswer answer;
+      answer.ok = ok;
+      answer.printer = ok ? RecordCapabilities(id, identity) : FindCapabilities(id);
+      done(answer);
+    };
+    if (IsTcpPrinterId(id)) {
+      TcpProbeAsync(id, finish);
+    } else {
+      BluetoothProbeAsync(id, finish);
+    }
+  });
+  RecordFlight("probe", join);
+}
+
+flutter::EncodableMap CapabilitiesToEncodableMap(const RegisteredPrinter& caps) {
+  flutter::EncodableMap out;
+  out[flutter::EncodableValue("maxPaperWidth")] = flutter::EncodableValue(caps.paper_width_mm);
+  out[flutter::EncodableValue("supportsCutting")] = flutter::EncodableValue(caps.supports_cutting);
+  out[flutter::EncodableValue("supportsImages")] = flutter::EncodableValue(caps.supports_images);
+  out[flutter::EncodableValue("supportsPartialCut")] = flutter::EncodableValue(caps.supports_partial_cut);
+  out[flutter::EncodableValue("probed")] = flutter::EncodableValue(caps.capabilities_probed);
+  out[flutter::EncodableValue("modelName")] = StringToEncodable(caps.model_name);
+  out[flutter::EncodableValue("manufacturer")] = StringToEncodable(caps.manufacturer);
+  out[flutter::EncodableValue("firmwareVersion")] = StringToEncodable(caps.firmware_version);
+  out[flutter::EncodableValue("dotsPerLine")] = flutter::EncodableValue(caps.dots_per_line);
+  out[flutter::EncodableValue("supportsRasterImages")] = flutter::EncodableValue(caps.supports_raster);
+  out[flutter::EncodableValue("supportsBarcodeCommands")] = flutter::EncodableValue(caps.supports_barcode_commands);
+  out[flutter::EncodableValue("supportsStatus")] = flutter::EncodableValue(caps.supports_status);
+  out[flutter::EncodableValue("writeChunkSize")] =
+      flutter::EncodableValue(static_cast<int64_t>(caps.write_chunk_size));
+  return out;
+}
+
+constexpr int kDefaultBandHeight = 24;
+
+/// Rows per band of an image [width] dots wide: as many as fit the printer's
+/// receive buffer, so an image goes out in the fewest sends the printer
+/// still takes whole.
+int BandHeightFor(const RegisteredPrinter& caps, int width) {
+  if (caps.write_chunk_size == 0 || width <= 0) return kDefaultBandHeight;
+  const size_t row_bytes = static_cast<size_t>(width + 7) / 8;
+  const size_t header_bytes = 8;
+  if (caps.write_chunk_size <= header_bytes + row_bytes) return 1;
+  return static_cast<int>(std::min<size_t>((caps.write_chunk_size - header_bytes) / row_bytes, 0xFFFF));
+}
+
+/// Bands queued on the MTA worker at once. Two keeps the link busy while the
+/// next band is converted without letting memory grow with image height.
+constexpr int kMaxImageBandsInFlight = 2;
+
+/// Sends to a LAN printer ("tcp:" id) or over Bluetooth; both copy [data].
+void PrinterSendAsync(const std::string& id,
+                      const uint8_t* data,
+                      size_t size,
+                      std::function<void(bool)> callback) {
+  if (IsTcpPrinterId(id)) {
+    TcpSendAsync(id, std::vector<uint8_t>(data, data + size), std::move(callback));
+  } else {
+    BluetoothSendAsync(id, data, size, std::move(callback));
+  }
+}
+
+/// Runs [produce] on the calling thread and hands each band it emits to the
+/// MTA worker as soon as it is encoded, so the printer starts on the first
+/// band while later ones are still being converted. [bands] counts them.
+bool StreamBandsToPrinter(const std::string& id,
+                          const std::function<bool(const RasterBandSink&)>& produce,
+                          int64_t* bands) {
+  struct InFlight {
+    std::mutex mutex;
+    std::condition_variable cv;
+    int count = 0;
+    bool failed = false;
+  };
+  auto state = std::make_shared<InFlight>();
+  bool converted = produce([&](const uint8_t* data, size_t size) {
+    {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->cv.wait(lock, [&state] {
+        return state->count < kMaxImageBandsInFlight || state->failed;
+      });
+      if (state->failed) return false;
+      state->count++;
+    }
+    (*bands)++;
+    PrinterSendAsync(id, data, size, [state](bool ok) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->count--;
+      if (!ok) state->failed = true;
+      state->cv.notify_all();
+    });
+    return true;
+  });
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&state] { return state->count == 0; });
+  return converted && !state->failed;
+}
+
+bool StreamImageToPrinter(const std::string& id, const RasterImageSource& source) {
+  int64_t start_ms = MetricsNowMs();
+  int64_t bands = 0;
+  bool ok = StreamBandsToPrinter(
+      id,
+      [&](const RasterBandSink& sink) {
+        return StreamRasterImage(source, [&](const uint8_t* data, size_t size) {
+          if (bands == 0) MetricsSet("image.last_first_band_ms", MetricsNowMs() - start_ms);
+          return sink(data, size);
+        });
+      },
+      &bands);
+  MetricsSet("image.last_total_ms", MetricsNowMs() - start_ms);
+  MetricsAdd("image.bands", bands);
+  return ok;
+}
+
+/// Renders [spec] (or takes it from the cache) and streams it as GS v 0
+/// bands, or ESC * strips for printers without GS v 0. [rendered] is false
+/// if the data cannot be rasterized at all.
+bool PrintBarcodeRaster(const std::string& id,
+                        const BarcodeSpec& spec,
+                        const RegisteredPrinter& caps,
+                        bool* rendered) {
+  bool hit = false;
+  std::shared_ptr<const BarcodeBitmap> bitmap;
+  {
+    ScopedSpan span("RasterizeBarcode");
+    bitmap = GetBarcodeBitmapCache().Get(spec, &hit);
+  }
+  *rendered = bitmap != nullptr;
+  if (!bitmap) return false;
+  MetricsAdd(hit ? "barcode.cache_hits" : "barcode.cache_misses", 1);
+  const RasterCommand command = caps.supports_raster ? RasterCommand::kGsV0 : RasterCommand::kEscStar24;
+  const int band_height = BandHeightFor(caps, bitmap->width);
+  int64_t bands = 0;
+  return StreamBandsToPrinter(
+      id,
+      [&](const RasterBandSink& sink) {
+        return StreamBitmapBands(bitmap->bits.data(), bitmap->width, bitmap->height, bitmap->row_bytes, command,
+                                 band_height, sink);
+      },
+      &bands);
+}
+
+/// Where provisioning progress goes while Dart listens on the
+/// "flutter_thermal_printer_windows/provisioning" event channel.
+struct ProvisioningSink {
+  std::mutex mutex;
+  std::function<void(const flutter::EncodableValue&)> send;
+};
+
+ProvisioningSink& ProvisioningEvents() {
+  static auto* sink = new ProvisioningSink();
+  return *sink;
+}
+
+#ifdef _WIN32
+// Only the Windows event channel registers a listener; host builds emit
+// into the empty sink.
+void SetProvisioningEventSink(std::function<void(const flutter::EncodableValue&)> send) {
+  ProvisioningSink& sink = ProvisioningEvents();
+  std::lock_guard<std::mutex> lock(sink.mutex);
+  sink.send = std::move(send);
+}
+#endif
+
+void EmitProvisioningEvent(const flutter::EncodableValue& event) {
+  std::function<void(const flutter::EncodableValue&)> send;
+  {
+    ProvisioningSink& sink = ProvisioningEvents();
+    std::lock_guard<std::mutex> lock(sink.mutex);
+    send = sink.send;
+  }
+  if (send) send(event);
+}
+
+const char* ProvisionStepName(ProvisionStep step) {
+  switch (step) {
+    case ProvisionStep::kPair:
+      return "pair";
+    case ProvisionStep::kConnect:
+      return "connect";
+    case ProvisionStep::kProbe:
+      return "probe";
+    case ProvisionStep::kTestPrint:
+      return "testPrint";
+  }
+  return "";
+}
+
+const char* ProvisionEventName(ProvisionEventKind kind) {
+  switch (kind) {
+    case ProvisionEventKind::kStepStarted:
+      return "stepStarted";
+    case ProvisionEventKind::kStepSucceeded:
+      return "stepSucceeded";
+    case ProvisionEventKind::kStepRetrying:
+      return "stepRetrying";
+    case ProvisionEventKind::kDeviceSucceeded:
+      return "deviceSucceeded";
+    case ProvisionEventKind::kDeviceFailed:
+      return "deviceFailed";
+  }
+  return "";
+}
+
+flutter::EncodableMap ProvisionEventToEncodableMap(const std::string& run_id, const ProvisionEvent& event) {
+  flutter::EncodableMap out;
+  out[flutter::EncodableValue("runId")] = StringToEncodable(run_id);
+  out[flutter::EncodableValue("id")] = StringToEncodable(event.device_id);
+  out[flutter::EncodableValue("event")] = flutter::EncodableValue(ProvisionEventName(event.kind));
+  out[flutter::EncodableValue("step")] = flutter::EncodableValue(ProvisionStepName(event.step));
+  out[flutter::EncodableValue("attempt")] = flutter::EncodableValue(event.attempt);
+  out[flutter::EncodableValue("retryInMs")] = flutter::EncodableValue(event.retry_in_ms);
+  out[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue(event.elapsed_ms);
+  return out;
+}
+
+flutter::EncodableMap ProvisionResultToEncodableMap(const ProvisionResult& result) {
+  flutter::EncodableMap out;
+  out[flutter::EncodableValue("id")] = StringToEncodable(result.device_id);
+  out[flutter::EncodableValue("ok")] = flutter::EncodableValue(result.ok);
+  out[flutter::EncodableValue("step")] = flutter::EncodableValue(ProvisionStepName(result.last_step));
+  out[flutter::EncodableValue("attempts")] = flutter::EncodableValue(result.attempts);
+  out[flutter::EncodableValue("elapsedMs")] = flutter::EncodableValue(result.elapsed_ms);
+  return out;
+}
+
+/// Printed by the test-print step unless the caller passes its own page.
+std::vector<uint8_t> DefaultTestPage() {
+  const std::string text = "Printer ready\n";
+  std::vector<uint8_t> page = {0x1B, 0x40};
+  page.insert(page.end(), text.begin(), text.end());
+  page.insert(page.end(), {0x1B, 0x64, 0x03});
+  return page;
+}
+
+/// One provisioning step. Pairing is a Bluetooth concept; LAN printers pass it.
+void RunProvisionStep(const std::string& id,
+                      ProvisionStep step,
+                      const std::shared_ptr<const std::vector<uint8_t>>& test_page,
+                      std::function<void(bool)> done) {
+  const bool tcp = IsTcpPrinterId(id);
+  switch (step) {
+    case ProvisionStep::kPair:
+      if (tcp) {
+        done(true);
+        return;
+      }
+      InvalidateQueries(id);
+      BluetoothPairDeviceAsyncSta(id, [id, done](bool paired) {
+        InvalidateQueries(id);
+        done(paired);
+      });
+      return;
+    case ProvisionStep::kConnect: {
+      auto connected = [id, done](bool ok) {
+        InvalidateQueries(id);
+        done(ok);
+      };
+      if (tcp) {
+        TcpConnectAsync(id, connected);
+      } else {
+        BluetoothConnectConcurrentAsync(id, connected);
+      }
+      return;
+    }
+    case ProvisionStep::kProbe:
+      ProbeCapabilitiesShared(id, [done](const ProbeAnswer& answer) { done(answer.ok); });
+      return;
+    case ProvisionStep::kTestPrint:
+      PrinterSendAsync(id, test_page->data(), test_page->size(), done);
+      return;
+  }
+  done(false);
+}
+
 }  // namespace
 
+#ifdef _WIN32
 void FlutterThermalPrinterWindowsPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows* registrar) {
   auto channel =
@@ -86,8 +493,28 @@ void FlutterThermalPrinterWindowsPlugin::RegisterWithRegistrar(
         plugin_pointer->HandleMethodCall(call, std::move(result));
       });
 
+  // Provisioning progress; events carry the runId of their call.
+  plugin->provisioning_channel_ = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(), "flutter_thermal_printer_windows/provisioning",
+      &flutter::StandardMethodCodec::GetInstance());
+  plugin->provisioning_channel_->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [](const flutter::EncodableValue*,
+             std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            std::shared_ptr<flutter::EventSink<flutter::EncodableValue>> sink = std::move(events);
+            SetProvisioningEventSink([sink](const flutter::EncodableValue& event) { sink->Success(event); });
+            return nullptr;
+          },
+          [](const flutter::EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
+            SetProvisioningEventSink(nullptr);
+            return nullptr;
+          }));
+
   registrar->AddPlugin(std::move(plugin));
 }
+#endif
 
 FlutterThermalPrinterWindowsPlugin::FlutterThermalPrinterWindowsPlugin() {
   BluetoothWinRtInit();
@@ -98,9 +525,12 @@ FlutterThermalPrinterWindowsPlugin::~FlutterThermalPrinterWindowsPlugin() {}
 void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Covers argument decoding and dispatch; replies are "EncodeResult" spans.
+  ScopedSpan span("HandleMethodCall", SpansActive() ? SpanInternName(method_call.method_name()) : nullptr);
   if (method_call.method_name().compare("getPlatformVersion") == 0) {
     std::ostringstream version_stream;
     version_stream << "Windows ";
+#ifdef _WIN32
     if (IsWindows10OrGreater()) {
       version_stream << "10+";
     } else if (IsWindows8OrGreater()) {
@@ -108,13 +538,17 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
     } else if (IsWindows7OrGreater()) {
       version_stream << "7";
     }
+#else
+    version_stream << "(host build)";
+#endif
     result->Success(flutter::EncodableValue(version_stream.str()));
   } else if (method_call.method_name().compare("scanForPrinters") == 0) {
     auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
         std::move(result));
-    BluetoothFindAllSppDevicesAsync([result_holder](std::vector<SppDeviceInfo> devices) {
+    FindSppDevicesShared([result_holder](const std::vector<SppDeviceInfo>& devices) {
       auto& res = *result_holder;
       if (!res) return;
+      ScopedSpan span("EncodeResult", "scanForPrinters");
       try {
         flutter::EncodableList list;
         for (size_t i = 0; i < devices.size(); i++) {
@@ -151,8 +585,10 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
     flutter::EncodableValue printer_copy(*args);
     auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
         std::move(result));
+    InvalidateQueries(id);
     // Use STA async (non-blocking Completed) so pairing UI can appear.
-    BluetoothPairDeviceAsyncSta(id, [result_holder, printer_copy](bool paired) {
+    BluetoothPairDeviceAsyncSta(id, [result_holder, printer_copy, id](bool paired) {
+      InvalidateQueries(id);
       auto& res = *result_holder;
       if (!res) return;
       try {
@@ -175,7 +611,9 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
     }
     auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
         std::move(result));
-    BluetoothUnpairDeviceAsync(id, [result_holder](bool ok) {
+    InvalidateQueries(id);
+    BluetoothUnpairDeviceAsync(id, [result_holder, id](bool ok) {
+      InvalidateQueries(id);
       auto& res = *result_holder;
       if (!res) return;
       if (ok) {
@@ -193,9 +631,16 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
     }
     auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
         std::move(result));
-    BluetoothConnectAsync(id, [result_holder](bool connected) {
+    InvalidateQueries(id);
+    auto done = [result_holder, id](bool connected) {
+      InvalidateQueries(id);
+      // First connection: learn what the printer supports before the first job.
+      if (connected && !FindCapabilities(id).capabilities_probed) {
+        ProbeCapabilitiesShared(id, [](const ProbeAnswer&) {});
+      }
       auto& res = *result_holder;
       if (!res) return;
+      ScopedSpan span("EncodeResult", "connectToDevice");
       try {
         flutter::EncodableMap out;
         out[flutter::EncodableValue("isConnected")] = flutter::EncodableValue(connected);
@@ -205,7 +650,12 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
       } catch (...) {
         res->Error("ConnectFailed", "Unknown error");
       }
-    });
+    };
+    if (IsTcpPrinterId(id)) {
+      TcpConnectAsync(id, done);
+    } else {
+      BluetoothConnectAsync(id, done);
+    }
   } else if (method_call.method_name().compare("disconnectFromDevice") == 0) {
     const flutter::EncodableValue* args_value = method_call.arguments();
     std::string id = GetPrinterIdFromArgs(args_value);
@@ -213,7 +663,12 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
       result->Error("InvalidArguments", "Expected printer with id");
       return;
     }
-    BluetoothDisconnect(id);
+    if (IsTcpPrinterId(id)) {
+      TcpDisconnect(id);
+    } else {
+      BluetoothDisconnect(id);
+    }
+    InvalidateQueries(id);
     result->Success();
   } else if (method_call.method_name().compare("getConnectionState") == 0) {
     const flutter::EncodableValue* args_value = method_call.arguments();
@@ -227,7 +682,9 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
         if (s) id = *s;
       }
     }
-    int state = BluetoothIsConnected(id) ? kConnectionStateConnected : kConnectionStateDisconnected;
+    bool connected = IsTcpPrinterId(id) ? TcpIsConnected(id) : BluetoothIsConnected(id);
+    int state = connected ? kConnectionStateConnected : kConnectionStateDisconnected;
+    ScopedSpan reply_span("EncodeResult", "getConnectionState");
     result->Success(flutter::EncodableValue(state));
   } else if (method_call.method_name().compare("sendRawCommands") == 0) {
     const flutter::EncodableValue* args_value = method_call.arguments();
@@ -244,35 +701,216 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
       return;
     }
     const auto* printer_map = std::get_if<flutter::EncodableMap>(&printer_it->second);
+    // Uint8List arrives as std::vector<uint8_t> and is sent without conversion;
+    // List<int> (older Dart side) is still accepted.
+    const auto* bytes_u8 = std::get_if<std::vector<uint8_t>>(&bytes_it->second);
     const auto* bytes_list = std::get_if<flutter::EncodableList>(&bytes_it->second);
-    if (!printer_map || !bytes_list) {
+    if (!printer_map || (!bytes_u8 && !bytes_list)) {
       result->Error("InvalidArguments", "Invalid printer or bytes");
       return;
     }
     flutter::EncodableValue printer_encodable(*printer_map);
     std::string id = GetPrinterIdFromArgs(&printer_encodable);
+    std::vector<uint8_t> converted;
+    if (!bytes_u8) {
+      converted.reserve(bytes_list->size());
+      for (const auto& v : *bytes_list) {
+        const auto* i = std::get_if<int32_t>(&v);
+        if (i) converted.push_back(static_cast<uint8_t>(*i & 0xFF));
+      }
+    }
+    const std::vector<uint8_t>& input = bytes_u8 ? *bytes_u8 : converted;
+    EscPosOptimizeStats stats;
     std::vector<uint8_t> bytes;
-    for (const auto& v : *bytes_list) {
-      const auto* i = std::get_if<int32_t>(&v);
-      if (i) bytes.push_back(static_cast<uint8_t>(*i & 0xFF));
+    {
+      ScopedSpan optimize_span("OptimizeEscPos");
+      bytes = OptimizeEscPos(input.data(), input.size(), &stats);
     }
+    const int64_t saved = static_cast<int64_t>(stats.input_bytes - stats.output_bytes);
+    MetricsAdd("escpos.jobs", 1);
+    MetricsAdd("escpos.bytes_in", static_cast<int64_t>(stats.input_bytes));
+    MetricsAdd("escpos.bytes_out", static_cast<int64_t>(stats.output_bytes));
+    MetricsAdd("escpos.bytes_saved", saved);
+    MetricsSet("escpos.last_job_bytes_saved", saved);
     auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
         std::move(result));
-    BluetoothSendAsync(id, bytes.data(), bytes.size(), [result_holder](bool ok) {
+    uint64_t trace_job = TraceJobBegin(id, bytes.size());
+    auto done = [result_holder, id, trace_job](bool ok) {
+      TraceJobEnd(id, trace_job, ok);
       auto& res = *result_holder;
       if (!res) return;
+      ScopedSpan span("EncodeResult", "sendRawCommands");
       if (ok) {
         res->Success();
       } else {
         res->Error("SendFailed", "Failed to send data to printer");
       }
+    };
+    if (IsTcpPrinterId(id)) {
+      // The job buffer moves to the connection's queue and is written from there.
+      TcpSendAsync(id, std::move(bytes), done);
+    } else {
+      BluetoothSendAsync(id, bytes.data(), bytes.size(), done);
+    }
+  } else if (method_call.method_name().compare("printImage") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    if (!args) {
+      result->Error("InvalidArguments", "Expected printer and pixels");
+      return;
+    }
+    auto printer_it = args->find(flutter::EncodableValue("printer"));
+    auto pixels_it = args->find(flutter::EncodableValue("pixels"));
+    if (printer_it == args->end() || pixels_it == args->end()) {
+      result->Error("InvalidArguments", "Expected printer and pixels");
+      return;
+    }
+    const auto* pixels = std::get_if<std::vector<uint8_t>>(&pixels_it->second);
+    std::string id = GetPrinterIdFromArgs(&printer_it->second);
+    RasterImageSource source;
+    source.width = GetIntArg(*args, "width", 0);
+    source.height = GetIntArg(*args, "height", 0);
+    int format = GetIntArg(*args, "format", 0);
+    source.format = static_cast<SourcePixelFormat>(format);
+    source.target_width = GetIntArg(*args, "targetWidth", 0);
+    int filter = GetIntArg(*args, "filter", 0);
+    source.filter = static_cast<ResampleFilter>(filter);
+    source.dither = GetBoolArg(*args, "dither", true);
+    source.threshold = GetIntArg(*args, "threshold", 128);
+    int band_height = GetIntArg(*args, "bandHeight", 0);
+    size_t bpp = source.format == SourcePixelFormat::kRgba8888 ? 4 : 1;
+    if (id.empty() || !pixels || source.width <= 0 || source.height <= 0 || format < 0 ||
+        format > static_cast<int>(SourcePixelFormat::kRgba8888) || filter < 0 ||
+        filter > static_cast<int>(ResampleFilter::kArea) ||
+        pixels->size() < static_cast<size_t>(source.width) * source.height * bpp) {
+      result->Error("InvalidArguments", "Invalid printer, pixels or image size");
+      return;
+    }
+    // Arguments are owned by the channel, so the source is copied once; every
+    // later stage works on one band at a time.
+    auto pixels_copy = std::make_shared<std::vector<uint8_t>>(*pixels);
+    source.pixels = pixels_copy->data();
+    // Images fill the head unless a narrower width is asked for; unprobed
+    // printers use the head width of their paper. Probed ones also choose the
+    // raster command and band size.
+    const RegisteredPrinter caps = FindCapabilities(id);
+    source.target_width = ImageTargetWidth(caps, source.target_width);
+    source.command = caps.supports_raster ? RasterCommand::kGsV0 : RasterCommand::kEscStar24;
+    int out_width = 0;
+    RasterOutputSize(source, &out_width, nullptr);
+    source.band_height = band_height > 0 ? band_height : BandHeightFor(caps, out_width);
+    auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
+        std::move(result));
+    uint64_t trace_job = TraceJobBegin(id, pixels_copy->size());
+    // Behind earlier image and barcode jobs for this printer, so bands do not
+    // interleave.
+    GetPrinterJobQueue().Post(id, [id, source, pixels_copy, result_holder, trace_job]() {
+      bool ok = false;
+      try {
+        ok = StreamImageToPrinter(id, source);
+      } catch (const std::exception& e) {
+        PLUGIN_LOG("printImage ERROR: " << e.what());
+      } catch (...) {
+        PLUGIN_LOG("printImage ERROR: unknown");
+      }
+      TraceJobEnd(id, trace_job, ok);
+      auto& res = *result_holder;
+      if (!res) return;
+      ScopedSpan span("EncodeResult", "printImage");
+      if (ok) {
+        res->Success();
+      } else {
+        res->Error("SendFailed", "Failed to send image to printer");
+      }
+    });
+  } else if (method_call.method_name().compare("printBarcode") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    if (!args) {
+      result->Error("InvalidArguments", "Expected printer and data");
+      return;
+    }
+    auto printer_it = args->find(flutter::EncodableValue("printer"));
+    auto data_it = args->find(flutter::EncodableValue("data"));
+    const auto* data = data_it != args->end() ? std::get_if<std::string>(&data_it->second) : nullptr;
+    std::string id = printer_it != args->end() ? GetPrinterIdFromArgs(&printer_it->second) : std::string();
+    int symbology = GetIntArg(*args, "symbology", 0);
+    int level = GetIntArg(*args, "errorCorrection", static_cast<int>(QrErrorCorrection::kMedium));
+    int rendering = GetIntArg(*args, "rendering", 0);
+    if (id.empty() || !data || data->empty() || symbology < 0 || symbology > static_cast<int>(Symbology::kQrCode) ||
+        level < 0 || level > static_cast<int>(QrErrorCorrection::kHigh) || rendering < 0 ||
+        rendering > static_cast<int>(BarcodeRendering::kRaster)) {
+      result->Error("InvalidArguments", "Invalid printer, data, symbology or rendering");
+      return;
+    }
+    BarcodeSpec spec;
+    spec.symbology = static_cast<Symbology>(symbology);
+    spec.data = *data;
+    spec.error_correction = static_cast<QrErrorCorrection>(level);
+    spec.module_dots = std::max(GetIntArg(*args, "moduleSize", 0), 0);
+    spec.height_dots = std::max(GetIntArg(*args, "height", 0), 0);
+    // Known printers draw barcodes themselves; the rest get a raster sized
+    // to their head.
+    const RegisteredPrinter caps = FindCapabilities(id);
+    spec.max_width_dots = PrintableWidthDots(caps);
+    const BarcodeRendering chosen =
+        ChooseBarcodeRendering(spec, caps, static_cast<BarcodeRendering>(rendering));
+    auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
+        std::move(result));
+    if (chosen == BarcodeRendering::kPrinterCommands) {
+      std::vector<uint8_t> bytes;
+      if (!EncodeBarcodeCommands(spec, &bytes)) {
+        (*result_holder)->Error("InvalidArguments", "Data cannot be printed as this barcode");
+        return;
+      }
+      MetricsAdd("barcode.commands", 1);
+      uint64_t trace_job = TraceJobBegin(id, bytes.size());
+      PrinterSendAsync(id, bytes.data(), bytes.size(), [id, result_holder, trace_job](bool ok) {
+        TraceJobEnd(id, trace_job, ok);
+        auto& res = *result_holder;
+        if (!res) return;
+        ScopedSpan span("EncodeResult", "printBarcode");
+        if (ok) {
+          res->Success();
+        } else {
+          res->Error("SendFailed", "Failed to send barcode to printer");
+        }
+      });
+      return;
+    }
+    MetricsAdd("barcode.raster", 1);
+    GetPrinterJobQueue().Post(id, [id, spec, caps, result_holder]() {
+      bool rendered = true;
+      bool ok = false;
+      uint64_t trace_job = TraceJobBegin(id, spec.data.size());
+      try {
+        ok = PrintBarcodeRaster(id, spec, caps, &rendered);
+      } catch (const std::exception& e) {
+        PLUGIN_LOG("printBarcode ERROR: " << e.what());
+      } catch (...) {
+        PLUGIN_LOG("printBarcode ERROR: unknown");
+      }
+      TraceJobEnd(id, trace_job, ok);
+      auto& res = *result_holder;
+      if (!res) return;
+      ScopedSpan span("EncodeResult", "printBarcode");
+      if (ok) {
+        res->Success();
+      } else if (!rendered) {
+        res->Error("InvalidArguments", "Data does not encode as this barcode within the printer's width");
+      } else {
+        res->Error("SendFailed", "Failed to send barcode to printer");
+      }
     });
   } else if (method_call.method_name().compare("getPairedPrinters") == 0) {
     auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
         std::move(result));
-    BluetoothFindAllSppDevicesAsync([result_holder](std::vector<SppDeviceInfo> devices) {
+    FindSppDevicesShared([result_holder](const std::vector<SppDeviceInfo>& devices) {
       auto& res = *result_holder;
       if (!res) return;
+      ScopedSpan span("EncodeResult", "getPairedPrinters");
       flutter::EncodableList list;
       for (const auto& d : devices) {
         if (d.is_paired) {
@@ -282,15 +920,130 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
       res->Success(flutter::EncodableValue(list));
     });
   } else if (method_call.method_name().compare("getPrinterCapabilities") == 0) {
-    flutter::EncodableMap out;
-    out[flutter::EncodableValue("maxPaperWidth")] = flutter::EncodableValue(58);
-    out[flutter::EncodableValue("supportsCutting")] = flutter::EncodableValue(true);
-    out[flutter::EncodableValue("supportsImages")] = flutter::EncodableValue(true);
-    out[flutter::EncodableValue("supportsPartialCut")] = flutter::EncodableValue(false);
-    result->Success(flutter::EncodableValue(out));
+    // Registered printers report their persisted capabilities; others get the defaults.
+    RegisteredPrinter caps = FindCapabilities(GetPrinterIdFromArgs(method_call.arguments()));
+    result->Success(flutter::EncodableValue(CapabilitiesToEncodableMap(caps)));
+  } else if (method_call.method_name().compare("probePrinterCapabilities") == 0) {
+    std::string id = GetPrinterIdFromArgs(method_call.arguments());
+    if (id.empty()) {
+      result->Error("InvalidArguments", "Expected printer with id");
+      return;
+    }
+    auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
+        std::move(result));
+    ProbeCapabilitiesShared(id, [result_holder](const ProbeAnswer& answer) {
+      auto& res = *result_holder;
+      if (!res) return;
+      if (answer.ok) {
+        res->Success(flutter::EncodableValue(CapabilitiesToEncodableMap(answer.printer)));
+      } else {
+        res->Error("ProbeFailed", "Printer is not connected");
+      }
+    });
+  } else if (method_call.method_name().compare("provisionPrinters") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    const flutter::EncodableList* ids_value = nullptr;
+    std::string run_id;
+    if (args) {
+      auto ids_it = args->find(flutter::EncodableValue("ids"));
+      if (ids_it != args->end()) ids_value = std::get_if<flutter::EncodableList>(&ids_it->second);
+      auto run_it = args->find(flutter::EncodableValue("runId"));
+      if (run_it != args->end()) {
+        if (const auto* s = std::get_if<std::string>(&run_it->second)) run_id = *s;
+      }
+    }
+    if (!ids_value) {
+      result->Error("InvalidArguments", "Expected ids list");
+      return;
+    }
+    std::vector<std::string> ids;
+    for (const auto& value : *ids_value) {
+      const auto* id = std::get_if<std::string>(&value);
+      if (!id || id->empty() || std::find(ids.begin(), ids.end(), *id) != ids.end()) {
+        result->Error("InvalidArguments", "Expected distinct, non-empty printer ids");
+        return;
+      }
+      ids.push_back(*id);
+    }
+    ProvisionOptions options;
+    options.max_concurrent = GetIntArg(*args, "maxConcurrent", options.max_concurrent);
+    options.max_attempts = GetIntArg(*args, "maxAttempts", options.max_attempts);
+    options.initial_backoff_ms = GetIntArg(*args, "initialBackoffMs", static_cast<int>(options.initial_backoff_ms));
+    options.max_backoff_ms = GetIntArg(*args, "maxBackoffMs", static_cast<int>(options.max_backoff_ms));
+    options.step_timeout_ms = GetIntArg(*args, "stepTimeoutMs", static_cast<int>(options.step_timeout_ms));
+    options.pair = GetBoolArg(*args, "pair", options.pair);
+    options.probe = GetBoolArg(*args, "probe", options.probe);
+    options.test_print = GetBoolArg(*args, "testPrint", options.test_print);
+    if (options.max_concurrent < 1 || options.max_attempts < 1 || options.initial_backoff_ms < 0 ||
+        options.max_backoff_ms < 0 || options.step_timeout_ms < 0) {
+      result->Error("InvalidArguments", "Expected maxConcurrent, maxAttempts >= 1 and non-negative delays");
+      return;
+    }
+    auto test_page = std::make_shared<const std::vector<uint8_t>>(DefaultTestPage());
+    auto page_it = args->find(flutter::EncodableValue("testPage"));
+    if (page_it != args->end()) {
+      const auto* page = std::get_if<std::vector<uint8_t>>(&page_it->second);
+      if (!page || page->empty()) {
+        result->Error("InvalidArguments", "Expected testPage bytes");
+        return;
+      }
+      test_page = std::make_shared<const std::vector<uint8_t>>(*page);
+    }
+    auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
+        std::move(result));
+    int64_t start_ms = MetricsNowMs();
+    MetricsAdd("provision.runs", 1);
+    Provisioner::Start(
+        std::move(ids), options,
+        [test_page](const std::string& id, ProvisionStep step, std::function<void(bool)> done) {
+          RunProvisionStep(id, step, test_page, std::move(done));
+        },
+        [run_id](const ProvisionEvent& event) {
+          if (event.kind == ProvisionEventKind::kStepRetrying) MetricsAdd("provision.retries", 1);
+          EmitProvisioningEvent(flutter::EncodableValue(ProvisionEventToEncodableMap(run_id, event)));
+        },
+        [result_holder, start_ms](const std::vector<ProvisionResult>& results) {
+          ScopedSpan span("EncodeResult", "provisionPrinters");
+          flutter::EncodableList list;
+          for (const auto& device : results) {
+            MetricsAdd(device.ok ? "provision.devices_ok" : "provision.devices_failed", 1);
+            list.push_back(flutter::EncodableValue(ProvisionResultToEncodableMap(device)));
+          }
+          MetricsSet("provision.last_run_ms", MetricsNowMs() - start_ms);
+          auto& res = *result_holder;
+          if (!res) return;
+          res->Success(flutter::EncodableValue(list));
+        });
   } else if (method_call.method_name().compare("getPrinterStatus") == 0) {
     const flutter::EncodableValue* args_value = method_call.arguments();
     std::string id = GetPrinterIdFromArgs(args_value);
+    if (IsTcpPrinterId(id)) {
+      // LAN printers answer DLE EOT, so report what the printer says.
+      auto result_holder = std::make_shared<std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>>(
+          std::move(result));
+      auto reply = [result_holder, id](const StatusAnswer& answer) {
+        auto& res = *result_holder;
+        if (!res) return;
+        ScopedSpan span("EncodeResult", "getPrinterStatus");
+        const PrinterStatusReport& report = answer.report;
+        flutter::EncodableMap out;
+        out[flutter::EncodableValue("isConnected")] =
+            flutter::EncodableValue(answer.answered || TcpIsConnected(id));
+        out[flutter::EncodableValue("isPaperOut")] = flutter::EncodableValue(report.paper_out);
+        out[flutter::EncodableValue("isCoverOpen")] = flutter::EncodableValue(report.cover_open);
+        out[flutter::EncodableValue("isError")] = flutter::EncodableValue(report.error || report.offline);
+        res->Success(flutter::EncodableValue(out));
+      };
+      FlightJoin join = StatusQueries().Do(id, reply, [id](auto done) {
+        TcpQueryStatusAsync(id, [done](bool answered, const PrinterStatusReport& report) {
+          done(StatusAnswer{answered, report});
+        });
+      });
+      RecordFlight("status", join);
+      return;
+    }
     bool connected = BluetoothIsConnected(id);
     flutter::EncodableMap out;
     out[flutter::EncodableValue("isConnected")] = flutter::EncodableValue(connected);
@@ -298,6 +1051,62 @@ void FlutterThermalPrinterWindowsPlugin::HandleMethodCall(
     out[flutter::EncodableValue("isCoverOpen")] = flutter::EncodableValue(false);
     out[flutter::EncodableValue("isError")] = flutter::EncodableValue(false);
     result->Success(flutter::EncodableValue(out));
+  } else if (method_call.method_name().compare("startTraceCapture") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    const std::string* path = nullptr;
+    if (args) {
+      auto it = args->find(flutter::EncodableValue("path"));
+      if (it != args->end()) path = std::get_if<std::string>(&it->second);
+    }
+    if (!path || path->empty()) {
+      result->Error("InvalidArguments", "Expected trace file path");
+      return;
+    }
+    if (!TraceStart(*path)) {
+      result->Error("TraceFailed", "Could not open trace file");
+      return;
+    }
+    PLUGIN_LOG("trace capture started: " << *path);
+    result->Success();
+  } else if (method_call.method_name().compare("stopTraceCapture") == 0) {
+    uint64_t records = TraceStop();
+    result->Success(flutter::EncodableValue(static_cast<int64_t>(records)));
+  } else if (method_call.method_name().compare("setSpanTracing") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    if (!args || args->find(flutter::EncodableValue("enabled")) == args->end()) {
+      result->Error("InvalidArguments", "Expected enabled");
+      return;
+    }
+    SpansSetActive(GetBoolArg(*args, "enabled", false));
+    result->Success();
+  } else if (method_call.method_name().compare("exportSpanTrace") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    bool clear = args ? GetBoolArg(*args, "clear", true) : true;
+    result->Success(flutter::EncodableValue(SpansExportChromeJson(clear)));
+  } else if (method_call.method_name().compare("setQueryCacheTtl") == 0) {
+    const flutter::EncodableValue* args_value = method_call.arguments();
+    const auto* args =
+        args_value ? std::get_if<flutter::EncodableMap>(args_value) : nullptr;
+    int ttl_ms = args ? GetIntArg(*args, "ttlMs", -1) : -1;
+    if (ttl_ms < 0) {
+      result->Error("InvalidArguments", "Expected ttlMs >= 0");
+      return;
+    }
+    SppScans().SetTtlMs(ttl_ms);
+    StatusQueries().SetTtlMs(ttl_ms);
+    result->Success();
+  } else if (method_call.method_name().compare("getNativeMetrics") == 0) {
+    flutter::EncodableMap out;
+    for (const auto& entry : MetricsSnapshot()) {
+      out[flutter::EncodableValue(entry.first)] = flutter::EncodableValue(entry.second);
+    }
+    result->Success(flutter::EncodableValue(out));
   } else {
     result->NotImplemented();
   }
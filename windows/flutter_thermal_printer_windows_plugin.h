@@ -2,7 +2,13 @@
 #define FLUTTER_PLUGIN_FLUTTER_THERMAL_PRINTER_WINDOWS_PLUGIN_H_
 
 #include <flutter/method_channel.h>
+#ifdef _WIN32
+#include <flutter/event_channel.h>
 #include <flutter/plugin_registrar_windows.h>
+#else
+// Host builds (windows/tools/load_harness) drive HandleMethodCall directly.
+#include <flutter/plugin_registrar.h>
+#endif
 
 #include <memory>
 
@@ -10,7 +16,9 @@ namespace flutter_thermal_printer_windows {
 
 class FlutterThermalPrinterWindowsPlugin : public flutter::Plugin {
  public:
+#ifdef _WIN32
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
+#endif
 
   FlutterThermalPrinterWindowsPlugin();
 
@@ -24,6 +32,11 @@ class FlutterThermalPrinterWindowsPlugin : public flutter::Plugin {
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+#ifdef _WIN32
+ private:
+  std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>> provisioning_channel_;
+#endif
 };
 
 }  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,261 @@
+#include "image_resample.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FTPW_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr int kWeightBits = 14;
+constexpr int kWeightOne = 1 << kWeightBits;
+constexpr int kWeightRound = 1 << (kWeightBits - 1);
+
+inline uint8_t Clamp255(int v) {
+  return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/// BT.601 luma in 8.8 fixed point, composited onto white by alpha.
+/// (t + (t >> 8) + 1) >> 8 is t / 255 rounded down for every t that occurs.
+inline uint8_t LumaScalar(const uint8_t* p) {
+  int luma = (p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8;
+  int alpha = p[3];
+  int t = luma * alpha + 255 * (255 - alpha) + 127;
+  return static_cast<uint8_t>((t + (t >> 8) + 1) >> 8);
+}
+
+void VerticalScalar(const uint8_t* const* rows, const int16_t* weights, int taps, size_t width,
+                    uint8_t* out, size_t x) {
+  for (; x < width; x++) {
+    int acc = kWeightRound;
+    for (int k = 0; k < taps; k++) acc += weights[k] * rows[k][x];
+    out[x] = Clamp255(acc >> kWeightBits);
+  }
+}
+
+#ifdef FTPW_HAVE_SSE2
+
+size_t RgbaToLumaSse2(const uint8_t* rgba, size_t count, uint8_t* luma) {
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  const __m128i c77 = _mm_set1_epi16(77);
+  const __m128i c150 = _mm_set1_epi16(150);
+  const __m128i c29 = _mm_set1_epi16(29);
+  const __m128i c255 = _mm_set1_epi16(255);
+  const __m128i c127 = _mm_set1_epi16(127);
+  const __m128i c1 = _mm_set1_epi16(1);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4));
+    __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + i * 4 + 16));
+    // Deinterleave into 16-bit lanes, one channel per register.
+    __m128i r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+    __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+                                _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+    __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+                                _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+    __m128i a = _mm_packs_epi32(_mm_srli_epi32(p0, 24), _mm_srli_epi32(p1, 24));
+    // Sums stay below 2^16, so wrapping 16-bit adds and logical shifts are exact.
+    __m128i y = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, c77), _mm_mullo_epi16(g, c150)),
+                              _mm_mullo_epi16(b, c29));
+    y = _mm_srli_epi16(y, 8);
+    __m128i t = _mm_add_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(y, a), _mm_mullo_epi16(c255, _mm_sub_epi16(c255, a))), c127);
+    __m128i q = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), c1), 8);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(luma + i), _mm_packus_epi16(q, q));
+  }
+  return i;
+}
+
+/// Blends [taps] rows two at a time with pmaddwd: interleaved 16-bit pixels
+/// of rows a and b times (wa, wb) give a*wa + b*wb in each 32-bit lane.
+size_t VerticalSse2(const uint8_t* const* rows, const int16_t* weights, int taps, size_t width,
+                    uint8_t* out) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(kWeightRound);
+  size_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m128i acc_lo = round;
+    __m128i acc_hi = round;
+    for (int k = 0; k < taps; k += 2) {
+      __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k] + x)), zero);
+      __m128i b = zero;
+      uint32_t wb = 0;
+      if (k + 1 < taps) {
+        b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows[k + 1] + x)), zero);
+        wb = static_cast<uint16_t>(weights[k + 1]);
+      }
+      __m128i w = _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[k]) | (wb << 16)));
+      acc_lo = _mm_add_epi32(acc_lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w));
+      acc_hi = _mm_add_epi32(acc_hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w));
+    }
+    __m128i v = _mm_packs_epi32(_mm_srai_epi32(acc_lo, kWeightBits), _mm_srai_epi32(acc_hi, kWeightBits));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(v, v));
+  }
+  return x;
+}
+
+#endif  // FTPW_HAVE_SSE2
+
+void VerticalPass(const uint8_t* const* rows, const int16_t* weights, int taps, size_t width,
+                  uint8_t* out, bool simd) {
+  size_t done = 0;
+#ifdef FTPW_HAVE_SSE2
+  if (simd) done = VerticalSse2(rows, weights, taps, width, out);
+#else
+  (void)simd;
+#endif
+  VerticalScalar(rows, weights, taps, width, out, done);
+}
+
+ResampleFilter ResolveFilter(ResampleFilter filter, int in_size, int out_size) {
+  if (filter != ResampleFilter::kAuto) return filter;
+  return out_size < in_size ? ResampleFilter::kArea : ResampleFilter::kBilinear;
+}
+
+}  // namespace
+
+void RgbaToLuma(const uint8_t* rgba, size_t count, uint8_t* luma, bool simd) {
+  size_t i = 0;
+#ifdef FTPW_HAVE_SSE2
+  if (simd) i = RgbaToLumaSse2(rgba, count, luma);
+#else
+  (void)simd;
+#endif
+  for (; i < count; i++) luma[i] = LumaScalar(rgba + i * 4);
+}
+
+LumaResampler::LumaResampler(const RasterImageSource& source, int out_width, int out_height, bool simd)
+    : pixels_(source.pixels),
+      width_(source.width),
+      height_(source.height),
+      stride_(source.stride ? source.stride
+                            : static_cast<size_t>(source.width) *
+                                  (source.format == SourcePixelFormat::kRgba8888 ? 4 : 1)),
+      format_(source.format),
+      out_width_(out_width),
+      simd_(simd) {
+  BuildTaps(width_, out_width, ResolveFilter(source.filter, width_, out_width), &x_taps_);
+  BuildTaps(height_, out_height, ResolveFilter(source.filter, height_, out_height), &y_taps_);
+  int max_taps = 1;
+  for (uint16_t n : y_taps_.count) max_taps = std::max<int>(max_taps, n);
+  row_ptrs_.resize(max_taps);
+  column_.resize(width_);
+  if (format_ == SourcePixelFormat::kRgba8888) {
+    cache_slots_ = max_taps + 1;
+    cache_.resize(static_cast<size_t>(cache_slots_) * width_);
+    cached_row_.assign(cache_slots_, -1);
+  }
+}
+
+void LumaResampler::BuildTaps(int in_size, int out_size, ResampleFilter filter, Taps* taps) {
+  taps->start.resize(out_size);
+  taps->count.resize(out_size);
+  taps->offset.resize(out_size);
+  taps->weights.clear();
+  std::vector<int64_t> raw;
+  const int64_t in = in_size;
+  const int64_t out = out_size;
+  for (int64_t i = 0; i < out; i++) {
+    int64_t first = 0;
+    raw.clear();
+    switch (filter) {
+      case ResampleFilter::kNearest:
+        first = ((2 * i + 1) * in) / (2 * out);
+        raw.push_back(1);
+        break;
+      case ResampleFilter::kBilinear: {
+        // Pixel centres: source position (i + 0.5) * in / out - 0.5, times 2 * out.
+        const int64_t num = (2 * i + 1) * in - out;
+        const int64_t den = 2 * out;
+        first = num > 0 ? num / den : 0;
+        if (num <= 0 || first >= in - 1) {
+          first = std::min(first, in - 1);
+          raw.push_back(1);
+        } else {
+          const int64_t frac = num % den;
+          raw.push_back(den - frac);
+          raw.push_back(frac);
+        }
+        break;
+      }
+      case ResampleFilter::kArea:
+      case ResampleFilter::kAuto: {
+        // In units of 1 / (in * out): output i spans [i*in, (i+1)*in), source j spans [j*out, (j+1)*out).
+        const int64_t lo = i * in;
+        const int64_t hi = lo + in;
+        first = lo / out;
+        const int64_t last = (hi - 1) / out;
+        for (int64_t j = first; j <= last; j++) {
+          raw.push_back(std::min((j + 1) * out, hi) - std::max(j * out, lo));
+        }
+        break;
+      }
+    }
+    // Normalise to kWeightOne; rounding error goes to the largest tap.
+    int64_t total = 0;
+    for (int64_t r : raw) total += r;
+    std::vector<int16_t> w(raw.size());
+    int sum = 0;
+    size_t largest = 0;
+    for (size_t k = 0; k < raw.size(); k++) {
+      w[k] = static_cast<int16_t>((raw[k] * kWeightOne + total / 2) / total);
+      sum += w[k];
+      if (raw[k] > raw[largest]) largest = k;
+    }
+    w[largest] = static_cast<int16_t>(w[largest] + (kWeightOne - sum));
+    size_t begin = 0;
+    size_t end = w.size();
+    while (begin + 1 < end && w[begin] == 0) begin++;
+    while (end - 1 > begin && w[end - 1] == 0) end--;
+    taps->start[i] = static_cast<uint32_t>(first + static_cast<int64_t>(begin));
+    taps->count[i] = static_cast<uint16_t>(end - begin);
+    taps->offset[i] = static_cast<uint32_t>(taps->weights.size());
+    taps->weights.insert(taps->weights.end(), w.begin() + begin, w.begin() + end);
+  }
+}
+
+const uint8_t* LumaResampler::SourceLumaRow(int sy) {
+  const uint8_t* row = pixels_ + static_cast<size_t>(sy) * stride_;
+  // Anything but RGBA is read as gray, matching the 1-byte stride above.
+  if (format_ != SourcePixelFormat::kRgba8888) return row;
+  const int slot = sy % cache_slots_;
+  uint8_t* luma = cache_.data() + static_cast<size_t>(slot) * width_;
+  if (cached_row_[slot] != sy) {
+    RgbaToLuma(row, static_cast<size_t>(width_), luma, simd_);
+    cached_row_[slot] = sy;
+  }
+  return luma;
+}
+
+void LumaResampler::Row(int y, uint8_t* out) {
+  const uint32_t first = y_taps_.start[y];
+  const int taps = y_taps_.count[y];
+  const int16_t* weights = y_taps_.weights.data() + y_taps_.offset[y];
+  for (int k = 0; k < taps; k++) row_ptrs_[k] = SourceLumaRow(static_cast<int>(first) + k);
+  const uint8_t* column = row_ptrs_[0];
+  if (taps > 1) {
+    VerticalPass(row_ptrs_.data(), weights, taps, static_cast<size_t>(width_), column_.data(), simd_);
+    column = column_.data();
+  }
+  const uint32_t* start = x_taps_.start.data();
+  const uint16_t* count = x_taps_.count.data();
+  const uint32_t* offset = x_taps_.offset.data();
+  const int16_t* x_weights = x_taps_.weights.data();
+  for (int x = 0; x < out_width_; x++) {
+    const uint8_t* s = column + start[x];
+    if (count[x] == 1) {
+      out[x] = s[0];
+      continue;
+    }
+    const int16_t* w = x_weights + offset[x];
+    int acc = kWeightRound;
+    for (int k = 0; k < count[x]; k++) acc += w[k] * s[k];
+    out[x] = Clamp255(acc >> kWeightBits);
+  }
+}
+
+}  // namespace flutter_thermal_printer_windows
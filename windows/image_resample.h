@@ -0,0 +1,68 @@
+#ifndef FLUTTER_PLUGIN_IMAGE_RESAMPLE_H_
+#define FLUTTER_PLUGIN_IMAGE_RESAMPLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "raster_pipeline.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Converts [count] RGBA pixels to BT.601 luma with alpha composited onto
+/// white paper. The SIMD and scalar paths give identical results.
+void RgbaToLuma(const uint8_t* rgba, size_t count, uint8_t* luma, bool simd = true);
+
+/// Produces the luma of a source bitmap resampled to out_width x out_height,
+/// one output row at a time.
+///
+/// kAuto picks area averaging on an axis that shrinks and bilinear on one
+/// that grows. The filter is separable and uses 14-bit fixed-point weights: a vertical
+/// pass at source width (SSE2 on x86/x64) blends the source rows covering the
+/// output row, then a horizontal pass reduces it to the output width. RGBA
+/// rows are converted to luma once, as they are first needed, straight into
+/// a small row cache; gray rows are read in place. Memory is bounded by the
+/// source width times the number of rows one output row covers.
+class LumaResampler {
+ public:
+  /// [source] supplies pixels, size, stride, format and filter; the output
+  /// size is given separately. [simd] = false forces the scalar kernels
+  /// (tests, benchmarks).
+  LumaResampler(const RasterImageSource& source, int out_width, int out_height, bool simd = true);
+
+  /// Writes output row [y] to out[0, out_width). Rows must be requested in
+  /// increasing order.
+  void Row(int y, uint8_t* out);
+
+ private:
+  /// Source taps of one output row or column: weights sum to 1 << 14.
+  struct Taps {
+    std::vector<uint32_t> start;
+    std::vector<uint16_t> count;
+    std::vector<uint32_t> offset;
+    std::vector<int16_t> weights;
+  };
+
+  static void BuildTaps(int in_size, int out_size, ResampleFilter filter, Taps* taps);
+  const uint8_t* SourceLumaRow(int sy);
+
+  const uint8_t* pixels_;
+  int width_;
+  int height_;
+  size_t stride_;
+  SourcePixelFormat format_;
+  int out_width_;
+  bool simd_;
+  Taps x_taps_;
+  Taps y_taps_;
+  /// Cached luma rows for RGBA sources; slot = source row % slot count.
+  std::vector<uint8_t> cache_;
+  std::vector<int> cached_row_;
+  int cache_slots_ = 0;
+  std::vector<const uint8_t*> row_ptrs_;
+  std::vector<uint8_t> column_;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_IMAGE_RESAMPLE_H_
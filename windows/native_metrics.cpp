@@ -0,0 +1,44 @@
+#include "native_metrics.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace flutter_thermal_printer_windows {
+
+static const std::chrono::steady_clock::time_point g_metrics_epoch =
+    std::chrono::steady_clock::now();
+static std::mutex g_metrics_mutex;
+static std::map<std::string, int64_t> g_metrics;
+
+int64_t MetricsNowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - g_metrics_epoch)
+      .count();
+}
+
+void MetricsSet(const std::string& name, int64_t value) {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  g_metrics[name] = value;
+}
+
+void MetricsSetOnce(const std::string& name, int64_t value) {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  g_metrics.emplace(name, value);
+}
+
+void MetricsAdd(const std::string& name, int64_t delta) {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  g_metrics[name] += delta;
+}
+
+std::map<std::string, int64_t> MetricsSnapshot() {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  return g_metrics;
+}
+
+void MetricsReset() {
+  std::lock_guard<std::mutex> lock(g_metrics_mutex);
+  g_metrics.clear();
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,30 @@
+#ifndef FLUTTER_PLUGIN_NATIVE_METRICS_H_
+#define FLUTTER_PLUGIN_NATIVE_METRICS_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace flutter_thermal_printer_windows {
+
+/// Milliseconds on the steady clock since the plugin was loaded.
+int64_t MetricsNowMs();
+
+/// Overwrite a named metric.
+void MetricsSet(const std::string& name, int64_t value);
+
+/// Set a named metric only if it has not been set yet (first-event timestamps).
+void MetricsSetOnce(const std::string& name, int64_t value);
+
+/// Add [delta] to a named counter (created at 0).
+void MetricsAdd(const std::string& name, int64_t delta);
+
+/// Copy of all metrics, sorted by name. Returned by the getNativeMetrics method call.
+std::map<std::string, int64_t> MetricsSnapshot();
+
+/// Clear all metrics (tests, benchmarks).
+void MetricsReset();
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_NATIVE_METRICS_H_
@@ -0,0 +1,149 @@
+#include "printer_capabilities.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "printer_status.h"
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+/// Longer extended replies are cut off; real ones are a few dozen bytes.
+constexpr size_t kMaxExtendedReply = 80;
+
+/// GS I 67 model names. All of these take GS v 0 and draw barcodes and QR
+/// codes themselves; the longest matching prefix wins.
+constexpr PrinterModelProfile kKnownModels[] = {
+    {"TM-T20", 80, 576, true, true, true, true, 4096},
+    {"TM-T70", 80, 512, true, true, true, true, 4096},
+    {"TM-T82", 80, 576, true, true, true, true, 4096},
+    {"TM-T88", 80, 512, true, true, true, true, 4096},
+    {"TM-m10", 58, 420, true, true, true, true, 4096},
+    {"TM-m30", 80, 576, true, true, true, true, 4096},
+    {"TM-P20", 58, 384, false, false, true, true, 4096},
+    {"TM-P60", 58, 420, false, false, true, true, 4096},
+};
+
+enum class Reply { kOk, kTimeout, kError };
+
+/// Drops replies left over from an earlier request that timed out.
+void DrainInput(PrinterTransport* transport) {
+  uint8_t stale[64];
+  while (transport->Read(stale, sizeof(stale), 0) > 0) {
+  }
+}
+
+bool SendIdRequest(PrinterTransport* transport, uint8_t n) {
+  DrainInput(transport);
+  const uint8_t request[] = {0x1D, 0x49, n};
+  return transport->Write(request, sizeof(request)) && transport->Flush();
+}
+
+Reply ReadByte(PrinterTransport* transport, int timeout_ms, uint8_t* out) {
+  int n = transport->Read(out, 1, timeout_ms);
+  if (n < 0) return Reply::kError;
+  return n == 1 ? Reply::kOk : Reply::kTimeout;
+}
+
+/// GS I 1..3: one byte.
+Reply QueryId(PrinterTransport* transport, uint8_t n, int timeout_ms, uint8_t* out) {
+  if (!SendIdRequest(transport, n)) return Reply::kError;
+  return ReadByte(transport, timeout_ms, out);
+}
+
+/// GS I 65..69: '_' + text + NUL.
+Reply QueryExtended(PrinterTransport* transport, uint8_t n, int timeout_ms, std::string* out) {
+  if (!SendIdRequest(transport, n)) return Reply::kError;
+  uint8_t c = 0;
+  Reply reply = ReadByte(transport, timeout_ms, &c);
+  if (reply != Reply::kOk) return reply;
+  if (c != 0x5F) return Reply::kTimeout;  // not an extended reply
+  std::string text;
+  for (;;) {
+    reply = ReadByte(transport, timeout_ms, &c);
+    if (reply != Reply::kOk) return reply;
+    if (c == 0x00) break;
+    if (text.size() < kMaxExtendedReply && c >= 0x20 && c < 0x7F) text.push_back(static_cast<char>(c));
+  }
+  *out = text;
+  return Reply::kOk;
+}
+
+}  // namespace
+
+bool ProbePrinterIdentity(PrinterTransport* transport, int timeout_ms, PrinterIdentity* identity) {
+  if (!transport || !identity) return false;
+  PrinterIdentity out;
+  Reply reply = QueryId(transport, 1, timeout_ms, &out.model_id);
+  if (reply == Reply::kError) return false;
+  if (reply == Reply::kOk) {
+    out.answered = true;
+    if (QueryId(transport, 2, timeout_ms, &out.type_id) == Reply::kError ||
+        QueryId(transport, 3, timeout_ms, &out.version_id) == Reply::kError) {
+      return false;
+    }
+    // Printers without the extended requests ignore them, so only the first
+    // one can cost a timeout.
+    reply = QueryExtended(transport, 67, timeout_ms, &out.model_name);
+    if (reply == Reply::kError) return false;
+    if (reply == Reply::kOk &&
+        (QueryExtended(transport, 66, timeout_ms, &out.manufacturer) == Reply::kError ||
+         QueryExtended(transport, 65, timeout_ms, &out.firmware_version) == Reply::kError)) {
+      return false;
+    }
+  }
+  PrinterStatusReport status;
+  out.supports_status = QueryPrinterStatus(transport, timeout_ms, &status);
+  *identity = out;
+  return true;
+}
+
+const PrinterModelProfile* FindPrinterModelProfile(const std::string& model_name) {
+  const PrinterModelProfile* best = nullptr;
+  size_t best_length = 0;
+  for (const auto& profile : kKnownModels) {
+    size_t length = std::strlen(profile.model_prefix);
+    if (length > best_length && model_name.compare(0, length, profile.model_prefix) == 0) {
+      best = &profile;
+      best_length = length;
+    }
+  }
+  return best;
+}
+
+void ApplyPrinterIdentity(const PrinterIdentity& identity, RegisteredPrinter* printer) {
+  if (!printer) return;
+  printer->capabilities_probed = true;
+  printer->supports_status = identity.supports_status;
+  if (!identity.answered) return;
+  printer->model_name = identity.model_name;
+  printer->manufacturer = identity.manufacturer;
+  printer->firmware_version = identity.firmware_version;
+  // Only trust the type id of printers that implement GS I fully; some
+  // clones answer GS I 2 with an arbitrary byte.
+  if (!identity.model_name.empty()) {
+    printer->supports_cutting = (identity.type_id & 0x02) != 0;
+  }
+  const PrinterModelProfile* profile = FindPrinterModelProfile(identity.model_name);
+  if (!profile) return;
+  printer->paper_width_mm = profile->paper_width_mm;
+  printer->dots_per_line = profile->dots_per_line;
+  printer->supports_cutting = profile->supports_cutting;
+  printer->supports_partial_cut = profile->supports_partial_cut;
+  printer->supports_raster = profile->supports_raster;
+  printer->supports_barcode_commands = profile->supports_barcode_commands;
+  printer->write_chunk_size = profile->receive_buffer_bytes;
+}
+
+int PrintableWidthDots(const RegisteredPrinter& printer) {
+  if (printer.dots_per_line > 0) return printer.dots_per_line;
+  return printer.paper_width_mm >= 80 ? 576 : 384;
+}
+
+int ImageTargetWidth(const RegisteredPrinter& printer, int requested_width) {
+  const int head = PrintableWidthDots(printer);
+  return requested_width > 0 ? std::min(requested_width, head) : head;
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,71 @@
+#ifndef FLUTTER_PLUGIN_PRINTER_CAPABILITIES_H_
+#define FLUTTER_PLUGIN_PRINTER_CAPABILITIES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "device_registry.h"
+#include "printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// What a printer reported about itself when probed.
+struct PrinterIdentity {
+  /// Answered GS I 1; the ids below are only meaningful then.
+  bool answered = false;
+  uint8_t model_id = 0;
+  /// GS I 2. Bit 1 set = auto-cutter fitted.
+  uint8_t type_id = 0;
+  uint8_t version_id = 0;
+  /// Extended GS I 67, 66 and 65; empty when not supported.
+  std::string model_name;
+  std::string manufacturer;
+  std::string firmware_version;
+  /// Answered DLE EOT 1, 2 and 4 with valid status bytes.
+  bool supports_status = false;
+};
+
+/// Settings of a printer model we know, keyed by its GS I 67 model name.
+/// ESC/POS has no query for the receive buffer or the supported raster
+/// commands, so those come from here.
+struct PrinterModelProfile {
+  /// Matches model names starting with this (e.g. "TM-T20" for "TM-T20II").
+  const char* model_prefix;
+  int paper_width_mm;
+  int dots_per_line;
+  bool supports_cutting;
+  bool supports_partial_cut;
+  /// GS v 0; otherwise ESC * only.
+  bool supports_raster;
+  /// GS k (all symbologies, long Code128) and GS ( k QR codes.
+  bool supports_barcode_commands;
+  size_t receive_buffer_bytes;
+};
+
+/// Sends GS I 1, 2, 3 (and the extended GS I 67, 66, 65 if the printer
+/// answers the first) plus DLE EOT over [transport], waiting at most
+/// [timeout_ms] for each reply. Stale input is drained first. A printer that
+/// stays silent is not an error: [identity] then has answered == false.
+/// Returns false only if the transport failed.
+bool ProbePrinterIdentity(PrinterTransport* transport, int timeout_ms, PrinterIdentity* identity);
+
+/// Profile for [model_name], or nullptr for unknown models.
+const PrinterModelProfile* FindPrinterModelProfile(const std::string& model_name);
+
+/// Records [identity] in [printer] and marks it probed. Known models take
+/// their profile, including the receive buffer as write chunk size; others
+/// keep the defaults except for the cutter bit of the type id.
+void ApplyPrinterIdentity(const PrinterIdentity& identity, RegisteredPrinter* printer);
+
+/// Dots across the head of [printer]: the probed width, else the usual head
+/// of its paper width (384 dots on 58 mm, 576 on 80 mm).
+int PrintableWidthDots(const RegisteredPrinter& printer);
+
+/// Width to scale an image to on [printer]: [requested_width] dots, or the
+/// printable width when 0, never wider than the head.
+int ImageTargetWidth(const RegisteredPrinter& printer, int requested_width);
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_PRINTER_CAPABILITIES_H_
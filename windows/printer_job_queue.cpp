@@ -0,0 +1,76 @@
+#include "printer_job_queue.h"
+
+#include <thread>
+#include <utility>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+/// Image and barcode jobs mostly wait on the link; a few threads keep several
+/// printers busy without one thread per call.
+constexpr int kPrinterJobThreads = 4;
+
+}  // namespace
+
+PrinterJobQueue::~PrinterJobQueue() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this] { return threads_ == 0; });
+}
+
+void PrinterJobQueue::Post(const std::string& printer_id, std::function<void()> job) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Lane& lane = lanes_[printer_id];
+  lane.jobs.push_back(std::move(job));
+  // A lane with a running job is re-queued by its worker when it finishes.
+  if (lane.running || lane.jobs.size() > 1) return;
+  ready_.push_back(printer_id);
+  if (threads_ < max_threads_) {
+    threads_++;
+    std::thread([this] { WorkerThread(); }).detach();
+  }
+}
+
+size_t PrinterJobQueue::Pending(const std::string& printer_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = lanes_.find(printer_id);
+  return it == lanes_.end() ? 0 : it->second.jobs.size();
+}
+
+void PrinterJobQueue::WorkerThread() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!ready_.empty()) {
+    const std::string id = std::move(ready_.front());
+    ready_.pop_front();
+    Lane& lane = lanes_[id];
+    lane.running = true;
+    std::function<void()> job = std::move(lane.jobs.front());
+    lock.unlock();
+    try {
+      job();
+    } catch (...) {
+    }
+    job = nullptr;
+    lock.lock();
+    // Other printers' lanes may have been added meanwhile; look it up again.
+    Lane& done = lanes_[id];
+    done.jobs.pop_front();
+    done.running = false;
+    if (done.jobs.empty()) {
+      lanes_.erase(id);
+    } else {
+      // Behind other waiting printers, so one long queue cannot starve them.
+      ready_.push_back(id);
+    }
+  }
+  threads_--;
+  idle_.notify_all();
+}
+
+PrinterJobQueue& GetPrinterJobQueue() {
+  // Leaked: detached workers may still be finishing during static destruction.
+  static auto* queue = new PrinterJobQueue(kPrinterJobThreads);
+  return *queue;
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,63 @@
+#ifndef FLUTTER_PLUGIN_PRINTER_JOB_QUEUE_H_
+#define FLUTTER_PLUGIN_PRINTER_JOB_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace flutter_thermal_printer_windows {
+
+/// Runs jobs that stream many bands to a printer (printImage, rasterized
+/// barcodes) off the platform thread. Jobs for one printer run one at a time
+/// in posting order, so their bands never interleave on the wire; at most
+/// [max_threads] jobs run at once across printers. Threads start on demand
+/// and exit when no job is waiting.
+///
+/// Single writes (sendRawCommands) do not go through here; they are ordered
+/// by the MTA worker or TCP connection queue and, from Dart, by PrintEngine.
+class PrinterJobQueue {
+ public:
+  explicit PrinterJobQueue(int max_threads) : max_threads_(max_threads > 0 ? max_threads : 1) {}
+
+  /// Waits for every posted job to finish.
+  ~PrinterJobQueue();
+
+  PrinterJobQueue(const PrinterJobQueue&) = delete;
+  PrinterJobQueue& operator=(const PrinterJobQueue&) = delete;
+
+  /// Queues [job] behind the jobs already posted for [printer_id]. Exceptions
+  /// thrown by [job] are swallowed.
+  void Post(const std::string& printer_id, std::function<void()> job);
+
+  /// Jobs queued or running for [printer_id].
+  size_t Pending(const std::string& printer_id) const;
+
+ private:
+  struct Lane {
+    std::deque<std::function<void()>> jobs;
+    /// The front job is running.
+    bool running = false;
+  };
+
+  void WorkerThread();
+
+  const int max_threads_;
+  mutable std::mutex mutex_;
+  std::condition_variable idle_;
+  /// Printers with jobs; removed when their last job finishes.
+  std::unordered_map<std::string, Lane> lanes_;
+  /// Printers whose next job can start, oldest first.
+  std::deque<std::string> ready_;
+  int threads_ = 0;
+};
+
+/// Process-wide queue used by the plugin.
+PrinterJobQueue& GetPrinterJobQueue();
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_PRINTER_JOB_QUEUE_H_
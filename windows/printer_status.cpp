@@ -0,0 +1,46 @@
+#include "printer_status.h"
+
+#include <cstdint>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+/// Status bytes always have bit 1 and bit 4 set and bits 0 and 7 clear.
+bool IsStatusByte(uint8_t b) {
+  return (b & 0x93) == 0x12;
+}
+
+bool RequestStatus(PrinterTransport* transport, uint8_t n, int timeout_ms, uint8_t* out) {
+  const uint8_t request[] = {0x10, 0x04, n};
+  if (!transport->Write(request, sizeof(request)) || !transport->Flush()) return false;
+  uint8_t reply = 0;
+  if (transport->Read(&reply, 1, timeout_ms) != 1 || !IsStatusByte(reply)) return false;
+  *out = reply;
+  return true;
+}
+
+}  // namespace
+
+bool QueryPrinterStatus(PrinterTransport* transport, int timeout_ms, PrinterStatusReport* report) {
+  if (!transport || !report) return false;
+  uint8_t stale[64];
+  while (transport->Read(stale, sizeof(stale), 0) > 0) {
+  }
+  uint8_t printer = 0;
+  uint8_t offline = 0;
+  uint8_t paper = 0;
+  if (!RequestStatus(transport, 1, timeout_ms, &printer) ||
+      !RequestStatus(transport, 2, timeout_ms, &offline) ||
+      !RequestStatus(transport, 4, timeout_ms, &paper)) {
+    return false;
+  }
+  report->offline = (printer & 0x08) != 0;
+  report->cover_open = (offline & 0x04) != 0;
+  report->error = (offline & 0x40) != 0;
+  report->paper_near_end = (paper & 0x0C) != 0;
+  report->paper_out = (paper & 0x60) != 0 || (offline & 0x20) != 0;
+  return true;
+}
+
+}  // namespace flutter_thermal_printer_windows
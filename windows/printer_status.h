@@ -0,0 +1,26 @@
+#ifndef FLUTTER_PLUGIN_PRINTER_STATUS_H_
+#define FLUTTER_PLUGIN_PRINTER_STATUS_H_
+
+#include "printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Decoded real-time status (DLE EOT 1, 2 and 4).
+struct PrinterStatusReport {
+  bool offline = false;
+  bool cover_open = false;
+  bool paper_near_end = false;
+  bool paper_out = false;
+  /// Auto-cutter, unrecoverable or auto-recoverable error.
+  bool error = false;
+};
+
+/// Sends DLE EOT 1, 2 and 4 over [transport] and decodes the replies. Stale
+/// input is drained first so an earlier unread reply cannot be taken for the
+/// answer. Returns false if the printer did not answer each request with a
+/// valid status byte within [timeout_ms].
+bool QueryPrinterStatus(PrinterTransport* transport, int timeout_ms, PrinterStatusReport* report);
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_PRINTER_STATUS_H_
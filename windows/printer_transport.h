@@ -0,0 +1,67 @@
+#ifndef FLUTTER_PLUGIN_PRINTER_TRANSPORT_H_
+#define FLUTTER_PLUGIN_PRINTER_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_thermal_printer_windows {
+
+/// One segment of a gathered write. The memory stays owned by the caller.
+struct TransportBuffer {
+  const uint8_t* data;
+  size_t size;
+};
+
+/// Byte pipe to one connected printer. The RFCOMM and TCP sockets, trace
+/// capture and the fake printer used by the host tools all implement this,
+/// so the send path and the replay tool drive the same interface.
+///
+/// Not thread-safe: each transport is used from one thread at a time (the
+/// MTA worker for Bluetooth, the connection's own worker for TCP).
+class PrinterTransport {
+ public:
+  virtual ~PrinterTransport() = default;
+
+  /// Queue and store [size] bytes. Returns false on I/O error.
+  virtual bool Write(const uint8_t* data, size_t size) = 0;
+
+  /// Write [count] buffers in order as one stream. Transports with vectored
+  /// I/O send them without concatenating; the default writes each in turn.
+  virtual bool WriteGather(const TransportBuffer* buffers, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      if (!Write(buffers[i].data, buffers[i].size)) return false;
+    }
+    return true;
+  }
+
+  /// Push stored bytes to the device. Returns false on I/O error.
+  virtual bool Flush() = 0;
+
+  /// Read up to [capacity] bytes sent back by the printer (status, IDs),
+  /// waiting at most [timeout_ms]. Returns bytes read, 0 on timeout, -1 on error.
+  virtual int Read(uint8_t* buffer, size_t capacity, int timeout_ms) = 0;
+
+  /// Close the connection. Further calls fail.
+  virtual void Close() = 0;
+
+  /// False once the connection failed or was closed, so a connect request
+  /// replaces it instead of keeping it. Transports that cannot tell say true.
+  virtual bool IsAlive() { return true; }
+};
+
+/// Writes [size] bytes to [transport] in pieces of at most [chunk_size]
+/// (0 = one piece), flushing after each, so a printer with a small receive
+/// buffer has taken one piece before the next is sent.
+inline bool WriteInChunks(PrinterTransport* transport, const uint8_t* data, size_t size, size_t chunk_size) {
+  size_t offset = 0;
+  do {
+    const size_t piece = chunk_size > 0 && size - offset > chunk_size ? chunk_size : size - offset;
+    if (!transport->Write(data + offset, piece) || !transport->Flush()) return false;
+    offset += piece;
+  } while (offset < size);
+  return true;
+}
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_PRINTER_TRANSPORT_H_
@@ -0,0 +1,192 @@
+#include "provisioning.h"
+
+#include <algorithm>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+ProvisionOptions Normalized(ProvisionOptions options) {
+  options.max_concurrent = std::max(options.max_concurrent, 1);
+  options.max_attempts = std::max(options.max_attempts, 1);
+  options.initial_backoff_ms = std::max<int64_t>(options.initial_backoff_ms, 0);
+  options.max_backoff_ms = std::max(options.max_backoff_ms, options.initial_backoff_ms);
+  return options;
+}
+
+}  // namespace
+
+std::shared_ptr<Provisioner> Provisioner::Start(std::vector<std::string> device_ids,
+                                                ProvisionOptions options,
+                                                StepRunner run_step,
+                                                EventSink on_event,
+                                                Completion on_complete) {
+  auto provisioner = std::make_shared<Provisioner>(std::move(device_ids), options, std::move(run_step),
+                                                   std::move(on_event), std::move(on_complete));
+  provisioner->worker_ = std::thread([provisioner]() { provisioner->Run(); });
+  return provisioner;
+}
+
+Provisioner::Provisioner(std::vector<std::string> device_ids,
+                         ProvisionOptions options,
+                         StepRunner run_step,
+                         EventSink on_event,
+                         Completion on_complete)
+    : options_(Normalized(options)),
+      run_step_(std::move(run_step)),
+      on_event_(std::move(on_event)),
+      on_complete_(std::move(on_complete)) {
+  if (options_.pair) steps_.push_back(ProvisionStep::kPair);
+  steps_.push_back(ProvisionStep::kConnect);
+  if (options_.probe) steps_.push_back(ProvisionStep::kProbe);
+  if (options_.test_print) steps_.push_back(ProvisionStep::kTestPrint);
+  devices_.resize(device_ids.size());
+  for (size_t i = 0; i < device_ids.size(); i++) devices_[i].result.device_id = std::move(device_ids[i]);
+}
+
+Provisioner::~Provisioner() {
+  // The worker drops the last reference itself once the run has completed.
+  if (worker_.joinable()) worker_.detach();
+}
+
+int64_t Provisioner::BackoffMs(const ProvisionOptions& options, int attempt) {
+  int64_t delay = options.initial_backoff_ms;
+  for (int i = 1; i < attempt && delay < options.max_backoff_ms; i++) delay *= 2;
+  return std::min(delay, options.max_backoff_ms);
+}
+
+void Provisioner::Run() {
+  const size_t initial = std::min(devices_.size(), static_cast<size_t>(options_.max_concurrent));
+  while (next_device_ < initial) StartDevice(next_device_++);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (finished_ < devices_.size()) {
+    std::function<void()> task;
+    if (!ready_.empty()) {
+      task = std::move(ready_.front());
+      ready_.pop_front();
+    } else if (!timers_.empty() && timers_.begin()->first <= Clock::now()) {
+      task = std::move(timers_.begin()->second);
+      timers_.erase(timers_.begin());
+    } else if (!timers_.empty()) {
+      cv_.wait_until(lock, timers_.begin()->first);
+      continue;
+    } else {
+      cv_.wait(lock);
+      continue;
+    }
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+  // Step timeouts of finished devices are no longer needed.
+  timers_.clear();
+  lock.unlock();
+  std::vector<ProvisionResult> results;
+  results.reserve(devices_.size());
+  for (const auto& device : devices_) results.push_back(device.result);
+  try {
+    if (on_complete_) on_complete_(results);
+  } catch (...) {
+    // Callbacks must not take the worker down.
+  }
+}
+
+void Provisioner::Post(std::function<void()> task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ready_.push_back(std::move(task));
+  cv_.notify_one();
+}
+
+void Provisioner::PostAt(Clock::time_point when, std::function<void()> task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  timers_.emplace(when, std::move(task));
+  cv_.notify_one();
+}
+
+void Provisioner::StartDevice(size_t index) {
+  devices_[index].started = Clock::now();
+  StartStep(index);
+}
+
+void Provisioner::StartStep(size_t index) {
+  Device& device = devices_[index];
+  device.attempt++;
+  device.result.attempts++;
+  device.result.last_step = steps_[device.next_step];
+  const uint64_t token = ++device.attempt_token;
+  Emit(index, ProvisionEventKind::kStepStarted);
+  // Completions may arrive after the run has ended; only a live provisioner
+  // takes them.
+  std::weak_ptr<Provisioner> weak = weak_from_this();
+  auto done = [weak, index, token](bool ok) {
+    if (auto self = weak.lock()) {
+      Provisioner* provisioner = self.get();
+      provisioner->Post([provisioner, index, token, ok]() { provisioner->FinishStep(index, token, ok); });
+    }
+  };
+  if (options_.step_timeout_ms > 0) {
+    PostAt(Clock::now() + std::chrono::milliseconds(options_.step_timeout_ms),
+           [this, index, token]() { FinishStep(index, token, false); });
+  }
+  try {
+    run_step_(device.result.device_id, device.result.last_step, done);
+  } catch (...) {
+    done(false);
+  }
+}
+
+void Provisioner::FinishStep(size_t index, uint64_t token, bool ok) {
+  Device& device = devices_[index];
+  if (token != device.attempt_token) return;
+  // Whichever of completion and timeout comes second is ignored.
+  device.attempt_token++;
+  if (ok) {
+    Emit(index, ProvisionEventKind::kStepSucceeded);
+    device.next_step++;
+    device.attempt = 0;
+    if (device.next_step == steps_.size()) {
+      FinishDevice(index, true);
+    } else {
+      StartStep(index);
+    }
+    return;
+  }
+  if (device.attempt < options_.max_attempts) {
+    int64_t delay_ms = BackoffMs(options_, device.attempt);
+    Emit(index, ProvisionEventKind::kStepRetrying, delay_ms);
+    PostAt(Clock::now() + std::chrono::milliseconds(delay_ms), [this, index]() { StartStep(index); });
+    return;
+  }
+  FinishDevice(index, false);
+}
+
+void Provisioner::FinishDevice(size_t index, bool ok) {
+  Device& device = devices_[index];
+  device.result.ok = ok;
+  device.result.elapsed_ms = ElapsedMs(device);
+  Emit(index, ok ? ProvisionEventKind::kDeviceSucceeded : ProvisionEventKind::kDeviceFailed);
+  finished_++;
+  if (next_device_ < devices_.size()) StartDevice(next_device_++);
+}
+
+void Provisioner::Emit(size_t index, ProvisionEventKind kind, int64_t retry_in_ms) {
+  if (!on_event_) return;
+  const Device& device = devices_[index];
+  ProvisionEvent event;
+  event.device_id = device.result.device_id;
+  event.kind = kind;
+  event.step = device.result.last_step;
+  event.attempt = device.attempt;
+  event.retry_in_ms = retry_in_ms;
+  event.elapsed_ms = ElapsedMs(device);
+  try {
+    on_event_(event);
+  } catch (...) {
+  }
+}
+
+int64_t Provisioner::ElapsedMs(const Device& device) const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - device.started).count();
+}
+
+}  // namespace flutter_thermal_printer_windows
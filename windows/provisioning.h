@@ -0,0 +1,152 @@
+#ifndef FLUTTER_PLUGIN_PROVISIONING_H_
+#define FLUTTER_PLUGIN_PROVISIONING_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+/// Stages of setting up one printer, in order.
+enum class ProvisionStep : int {
+  kPair = 0,
+  kConnect = 1,
+  kProbe = 2,
+  kTestPrint = 3,
+};
+
+enum class ProvisionEventKind : int {
+  kStepStarted = 0,
+  kStepSucceeded = 1,
+  /// The step failed and runs again after retry_in_ms.
+  kStepRetrying = 2,
+  /// Every step succeeded.
+  kDeviceSucceeded = 3,
+  /// A step failed on its last attempt; later steps were skipped.
+  kDeviceFailed = 4,
+};
+
+/// Progress of one device.
+struct ProvisionEvent {
+  std::string device_id;
+  ProvisionEventKind kind = ProvisionEventKind::kStepStarted;
+  /// Step concerned; for device events the last step attempted.
+  ProvisionStep step = ProvisionStep::kPair;
+  /// 1-based attempt of [step].
+  int attempt = 0;
+  int64_t retry_in_ms = 0;
+  /// Since the device started.
+  int64_t elapsed_ms = 0;
+};
+
+struct ProvisionOptions {
+  /// Devices worked on at once.
+  int max_concurrent = 4;
+  /// Attempts per step before the device fails.
+  int max_attempts = 3;
+  /// Delay before the first retry; doubled for each later one up to
+  /// max_backoff_ms.
+  int64_t initial_backoff_ms = 1000;
+  int64_t max_backoff_ms = 16000;
+  /// A step that has not completed by then counts as failed; its late
+  /// completion is ignored.
+  int64_t step_timeout_ms = 60000;
+  /// Optional steps; connecting always runs.
+  bool pair = true;
+  bool probe = true;
+  bool test_print = true;
+};
+
+struct ProvisionResult {
+  std::string device_id;
+  bool ok = false;
+  /// Step that failed, or the last one run when ok.
+  ProvisionStep last_step = ProvisionStep::kPair;
+  /// Attempts over all steps.
+  int attempts = 0;
+  int64_t elapsed_ms = 0;
+};
+
+/// Provisions a list of printers with bounded concurrency: each device runs
+/// its steps in order, a failed step is retried with exponential backoff,
+/// and a device that gives up frees its slot for the next one.
+///
+/// All scheduling runs on the provisioner's own thread, which also calls
+/// the step runner, the event sink and the completion. Step runners must not
+/// block: they start the operation and call done(ok) from any thread.
+class Provisioner : public std::enable_shared_from_this<Provisioner> {
+ public:
+  using StepRunner =
+      std::function<void(const std::string& device_id, ProvisionStep step, std::function<void(bool)> done)>;
+  using EventSink = std::function<void(const ProvisionEvent&)>;
+  using Completion = std::function<void(const std::vector<ProvisionResult>&)>;
+
+  /// Starts provisioning [device_ids]. The thread holds the provisioner until
+  /// [on_complete] (results in input order) has returned.
+  static std::shared_ptr<Provisioner> Start(std::vector<std::string> device_ids,
+                                            ProvisionOptions options,
+                                            StepRunner run_step,
+                                            EventSink on_event,
+                                            Completion on_complete);
+
+  Provisioner(std::vector<std::string> device_ids,
+              ProvisionOptions options,
+              StepRunner run_step,
+              EventSink on_event,
+              Completion on_complete);
+  ~Provisioner();
+
+  /// Backoff before attempt [attempt] + 1 of a step.
+  static int64_t BackoffMs(const ProvisionOptions& options, int attempt);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Device {
+    ProvisionResult result;
+    size_t next_step = 0;
+    int attempt = 0;
+    Clock::time_point started;
+    /// Bumped per attempt so a completion or timeout of an older one is ignored.
+    uint64_t attempt_token = 0;
+  };
+
+  void Run();
+  void Post(std::function<void()> task);
+  void PostAt(Clock::time_point when, std::function<void()> task);
+  void StartDevice(size_t index);
+  void StartStep(size_t index);
+  void FinishStep(size_t index, uint64_t token, bool ok);
+  void FinishDevice(size_t index, bool ok);
+  void Emit(size_t index, ProvisionEventKind kind, int64_t retry_in_ms = 0);
+  int64_t ElapsedMs(const Device& device) const;
+
+  const ProvisionOptions options_;
+  std::vector<ProvisionStep> steps_;
+  StepRunner run_step_;
+  EventSink on_event_;
+  Completion on_complete_;
+  std::thread worker_;
+
+  /// Provisioner thread only.
+  std::vector<Device> devices_;
+  size_t next_device_ = 0;
+  size_t finished_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> ready_;
+  std::multimap<Clock::time_point, std::function<void()>> timers_;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_PROVISIONING_H_
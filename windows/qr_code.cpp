@@ -0,0 +1,483 @@
+// Symbol construction (alignment pattern positions, codeword placement and
+// the finder-like penalty) follows the QR Code generator library:
+//
+// Copyright (c) Project Nayuki. (MIT License)
+// https://www.nayuki.io/page/qr-code-generator-library
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+// - The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// - The Software is provided "as is", without warranty of any kind, express or
+//   implied, including but not limited to the warranties of merchantability,
+//   fitness for a particular purpose and noninfringement. In no event shall the
+//   authors or copyright holders be liable for any claim, damages or other
+//   liability, whether in an action of contract, tort or otherwise, arising from,
+//   out of or in connection with the Software or the use or other dealings in the
+//   Software.
+
+#include "qr_code.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr int kMinVersion = 1;
+constexpr int kMaxVersion = 40;
+
+/// Per level (L, M, Q, H) and version (index 0 unused), from ISO/IEC 18004
+/// table 9.
+constexpr int8_t kEcCodewordsPerBlock[4][41] = {
+    {-1, 7,  10, 15, 20, 26, 18, 20, 24, 30, 18, 20, 24, 26, 30, 22, 24, 28, 30, 28, 28,
+     28, 28, 30, 30, 26, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+    {-1, 10, 16, 26, 18, 24, 16, 18, 22, 22, 26, 30, 22, 22, 24, 24, 28, 28, 26, 26, 26,
+     26, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28},
+    {-1, 13, 22, 18, 26, 18, 24, 18, 22, 20, 24, 28, 26, 24, 20, 30, 24, 28, 28, 26, 30,
+     28, 30, 30, 30, 30, 28, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+    {-1, 17, 28, 22, 16, 22, 28, 26, 26, 24, 28, 24, 28, 22, 24, 24, 30, 28, 28, 26, 28,
+     30, 24, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+};
+
+constexpr int8_t kEcBlocks[4][41] = {
+    {-1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 4,  4,  4,  4,  4,  6,  6,  6,  6,  7,  8,
+     8,  9, 9, 10, 12, 12, 12, 13, 14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 24, 25},
+    {-1, 1,  1,  1,  2,  2,  4,  4,  4,  5,  5,  5,  8,  9,  9,  10, 10, 11, 13, 14, 16,
+     17, 17, 18, 20, 21, 23, 25, 26, 28, 29, 31, 33, 35, 37, 38, 40, 43, 45, 47, 49},
+    {-1, 1,  1,  2,  2,  4,  4,  6,  6,  8,  8,  8,  10, 12, 16, 12, 17, 16, 18, 21, 20,
+     23, 23, 25, 27, 29, 34, 34, 35, 38, 40, 43, 45, 48, 51, 53, 56, 59, 62, 65, 68},
+    {-1, 1,  1,  2,  4,  4,  4,  5,  6,  8,  8,  11, 11, 16, 16, 18, 16, 19, 21, 25, 25,
+     25, 34, 30, 32, 35, 37, 40, 42, 45, 48, 51, 54, 57, 60, 63, 66, 70, 74, 77, 81},
+};
+
+/// Format information level bits: L = 01, M = 00, Q = 11, H = 10.
+constexpr uint32_t kFormatLevelBits[4] = {1, 0, 3, 2};
+
+constexpr char kAlphanumeric[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+enum class Mode { kNumeric, kAlphanumeric, kByte };
+
+struct BitWriter {
+  std::vector<uint8_t> bytes;
+  size_t bits = 0;
+
+  void Put(uint32_t value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+      if (bits % 8 == 0) bytes.push_back(0);
+      if ((value >> i) & 1) bytes.back() |= static_cast<uint8_t>(0x80 >> (bits % 8));
+      bits++;
+    }
+  }
+};
+
+int AlphanumericValue(char c) {
+  const char* at = std::strchr(kAlphanumeric, c);
+  return (c != '\0' && at) ? static_cast<int>(at - kAlphanumeric) : -1;
+}
+
+Mode ChooseMode(const std::string& data) {
+  if (data.empty()) return Mode::kByte;
+  bool numeric = true;
+  bool alphanumeric = true;
+  for (char c : data) {
+    if (c < '0' || c > '9') numeric = false;
+    if (AlphanumericValue(c) < 0) alphanumeric = false;
+  }
+  if (numeric) return Mode::kNumeric;
+  return alphanumeric ? Mode::kAlphanumeric : Mode::kByte;
+}
+
+int CountBits(Mode mode, int version) {
+  const int band = version <= 9 ? 0 : (version <= 26 ? 1 : 2);
+  static constexpr int kBits[3][3] = {{10, 12, 14}, {9, 11, 13}, {8, 16, 16}};
+  return kBits[static_cast<int>(mode)][band];
+}
+
+size_t PayloadBits(Mode mode, size_t length) {
+  switch (mode) {
+    case Mode::kNumeric:
+      return length / 3 * 10 + (length % 3 == 1 ? 4 : (length % 3 == 2 ? 7 : 0));
+    case Mode::kAlphanumeric:
+      return length / 2 * 11 + (length % 2) * 6;
+    case Mode::kByte:
+      break;
+  }
+  return length * 8;
+}
+
+/// Modules left for codewords once function patterns and format and
+/// version information are placed.
+int RawDataModules(int version) {
+  int result = (16 * version + 128) * version + 64;
+  if (version >= 2) {
+    const int alignments = version / 7 + 2;
+    result -= (25 * alignments - 10) * alignments - 55;
+    if (version >= 7) result -= 36;
+  }
+  return result;
+}
+
+int DataCodewords(int version, QrErrorCorrection level) {
+  const int l = static_cast<int>(level);
+  return RawDataModules(version) / 8 - kEcCodewordsPerBlock[l][version] * kEcBlocks[l][version];
+}
+
+uint8_t GfMultiply(uint8_t x, uint8_t y) {
+  int z = 0;
+  for (int i = 7; i >= 0; i--) {
+    z = (z << 1) ^ ((z >> 7) * 0x11D);
+    z ^= ((y >> i) & 1) * x;
+  }
+  return static_cast<uint8_t>(z);
+}
+
+std::vector<int> AlignmentPositions(int version) {
+  if (version == 1) return {};
+  const int count = version / 7 + 2;
+  const int size = 17 + 4 * version;
+  const int step = version == 32 ? 26 : (version * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+  std::vector<int> positions(count);
+  positions[0] = 6;
+  for (int i = count - 1, pos = size - 7; i >= 1; i--, pos -= step) positions[i] = pos;
+  return positions;
+}
+
+/// Module grid plus a mask of the modules that belong to function patterns.
+class QrMatrix {
+ public:
+  explicit QrMatrix(int version)
+      : version_(version),
+        size_(17 + 4 * version),
+        modules_(static_cast<size_t>(size_) * size_, 0),
+        function_(modules_.size(), 0) {}
+
+  int size() const { return size_; }
+  bool Get(int x, int y) const { return modules_[Index(x, y)] != 0; }
+  std::vector<uint8_t> TakeModules() { return std::move(modules_); }
+
+  void DrawFunctionPatterns(QrErrorCorrection level) {
+    for (int i = 0; i < size_; i++) {
+      SetFunction(6, i, i % 2 == 0);
+      SetFunction(i, 6, i % 2 == 0);
+    }
+    DrawFinder(3, 3);
+    DrawFinder(size_ - 4, 3);
+    DrawFinder(3, size_ - 4);
+    const std::vector<int> positions = AlignmentPositions(version_);
+    const size_t last = positions.empty() ? 0 : positions.size() - 1;
+    for (size_t i = 0; i < positions.size(); i++) {
+      for (size_t j = 0; j < positions.size(); j++) {
+        // The three corners hold finder patterns.
+        if ((i == 0 && j == 0) || (i == 0 && j == last) || (i == last && j == 0)) continue;
+        DrawAlignment(positions[i], positions[j]);
+      }
+    }
+    // Reserves the format areas; rewritten once the mask is chosen.
+    DrawFormat(level, 0);
+    DrawVersion();
+  }
+
+  void DrawFormat(QrErrorCorrection level, int mask) {
+    const uint32_t bits = QrFormatBits(level, mask);
+    auto bit = [bits](int i) { return ((bits >> i) & 1) != 0; };
+    for (int i = 0; i <= 5; i++) SetFunction(8, i, bit(i));
+    SetFunction(8, 7, bit(6));
+    SetFunction(8, 8, bit(7));
+    SetFunction(7, 8, bit(8));
+    for (int i = 9; i < 15; i++) SetFunction(14 - i, 8, bit(i));
+    for (int i = 0; i < 8; i++) SetFunction(size_ - 1 - i, 8, bit(i));
+    for (int i = 8; i < 15; i++) SetFunction(8, size_ - 15 + i, bit(i));
+    SetFunction(8, size_ - 8, true);  // always dark
+  }
+
+  /// Places [codewords] in the two-column zigzag from the bottom right,
+  /// skipping function modules.
+  void DrawCodewords(const std::vector<uint8_t>& codewords) {
+    const size_t total_bits = codewords.size() * 8;
+    size_t i = 0;
+    for (int right = size_ - 1; right >= 1; right -= 2) {
+      if (right == 6) right = 5;  // vertical timing pattern
+      const bool upward = ((right + 1) & 2) == 0;
+      for (int vert = 0; vert < size_; vert++) {
+        const int y = upward ? size_ - 1 - vert : vert;
+        for (int j = 0; j < 2; j++) {
+          const int x = right - j;
+          if (function_[Index(x, y)] || i >= total_bits) continue;
+          modules_[Index(x, y)] = (codewords[i >> 3] >> (7 - (i & 7))) & 1;
+          i++;
+        }
+      }
+    }
+  }
+
+  /// XORs the data modules with [mask]; applying it twice undoes it.
+  void ApplyMask(int mask) {
+    for (int y = 0; y < size_; y++) {
+      for (int x = 0; x < size_; x++) {
+        bool invert = false;
+        switch (mask) {
+          case 0: invert = (x + y) % 2 == 0; break;
+          case 1: invert = y % 2 == 0; break;
+          case 2: invert = x % 3 == 0; break;
+          case 3: invert = (x + y) % 3 == 0; break;
+          case 4: invert = (x / 3 + y / 2) % 2 == 0; break;
+          case 5: invert = x * y % 2 + x * y % 3 == 0; break;
+          case 6: invert = (x * y % 2 + x * y % 3) % 2 == 0; break;
+          default: invert = ((x + y) % 2 + x * y % 3) % 2 == 0; break;
+        }
+        const size_t at = Index(x, y);
+        if (invert && !function_[at]) modules_[at] ^= 1;
+      }
+    }
+  }
+
+  /// Penalty score of ISO/IEC 18004 section 7.8.3: runs, 2x2 blocks,
+  /// finder-like patterns and dark/light balance.
+  long Penalty() const {
+    long result = 0;
+    for (int pass = 0; pass < 2; pass++) {
+      for (int a = 0; a < size_; a++) {
+        bool run_color = false;
+        int run = 0;
+        int history[7] = {0, 0, 0, 0, 0, 0, 0};
+        for (int b = 0; b < size_; b++) {
+          const bool dark = pass == 0 ? Get(b, a) : Get(a, b);
+          if (dark == run_color) {
+            run++;
+            if (run == 5) {
+              result += 3;
+            } else if (run > 5) {
+              result++;
+            }
+          } else {
+            AddHistory(run, history);
+            if (!run_color) result += CountFinderLike(history) * 40;
+            run_color = dark;
+            run = 1;
+          }
+        }
+        if (run_color) {
+          AddHistory(run, history);
+          run = 0;
+        }
+        AddHistory(run + size_, history);
+        result += CountFinderLike(history) * 40;
+      }
+    }
+    for (int y = 0; y < size_ - 1; y++) {
+      for (int x = 0; x < size_ - 1; x++) {
+        const bool color = Get(x, y);
+        if (color == Get(x + 1, y) && color == Get(x, y + 1) && color == Get(x + 1, y + 1)) result += 3;
+      }
+    }
+    long dark = 0;
+    for (uint8_t module : modules_) dark += module;
+    const long total = static_cast<long>(size_) * size_;
+    const long k = (std::labs(dark * 20 - total * 10) + total - 1) / total - 1;
+    return result + k * 10;
+  }
+
+ private:
+  size_t Index(int x, int y) const { return static_cast<size_t>(y) * size_ + x; }
+
+  void SetFunction(int x, int y, bool dark) {
+    modules_[Index(x, y)] = dark ? 1 : 0;
+    function_[Index(x, y)] = 1;
+  }
+
+  /// 7x7 finder centred on (x, y) plus its light separator.
+  void DrawFinder(int x, int y) {
+    for (int dy = -4; dy <= 4; dy++) {
+      for (int dx = -4; dx <= 4; dx++) {
+        const int xx = x + dx;
+        const int yy = y + dy;
+        if (xx < 0 || xx >= size_ || yy < 0 || yy >= size_) continue;
+        const int dist = std::max(std::abs(dx), std::abs(dy));
+        SetFunction(xx, yy, dist != 2 && dist != 4);
+      }
+    }
+  }
+
+  void DrawAlignment(int x, int y) {
+    for (int dy = -2; dy <= 2; dy++) {
+      for (int dx = -2; dx <= 2; dx++) SetFunction(x + dx, y + dy, std::max(std::abs(dx), std::abs(dy)) != 1);
+    }
+  }
+
+  void DrawVersion() {
+    if (version_ < 7) return;
+    uint32_t rem = static_cast<uint32_t>(version_);
+    for (int i = 0; i < 12; i++) rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+    const uint32_t bits = static_cast<uint32_t>(version_) << 12 | rem;
+    for (int i = 0; i < 18; i++) {
+      const bool dark = ((bits >> i) & 1) != 0;
+      const int a = size_ - 11 + i % 3;
+      const int b = i / 3;
+      SetFunction(a, b, dark);
+      SetFunction(b, a, dark);
+    }
+  }
+
+  /// Run lengths, newest first; the light border counts as a run.
+  void AddHistory(int run, int history[7]) const {
+    if (history[0] == 0) run += size_;
+    std::memmove(history + 1, history, 6 * sizeof(int));
+    history[0] = run;
+  }
+
+  /// dark:light:dark:light:dark runs of 1:1:3:1:1 with 4 light on one side.
+  static int CountFinderLike(const int history[7]) {
+    const int n = history[1];
+    const bool core = n > 0 && history[2] == n && history[3] == n * 3 && history[4] == n && history[5] == n;
+    return (core && history[0] >= n * 4 && history[6] >= n ? 1 : 0) +
+           (core && history[6] >= n * 4 && history[0] >= n ? 1 : 0);
+  }
+
+  int version_;
+  int size_;
+  std::vector<uint8_t> modules_;
+  std::vector<uint8_t> function_;
+};
+
+/// Splits [data] into the version's blocks, appends each block's error
+/// correction and interleaves them column by column.
+std::vector<uint8_t> AddErrorCorrection(const std::vector<uint8_t>& data, int version, QrErrorCorrection level) {
+  const int l = static_cast<int>(level);
+  const int blocks = kEcBlocks[l][version];
+  const int ec_length = kEcCodewordsPerBlock[l][version];
+  const int raw_codewords = RawDataModules(version) / 8;
+  const int short_blocks = blocks - raw_codewords % blocks;
+  const int short_length = raw_codewords / blocks;
+
+  std::vector<std::vector<uint8_t>> all(blocks);
+  size_t offset = 0;
+  for (int i = 0; i < blocks; i++) {
+    const size_t length = static_cast<size_t>(short_length - ec_length + (i < short_blocks ? 0 : 1));
+    std::vector<uint8_t> block(data.begin() + offset, data.begin() + offset + length);
+    offset += length;
+    const std::vector<uint8_t> ec = QrErrorCorrectionCodewords(block, ec_length);
+    if (i < short_blocks) block.push_back(0);  // placeholder, skipped below
+    block.insert(block.end(), ec.begin(), ec.end());
+    all[i] = std::move(block);
+  }
+  std::vector<uint8_t> out;
+  out.reserve(raw_codewords);
+  for (size_t i = 0; i < all[0].size(); i++) {
+    for (int j = 0; j < blocks; j++) {
+      if (i != static_cast<size_t>(short_length - ec_length) || j >= short_blocks) out.push_back(all[j][i]);
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+uint32_t QrFormatBits(QrErrorCorrection level, int mask) {
+  const uint32_t data = kFormatLevelBits[static_cast<int>(level)] << 3 | static_cast<uint32_t>(mask);
+  uint32_t rem = data;
+  for (int i = 0; i < 10; i++) rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+  return (data << 10 | rem) ^ 0x5412;
+}
+
+std::vector<uint8_t> QrErrorCorrectionCodewords(const std::vector<uint8_t>& data, int ec_length) {
+  // Generator polynomial (x - 2^0)(x - 2^1)...(x - 2^(n-1)), leading term
+  // dropped, highest coefficient first.
+  std::vector<uint8_t> divisor(ec_length, 0);
+  divisor[ec_length - 1] = 1;
+  uint8_t root = 1;
+  for (int i = 0; i < ec_length; i++) {
+    for (int j = 0; j < ec_length; j++) {
+      divisor[j] = GfMultiply(divisor[j], root);
+      if (j + 1 < ec_length) divisor[j] ^= divisor[j + 1];
+    }
+    root = GfMultiply(root, 0x02);
+  }
+  std::vector<uint8_t> remainder(ec_length, 0);
+  for (uint8_t b : data) {
+    const uint8_t factor = b ^ remainder[0];
+    remainder.erase(remainder.begin());
+    remainder.push_back(0);
+    for (int i = 0; i < ec_length; i++) remainder[i] ^= GfMultiply(divisor[i], factor);
+  }
+  return remainder;
+}
+
+bool QrDataCodewords(const std::string& data, QrErrorCorrection level, int version, std::vector<uint8_t>* out) {
+  if (!out || version < kMinVersion || version > kMaxVersion) return false;
+  const Mode mode = ChooseMode(data);
+  const int count_bits = CountBits(mode, version);
+  const size_t capacity_bits = static_cast<size_t>(DataCodewords(version, level)) * 8;
+  if (data.size() >= (size_t{1} << count_bits) ||
+      4 + count_bits + PayloadBits(mode, data.size()) > capacity_bits) {
+    return false;
+  }
+
+  BitWriter writer;
+  writer.Put(mode == Mode::kNumeric ? 0x1 : (mode == Mode::kAlphanumeric ? 0x2 : 0x4), 4);
+  writer.Put(static_cast<uint32_t>(data.size()), count_bits);
+  switch (mode) {
+    case Mode::kNumeric:
+      for (size_t i = 0; i < data.size(); i += 3) {
+        const size_t n = std::min<size_t>(3, data.size() - i);
+        writer.Put(static_cast<uint32_t>(std::stoi(data.substr(i, n))), static_cast<int>(n * 3 + 1));
+      }
+      break;
+    case Mode::kAlphanumeric:
+      for (size_t i = 0; i + 1 < data.size(); i += 2) {
+        writer.Put(static_cast<uint32_t>(AlphanumericValue(data[i]) * 45 + AlphanumericValue(data[i + 1])), 11);
+      }
+      if (data.size() % 2) writer.Put(static_cast<uint32_t>(AlphanumericValue(data.back())), 6);
+      break;
+    case Mode::kByte:
+      for (char c : data) writer.Put(static_cast<uint8_t>(c), 8);
+      break;
+  }
+  // Terminator, byte alignment, then alternating pad codewords.
+  writer.Put(0, static_cast<int>(std::min<size_t>(4, capacity_bits - writer.bits)));
+  writer.Put(0, static_cast<int>((8 - writer.bits % 8) % 8));
+  for (uint8_t pad = 0xEC; writer.bits < capacity_bits; pad ^= 0xEC ^ 0x11) writer.Put(pad, 8);
+  *out = std::move(writer.bytes);
+  return true;
+}
+
+bool EncodeQrCode(const std::string& data, QrErrorCorrection level, QrSymbol* out) {
+  if (!out || static_cast<int>(level) < 0 || static_cast<int>(level) > 3) return false;
+  std::vector<uint8_t> codewords;
+  int version = kMinVersion;
+  while (!QrDataCodewords(data, level, version, &codewords)) {
+    if (++version > kMaxVersion) return false;
+  }
+
+  QrMatrix matrix(version);
+  matrix.DrawFunctionPatterns(level);
+  matrix.DrawCodewords(AddErrorCorrection(codewords, version, level));
+  int best_mask = 0;
+  long best_penalty = -1;
+  for (int mask = 0; mask < 8; mask++) {
+    matrix.ApplyMask(mask);
+    matrix.DrawFormat(level, mask);
+    const long penalty = matrix.Penalty();
+    if (best_penalty < 0 || penalty < best_penalty) {
+      best_mask = mask;
+      best_penalty = penalty;
+    }
+    matrix.ApplyMask(mask);
+  }
+  matrix.ApplyMask(best_mask);
+  matrix.DrawFormat(level, best_mask);
+
+  out->version = version;
+  out->size = matrix.size();
+  out->mask = best_mask;
+  out->modules = matrix.TakeModules();
+  return true;
+}
+
+}  // namespace flutter_thermal_printer_windows
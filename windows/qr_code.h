@@ -0,0 +1,48 @@
+#ifndef FLUTTER_PLUGIN_QR_CODE_H_
+#define FLUTTER_PLUGIN_QR_CODE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+/// Share of codewords that can be restored: about 7%, 15%, 25% and 30%.
+/// Values match the Dart QrErrorCorrection index.
+enum class QrErrorCorrection : int {
+  kLow = 0,
+  kMedium = 1,
+  kQuartile = 2,
+  kHigh = 3,
+};
+
+/// Model 2 QR symbol without quiet zone.
+struct QrSymbol {
+  /// 1..40; the side is 17 + 4 * version modules.
+  int version = 0;
+  int size = 0;
+  int mask = 0;
+  /// size * size modules, row-major; 1 = dark.
+  std::vector<uint8_t> modules;
+
+  bool Dark(int x, int y) const { return modules[static_cast<size_t>(y) * size + x] != 0; }
+};
+
+/// Encodes [data] in one segment (numeric, alphanumeric or byte mode,
+/// whichever is shortest for the whole string) at the smallest version that
+/// holds it at [level], with the mask of lowest penalty. Returns false if the
+/// data does not fit version 40.
+bool EncodeQrCode(const std::string& data, QrErrorCorrection level, QrSymbol* out);
+
+/// Data codewords of [data] before error correction (tests).
+bool QrDataCodewords(const std::string& data, QrErrorCorrection level, int version, std::vector<uint8_t>* out);
+
+/// Reed-Solomon error correction codewords of one block (tests).
+std::vector<uint8_t> QrErrorCorrectionCodewords(const std::vector<uint8_t>& data, int ec_length);
+
+/// 15-bit format information for [level] and [mask], mask pattern applied.
+uint32_t QrFormatBits(QrErrorCorrection level, int mask);
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_QR_CODE_H_
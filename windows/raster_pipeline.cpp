@@ -0,0 +1,182 @@
+#include "raster_pipeline.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "image_resample.h"
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr size_t kRasterHeaderSize = 8;
+constexpr int kMaxBandHeight = 1024;
+/// ESC 3 24 + ESC * 33 nL nH before the columns of a strip.
+constexpr size_t kStripHeaderSize = 8;
+/// LF after each strip, ESC 2 after the last one.
+constexpr size_t kStripTrailerSize = 3;
+constexpr int kStripHeight = 24;
+
+int BytesPerPixel(SourcePixelFormat format) {
+  return format == SourcePixelFormat::kRgba8888 ? 4 : 1;
+}
+
+/// Re-packs up to 24 1bpp rows as one ESC * 33 strip: three bytes per
+/// column, top dot in the high bit. Line spacing is set to the strip height
+/// so strips touch, and reset to the default after the last one.
+size_t EncodeColumnStrip(const uint8_t* bits, size_t row_bytes, int rows, int width, bool last,
+                         uint8_t* out) {
+  uint8_t* p = out;
+  *p++ = 0x1B;  // ESC 3 n
+  *p++ = 0x33;
+  *p++ = kStripHeight;
+  *p++ = 0x1B;  // ESC * m nL nH (n in dots)
+  *p++ = 0x2A;
+  *p++ = 33;
+  *p++ = static_cast<uint8_t>(width & 0xFF);
+  *p++ = static_cast<uint8_t>((width >> 8) & 0xFF);
+  for (int x = 0; x < width; x++) {
+    const uint8_t mask = static_cast<uint8_t>(0x80 >> (x & 7));
+    const uint8_t* column = bits + (x >> 3);
+    for (int k = 0; k < 3; k++) {
+      uint8_t v = 0;
+      for (int b = 0; b < 8; b++) {
+        const int r = k * 8 + b;
+        if (r < rows && (column[static_cast<size_t>(r) * row_bytes] & mask)) {
+          v |= static_cast<uint8_t>(0x80 >> b);
+        }
+      }
+      *p++ = v;
+    }
+  }
+  *p++ = 0x0A;
+  if (last) {
+    *p++ = 0x1B;  // ESC 2
+    *p++ = 0x32;
+  }
+  return static_cast<size_t>(p - out);
+}
+
+/// GS v 0 m xL xH yL yH (x in bytes, y in dots).
+void WriteRasterHeader(size_t row_bytes, int rows, uint8_t* header) {
+  header[0] = 0x1D;
+  header[1] = 0x76;
+  header[2] = 0x30;
+  header[3] = 0;
+  header[4] = static_cast<uint8_t>(row_bytes & 0xFF);
+  header[5] = static_cast<uint8_t>((row_bytes >> 8) & 0xFF);
+  header[6] = static_cast<uint8_t>(rows & 0xFF);
+  header[7] = static_cast<uint8_t>((rows >> 8) & 0xFF);
+}
+
+}  // namespace
+
+bool RasterOutputSize(const RasterImageSource& source, int* width, int* height) {
+  if (!source.pixels || source.width <= 0 || source.height <= 0) return false;
+  size_t min_stride = static_cast<size_t>(source.width) * BytesPerPixel(source.format);
+  if (source.stride != 0 && source.stride < min_stride) return false;
+  int out_w = source.target_width > 0 ? source.target_width : source.width;
+  if ((out_w + 7) / 8 > 0xFFFF) return false;
+  int64_t out_h = (static_cast<int64_t>(source.height) * out_w + source.width / 2) / source.width;
+  if (out_h < 1) out_h = 1;
+  if (out_h > 0x7FFFFFFF) return false;
+  if (width) *width = out_w;
+  if (height) *height = static_cast<int>(out_h);
+  return true;
+}
+
+bool StreamRasterImage(const RasterImageSource& source, const RasterBandSink& sink) {
+  int out_w = 0;
+  int out_h = 0;
+  if (!sink || !RasterOutputSize(source, &out_w, &out_h)) return false;
+
+  const bool columns = source.command == RasterCommand::kEscStar24;
+  const int band_height = columns ? kStripHeight : std::clamp(source.band_height, 1, kMaxBandHeight);
+  const size_t row_bytes = static_cast<size_t>(out_w + 7) / 8;
+
+  LumaResampler resampler(source, out_w, out_h);
+  std::vector<uint8_t> luma(out_w);
+  // Error rows for Floyd-Steinberg, padded by one on each side.
+  std::vector<int> err_cur(out_w + 2, 0);
+  std::vector<int> err_next(out_w + 2, 0);
+  std::vector<uint8_t> band(kRasterHeaderSize + row_bytes * band_height);
+  std::vector<uint8_t> strip;
+  if (columns) strip.resize(kStripHeaderSize + 3 * static_cast<size_t>(out_w) + kStripTrailerSize);
+
+  for (int band_y = 0; band_y < out_h; band_y += band_height) {
+    const int rows = std::min(band_height, out_h - band_y);
+    uint8_t* header = band.data();
+    WriteRasterHeader(row_bytes, rows, header);
+    uint8_t* bits = header + kRasterHeaderSize;
+    std::memset(bits, 0, row_bytes * rows);
+
+    for (int r = 0; r < rows; r++) {
+      resampler.Row(band_y + r, luma.data());
+      uint8_t* out_row = bits + static_cast<size_t>(r) * row_bytes;
+      for (int x = 0; x < out_w; x++) {
+        int v = luma[x];
+        bool black;
+        if (source.dither) {
+          v += err_cur[x + 1];
+          black = v < source.threshold;
+          int e = v - (black ? 0 : 255);
+          err_cur[x + 2] += (e * 7) / 16;
+          err_next[x] += (e * 3) / 16;
+          err_next[x + 1] += (e * 5) / 16;
+          err_next[x + 2] += e / 16;
+        } else {
+          black = v < source.threshold;
+        }
+        if (black) out_row[x >> 3] |= static_cast<uint8_t>(0x80 >> (x & 7));
+      }
+      if (source.dither) {
+        err_cur.swap(err_next);
+        std::fill(err_next.begin(), err_next.end(), 0);
+      }
+    }
+    if (columns) {
+      size_t size = EncodeColumnStrip(bits, row_bytes, rows, out_w, band_y + rows >= out_h, strip.data());
+      if (!sink(strip.data(), size)) return false;
+    } else if (!sink(band.data(), kRasterHeaderSize + row_bytes * rows)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool StreamBitmapBands(const uint8_t* bits,
+                       int width,
+                       int height,
+                       size_t row_bytes,
+                       RasterCommand command,
+                       int band_height,
+                       const RasterBandSink& sink) {
+  const size_t out_row_bytes = static_cast<size_t>(width + 7) / 8;
+  if (!bits || !sink || width <= 0 || height <= 0 || out_row_bytes > 0xFFFF || row_bytes < out_row_bytes) {
+    return false;
+  }
+  if (command == RasterCommand::kEscStar24) {
+    std::vector<uint8_t> strip(kStripHeaderSize + 3 * static_cast<size_t>(width) + kStripTrailerSize);
+    for (int y = 0; y < height; y += kStripHeight) {
+      const int rows = std::min(kStripHeight, height - y);
+      size_t size = EncodeColumnStrip(bits + static_cast<size_t>(y) * row_bytes, row_bytes, rows, width,
+                                      y + rows >= height, strip.data());
+      if (!sink(strip.data(), size)) return false;
+    }
+    return true;
+  }
+  band_height = std::clamp(band_height, 1, kMaxBandHeight);
+  std::vector<uint8_t> band(kRasterHeaderSize + out_row_bytes * band_height);
+  for (int y = 0; y < height; y += band_height) {
+    const int rows = std::min(band_height, height - y);
+    WriteRasterHeader(out_row_bytes, rows, band.data());
+    for (int r = 0; r < rows; r++) {
+      std::memcpy(band.data() + kRasterHeaderSize + static_cast<size_t>(r) * out_row_bytes,
+                  bits + static_cast<size_t>(y + r) * row_bytes, out_row_bytes);
+    }
+    if (!sink(band.data(), kRasterHeaderSize + out_row_bytes * rows)) return false;
+  }
+  return true;
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,85 @@
+#ifndef FLUTTER_PLUGIN_RASTER_PIPELINE_H_
+#define FLUTTER_PLUGIN_RASTER_PIPELINE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+enum class SourcePixelFormat : int {
+  kGray8 = 0,
+  kRgba8888 = 1,
+};
+
+/// How source pixels are combined when the image is scaled.
+enum class ResampleFilter : int {
+  /// Area average when shrinking, bilinear when enlarging.
+  kAuto = 0,
+  kNearest = 1,
+  kBilinear = 2,
+  /// Exact box average over each output dot's footprint (best for logos
+  /// and photos shrunk to the head width).
+  kArea = 3,
+};
+
+/// ESC/POS command the bands are encoded with.
+enum class RasterCommand : int {
+  /// GS v 0: one command per band with rows as stored. Fewest bytes and
+  /// round trips; supported by nearly every current printer.
+  kGsV0 = 0,
+  /// ESC * 33 (24-dot double density) column strips, one per 24 rows, for
+  /// firmware without GS v 0. Bands are always 24 rows.
+  kEscStar24 = 1,
+};
+
+/// Source bitmap and conversion settings for StreamRasterImage.
+struct RasterImageSource {
+  const uint8_t* pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  /// Bytes per source row; 0 = tightly packed.
+  size_t stride = 0;
+  /// Values other than kRgba8888 are read as kGray8.
+  SourcePixelFormat format = SourcePixelFormat::kGray8;
+  /// Output width in dots (printer head width); 0 = keep source width.
+  /// Height is scaled to keep the aspect ratio.
+  int target_width = 0;
+  ResampleFilter filter = ResampleFilter::kAuto;
+  /// Floyd-Steinberg error diffusion; otherwise plain threshold.
+  bool dither = true;
+  /// Luma below this prints black.
+  int threshold = 128;
+  /// Rows per GS v 0 band. Bounds memory and the latency to the first band.
+  int band_height = 24;
+  RasterCommand command = RasterCommand::kGsV0;
+};
+
+/// Receives each encoded band (GS v 0 header + 1bpp rows, or an ESC * strip). The buffer is
+/// reused for the next band, so copy it if it must outlive the call.
+/// Return false to stop the pipeline.
+using RasterBandSink = std::function<bool(const uint8_t* data, size_t size)>;
+
+/// Streaming source rows -> luma + scale -> dither -> raster-encode pipeline.
+/// Works band by band with buffers sized by the output width and band
+/// height only, so memory does not grow with image height. Returns false if
+/// the source is invalid or the sink stopped early.
+bool StreamRasterImage(const RasterImageSource& source, const RasterBandSink& sink);
+
+/// Encodes an already 1bpp bitmap ([row_bytes] apart, MSB = leftmost dot)
+/// into bands like StreamRasterImage, without scaling or dithering.
+bool StreamBitmapBands(const uint8_t* bits,
+                       int width,
+                       int height,
+                       size_t row_bytes,
+                       RasterCommand command,
+                       int band_height,
+                       const RasterBandSink& sink);
+
+/// Output size in dots for [source] (after scaling). Returns false if invalid.
+bool RasterOutputSize(const RasterImageSource& source, int* width, int* height);
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_RASTER_PIPELINE_H_
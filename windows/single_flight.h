@@ -0,0 +1,130 @@
+#ifndef FLUTTER_PLUGIN_SINGLE_FLIGHT_H_
+#define FLUTTER_PLUGIN_SINGLE_FLIGHT_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "native_metrics.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// How SingleFlight::Do served a request.
+enum class FlightJoin {
+  /// No matching query was running: this call started one.
+  kStarted,
+  /// Joined a query already in flight; gets its result.
+  kJoined,
+  /// Answered from a result younger than the TTL.
+  kCached,
+};
+
+/// Coalesces concurrent identical asynchronous queries: while a query for a
+/// key is in flight, further requests for that key join it instead of
+/// starting another, and every caller gets the one result. With a TTL, a
+/// completed result is also reused until it is [ttl_ms] old.
+///
+/// Thread-safe. Callbacks run without the lock held, on the thread that
+/// completes the query (or the caller's thread for cache hits), so they may
+/// call Do again.
+template <typename Value>
+class SingleFlight {
+ public:
+  using Callback = std::function<void(const Value&)>;
+  /// Starts the query; must call [done] exactly once, on any thread.
+  using Start = std::function<void(Callback done)>;
+
+  explicit SingleFlight(std::function<int64_t()> now_ms = MetricsNowMs) : now_ms_(std::move(now_ms)) {}
+
+  /// Results are reused for [ttl_ms] after completion; 0 (default) only
+  /// coalesces queries that overlap.
+  void SetTtlMs(int64_t ttl_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ttl_ms_ = ttl_ms < 0 ? 0 : ttl_ms;
+    if (ttl_ms_ == 0) cache_.clear();
+  }
+
+  FlightJoin Do(const std::string& key, Callback callback, const Start& start) {
+    std::shared_ptr<Flight> flight;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto cached = cache_.find(key);
+      if (cached != cache_.end()) {
+        if (now_ms_() - cached->second.at_ms < ttl_ms_) {
+          Value value = cached->second.value;
+          lock.unlock();
+          callback(value);
+          return FlightJoin::kCached;
+        }
+        cache_.erase(cached);
+      }
+      auto running = flights_.find(key);
+      if (running != flights_.end()) {
+        running->second->waiters.push_back(std::move(callback));
+        return FlightJoin::kJoined;
+      }
+      flight = std::make_shared<Flight>();
+      flight->waiters.push_back(std::move(callback));
+      flights_[key] = flight;
+    }
+    start([this, key, flight](const Value& value) { Complete(key, flight, value); });
+    return FlightJoin::kStarted;
+  }
+
+  /// Drops the cached result for [key]. A query already in flight still
+  /// answers its callers, but later requests start a fresh one and its
+  /// (possibly stale) result is not cached.
+  void Invalidate(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.erase(key);
+    flights_.erase(key);
+  }
+
+  void InvalidateAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
+    flights_.clear();
+  }
+
+ private:
+  struct Flight {
+    std::vector<Callback> waiters;
+    bool done = false;
+  };
+
+  struct Cached {
+    Value value;
+    int64_t at_ms;
+  };
+
+  void Complete(const std::string& key, const std::shared_ptr<Flight>& flight, const Value& value) {
+    std::vector<Callback> waiters;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (flight->done) return;
+      flight->done = true;
+      auto it = flights_.find(key);
+      if (it != flights_.end() && it->second == flight) {
+        flights_.erase(it);
+        if (ttl_ms_ > 0) cache_[key] = Cached{value, now_ms_()};
+      }
+      waiters.swap(flight->waiters);
+    }
+    for (auto& waiter : waiters) waiter(value);
+  }
+
+  std::function<int64_t()> now_ms_;
+  std::mutex mutex_;
+  int64_t ttl_ms_ = 0;
+  std::unordered_map<std::string, std::shared_ptr<Flight>> flights_;
+  std::unordered_map<std::string, Cached> cache_;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_SINGLE_FLIGHT_H_
@@ -0,0 +1,347 @@
+#include "tcp_printers.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "native_metrics.h"
+#include "tcp_transport.h"
+#include "trace_capture.h"
+#include "trace_spans.h"
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+/// Upper bound for one gathered write, so a burst of queued jobs still
+/// reports completion progressively.
+constexpr size_t kMaxBatchBytes = 1 << 20;
+constexpr size_t kMaxBatchJobs = 64;
+constexpr int kStatusTimeoutMs = 500;
+constexpr int kProbeTimeoutMs = 300;
+
+struct TcpOp {
+  enum Kind { kConnect, kSend, kStatus, kProbe };
+  Kind kind = kConnect;
+  std::vector<uint8_t> data;
+  std::function<void(bool)> done;
+  std::function<void(bool, const PrinterStatusReport&)> status_done;
+  std::function<void(bool, const PrinterIdentity&)> probe_done;
+};
+
+void Complete(const TcpOp& op, bool ok) {
+  try {
+    if (op.kind == TcpOp::kStatus) {
+      if (op.status_done) op.status_done(ok, PrinterStatusReport());
+    } else if (op.kind == TcpOp::kProbe) {
+      if (op.probe_done) op.probe_done(ok, PrinterIdentity());
+    } else if (op.done) {
+      op.done(ok);
+    }
+  } catch (...) {
+    // Callbacks must not take the worker down.
+  }
+}
+
+/// One LAN printer: a socket plus the worker that owns it. Every operation
+/// is queued, so sends and status queries keep their order on the wire.
+class TcpPrinterConnection {
+ public:
+  /// The worker holds a reference until it exits, so the connection outlives
+  /// a Stop() issued from one of its own callbacks.
+  static std::shared_ptr<TcpPrinterConnection> Start(std::string id, std::string host, uint16_t port) {
+    auto connection = std::make_shared<TcpPrinterConnection>(std::move(id), std::move(host), port);
+    connection->worker_ = std::thread([connection]() { connection->Run(); });
+    return connection;
+  }
+
+  TcpPrinterConnection(std::string id, std::string host, uint16_t port)
+      : id_(std::move(id)), span_id_(SpanInternName(id_)), host_(std::move(host)), port_(port) {}
+
+  ~TcpPrinterConnection() {
+    // Only still joinable when the worker dropped the last reference itself.
+    if (worker_.joinable()) worker_.detach();
+  }
+
+  void Post(TcpOp op) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!stopping_) {
+        ops_.push_back(std::move(op));
+        cv_.notify_one();
+        return;
+      }
+    }
+    Complete(op, false);
+  }
+
+  /// Queued operations fail and a blocked write or read is aborted. With
+  /// [wait], returns once the worker has exited; otherwise the worker exits
+  /// on its own, which can take up to the connect timeout if a connect is in
+  /// progress (it cannot be aborted before there is a socket).
+  void Stop(bool wait) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      if (socket_) socket_->Abort();
+    }
+    cv_.notify_one();
+    std::lock_guard<std::mutex> lock(join_mutex_);
+    if (!worker_.joinable()) return;
+    // From a completion callback the worker exits once the callback returns.
+    if (!wait || worker_.get_id() == std::this_thread::get_id()) {
+      worker_.detach();
+      return;
+    }
+    worker_.join();
+  }
+
+  bool connected() const { return connected_.load(); }
+
+ private:
+  void Run() {
+    SpanSetThreadName(span_id_);
+    for (;;) {
+      std::vector<TcpOp> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stopping_ || !ops_.empty(); });
+        if (stopping_) break;
+        batch.push_back(std::move(ops_.front()));
+        ops_.pop_front();
+        if (batch[0].kind == TcpOp::kSend) {
+          size_t bytes = batch[0].data.size();
+          while (!ops_.empty() && ops_.front().kind == TcpOp::kSend &&
+                 batch.size() < kMaxBatchJobs && bytes + ops_.front().data.size() <= kMaxBatchBytes) {
+            bytes += ops_.front().data.size();
+            batch.push_back(std::move(ops_.front()));
+            ops_.pop_front();
+          }
+        }
+      }
+      switch (batch[0].kind) {
+        case TcpOp::kConnect:
+          Complete(batch[0], EnsureConnected());
+          break;
+        case TcpOp::kSend:
+          SendBatch(batch);
+          break;
+        case TcpOp::kStatus:
+          QueryStatus(batch[0]);
+          break;
+        case TcpOp::kProbe:
+          Probe(batch[0]);
+          break;
+      }
+    }
+    std::deque<TcpOp> abandoned;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      abandoned.swap(ops_);
+    }
+    for (const auto& op : abandoned) Complete(op, false);
+    DropConnection();
+  }
+
+  bool EnsureConnected() {
+    if (transport_ && socket_->IsAlive()) {
+      MetricsAdd("tcp.reused", 1);
+      return true;
+    }
+    DropConnection();
+    int64_t start_ms = MetricsNowMs();
+    std::unique_ptr<TcpTransport> socket;
+    {
+      ScopedSpan span("TcpConnect", span_id_);
+      socket = TcpTransport::Connect(host_, port_);
+    }
+    if (!socket) {
+      MetricsAdd("tcp.connect_failures", 1);
+      return false;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) return false;
+      socket_ = socket.get();
+    }
+    transport_ = std::make_unique<TracingTransport>(id_, std::move(socket));
+    connected_.store(true);
+    MetricsAdd("tcp.connects", 1);
+    MetricsSet("tcp.last_connect_ms", MetricsNowMs() - start_ms);
+    return true;
+  }
+
+  void DropConnection() {
+    connected_.store(false);
+    if (!transport_) return;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      socket_ = nullptr;
+    }
+    transport_->Close();
+    transport_.reset();
+  }
+
+  void SendBatch(const std::vector<TcpOp>& batch) {
+    bool ok = EnsureConnected();
+    if (ok) {
+      std::vector<TransportBuffer> buffers;
+      buffers.reserve(batch.size());
+      size_t bytes = 0;
+      for (const auto& op : batch) {
+        buffers.push_back(TransportBuffer{op.data.data(), op.data.size()});
+        bytes += op.data.size();
+      }
+      {
+        ScopedSpan span("TcpWriteGather", span_id_);
+        ok = transport_->WriteGather(buffers.data(), buffers.size()) && transport_->Flush();
+      }
+      if (ok) {
+        MetricsAdd("tcp.batches", 1);
+        MetricsAdd("tcp.jobs", static_cast<int64_t>(batch.size()));
+        MetricsAdd("tcp.bytes", static_cast<int64_t>(bytes));
+      } else {
+        // A partly written batch is not retried: resending could print twice.
+        MetricsAdd("tcp.send_failures", 1);
+        DropConnection();
+      }
+    }
+    for (const auto& op : batch) Complete(op, ok);
+  }
+
+  void QueryStatus(const TcpOp& op) {
+    PrinterStatusReport report;
+    bool ok = EnsureConnected() && QueryPrinterStatus(transport_.get(), kStatusTimeoutMs, &report);
+    try {
+      if (op.status_done) op.status_done(ok, report);
+    } catch (...) {
+    }
+  }
+
+  void Probe(const TcpOp& op) {
+    PrinterIdentity identity;
+    bool ok = EnsureConnected() && ProbePrinterIdentity(transport_.get(), kProbeTimeoutMs, &identity);
+    try {
+      if (op.probe_done) op.probe_done(ok, identity);
+    } catch (...) {
+    }
+  }
+
+  const std::string id_;
+  /// Interned id_ for span details and the worker's track name.
+  const char* const span_id_;
+  const std::string host_;
+  const uint16_t port_;
+  std::thread worker_;
+  std::mutex join_mutex_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<TcpOp> ops_;
+  bool stopping_ = false;
+  /// Owned by the worker; socket_ (guarded by mutex_) points into it so
+  /// Stop() can abort a blocked call.
+  std::unique_ptr<PrinterTransport> transport_;
+  TcpTransport* socket_ = nullptr;
+  std::atomic<bool> connected_{false};
+};
+
+std::mutex g_tcp_mutex;
+std::unordered_map<std::string, std::shared_ptr<TcpPrinterConnection>> g_tcp_connections;
+
+std::shared_ptr<TcpPrinterConnection> FindConnection(const std::string& id) {
+  std::lock_guard<std::mutex> lock(g_tcp_mutex);
+  auto it = g_tcp_connections.find(id);
+  return it == g_tcp_connections.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<TcpPrinterConnection> GetOrCreateConnection(const std::string& id) {
+  std::string host;
+  uint16_t port = 0;
+  if (!ParseTcpPrinterId(id, &host, &port)) return nullptr;
+  std::lock_guard<std::mutex> lock(g_tcp_mutex);
+  auto& slot = g_tcp_connections[id];
+  if (!slot) slot = TcpPrinterConnection::Start(id, host, port);
+  return slot;
+}
+
+void Post(const std::string& id, TcpOp op) {
+  auto connection = GetOrCreateConnection(id);
+  if (!connection) {
+    Complete(op, false);
+    return;
+  }
+  connection->Post(std::move(op));
+}
+
+}  // namespace
+
+bool IsTcpPrinterId(const std::string& id) {
+  return ParseTcpPrinterId(id, nullptr, nullptr);
+}
+
+void TcpConnectAsync(const std::string& id, std::function<void(bool)> callback) {
+  TcpOp op;
+  op.kind = TcpOp::kConnect;
+  op.done = std::move(callback);
+  Post(id, std::move(op));
+}
+
+void TcpDisconnect(const std::string& id) {
+  std::shared_ptr<TcpPrinterConnection> connection;
+  {
+    std::lock_guard<std::mutex> lock(g_tcp_mutex);
+    auto it = g_tcp_connections.find(id);
+    if (it == g_tcp_connections.end()) return;
+    connection = std::move(it->second);
+    g_tcp_connections.erase(it);
+  }
+  // Called on the platform thread: do not wait out a connect in progress.
+  connection->Stop(/*wait=*/false);
+}
+
+bool TcpIsConnected(const std::string& id) {
+  auto connection = FindConnection(id);
+  return connection && connection->connected();
+}
+
+void TcpSendAsync(const std::string& id,
+                  std::vector<uint8_t> data,
+                  std::function<void(bool)> callback) {
+  TcpOp op;
+  op.kind = TcpOp::kSend;
+  op.data = std::move(data);
+  op.done = std::move(callback);
+  Post(id, std::move(op));
+}
+
+void TcpQueryStatusAsync(const std::string& id,
+                         std::function<void(bool, const PrinterStatusReport&)> callback) {
+  TcpOp op;
+  op.kind = TcpOp::kStatus;
+  op.status_done = std::move(callback);
+  Post(id, std::move(op));
+}
+
+void TcpProbeAsync(const std::string& id,
+                   std::function<void(bool, const PrinterIdentity&)> callback) {
+  TcpOp op;
+  op.kind = TcpOp::kProbe;
+  op.probe_done = std::move(callback);
+  Post(id, std::move(op));
+}
+
+void TcpDisconnectAll() {
+  std::unordered_map<std::string, std::shared_ptr<TcpPrinterConnection>> all;
+  {
+    std::lock_guard<std::mutex> lock(g_tcp_mutex);
+    all.swap(g_tcp_connections);
+  }
+  for (auto& entry : all) entry.second->Stop(/*wait=*/true);
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,56 @@
+#ifndef FLUTTER_PLUGIN_TCP_PRINTERS_H_
+#define FLUTTER_PLUGIN_TCP_PRINTERS_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "printer_capabilities.h"
+#include "printer_status.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// True if [id] addresses a LAN printer ("tcp:HOST[:PORT]", see
+/// ParseTcpPrinterId). Such ids are handled here instead of by the
+/// Bluetooth backend.
+bool IsTcpPrinterId(const std::string& id);
+
+/// Opens (or reuses) the connection to a LAN printer on its own worker
+/// thread and invokes callback(bool connected) there.
+void TcpConnectAsync(const std::string& id, std::function<void(bool)> callback);
+
+/// Closes the connection without waiting for its worker. Queued sends fail;
+/// a blocked send is aborted, a connect in progress is dropped once it
+/// returns.
+void TcpDisconnect(const std::string& id);
+
+/// True if the connection is open (as of its last use).
+bool TcpIsConnected(const std::string& id);
+
+/// Queues [data] for the printer and invokes callback(bool ok) once it has
+/// been written. Jobs queued while a write is in progress go out together in
+/// one gathered write. Connects first if needed and keeps the connection
+/// open for later jobs; a connection the printer has closed is replaced
+/// before the next job, never in the middle of one.
+void TcpSendAsync(const std::string& id,
+                  std::vector<uint8_t> data,
+                  std::function<void(bool)> callback);
+
+/// Queries real-time status in order with queued sends and invokes
+/// callback(answered, report) on the connection's worker.
+void TcpQueryStatusAsync(const std::string& id,
+                         std::function<void(bool, const PrinterStatusReport&)> callback);
+
+/// Probes the printer (GS I, DLE EOT) in order with queued sends and invokes
+/// callback(ok, identity) on the connection's worker. Connects first if
+/// needed; ok is false if that or the link failed.
+void TcpProbeAsync(const std::string& id,
+                   std::function<void(bool, const PrinterIdentity&)> callback);
+
+/// Closes every LAN connection and waits for their workers (shutdown, tests).
+void TcpDisconnectAll();
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TCP_PRINTERS_H_
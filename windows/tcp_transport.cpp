@@ -0,0 +1,350 @@
+#include "tcp_transport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <mutex>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr uintptr_t kInvalidSocket = static_cast<uintptr_t>(-1);
+
+#ifdef _WIN32
+
+using NativeSocket = SOCKET;
+
+bool EnsureWinsock() {
+  static std::once_flag once;
+  static bool ok = false;
+  std::call_once(once, []() {
+    WSADATA data;
+    ok = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+  });
+  return ok;
+}
+
+void CloseNative(NativeSocket s) { closesocket(s); }
+
+bool SetNonBlocking(NativeSocket s, bool enabled) {
+  u_long mode = enabled ? 1 : 0;
+  return ioctlsocket(s, FIONBIO, &mode) == 0;
+}
+
+bool ConnectInProgress() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+
+/// Waits until [s] is readable (or writable); 1 ready, 0 timeout, -1 error.
+/// select is used instead of WSAPoll, which misses failed connects on older
+/// Windows builds.
+int WaitSocket(NativeSocket s, bool for_write, int timeout_ms) {
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(s, &set);
+  fd_set except;
+  FD_ZERO(&except);
+  FD_SET(s, &except);
+  timeval tv;
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = (timeout_ms % 1000) * 1000;
+  int r = select(0, for_write ? nullptr : &set, for_write ? &set : nullptr, &except, &tv);
+  if (r < 0) return -1;
+  if (r == 0) return 0;
+  return FD_ISSET(s, &except) && !FD_ISSET(s, &set) ? -1 : 1;
+}
+
+#else
+
+using NativeSocket = int;
+
+bool EnsureWinsock() { return true; }
+
+void CloseNative(NativeSocket s) { ::close(s); }
+
+bool SetNonBlocking(NativeSocket s, bool enabled) {
+  int flags = fcntl(s, F_GETFL, 0);
+  if (flags < 0) return false;
+  flags = enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+  return fcntl(s, F_SETFL, flags) == 0;
+}
+
+bool ConnectInProgress() { return errno == EINPROGRESS; }
+
+/// Waits until [s] is readable (or writable); 1 ready, 0 timeout, -1 error.
+int WaitSocket(NativeSocket s, bool for_write, int timeout_ms) {
+  pollfd p;
+  p.fd = s;
+  p.events = for_write ? POLLOUT : POLLIN;
+  p.revents = 0;
+  int r;
+  do {
+    r = poll(&p, 1, timeout_ms);
+  } while (r < 0 && errno == EINTR);
+  if (r < 0) return -1;
+  if (r == 0) return 0;
+  // POLLHUP with pending data still counts as readable.
+  return (p.revents & (POLLIN | POLLOUT | POLLHUP)) ? 1 : -1;
+}
+
+#endif
+
+NativeSocket Native(uintptr_t s) { return static_cast<NativeSocket>(s); }
+
+/// Non-blocking connect bounded by [timeout_ms]; the socket is returned to
+/// blocking mode on success.
+bool ConnectWithTimeout(NativeSocket s, const sockaddr* addr, int addr_len, int timeout_ms) {
+  if (!SetNonBlocking(s, true)) return false;
+  if (connect(s, addr, addr_len) != 0) {
+    if (!ConnectInProgress()) return false;
+    if (WaitSocket(s, true, timeout_ms) != 1) return false;
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &len) != 0 ||
+        error != 0) {
+      return false;
+    }
+  }
+  return SetNonBlocking(s, false);
+}
+
+}  // namespace
+
+bool ParseTcpPrinterId(const std::string& id, std::string* host, uint16_t* port) {
+  static const char kPrefix[] = "tcp:";
+  if (id.compare(0, sizeof(kPrefix) - 1, kPrefix) != 0) return false;
+  std::string rest = id.substr(sizeof(kPrefix) - 1);
+  std::string h;
+  std::string p;
+  if (!rest.empty() && rest[0] == '[') {
+    size_t close = rest.find(']');
+    if (close == std::string::npos) return false;
+    h = rest.substr(1, close - 1);
+    if (close + 1 < rest.size()) {
+      if (rest[close + 1] != ':') return false;
+      p = rest.substr(close + 2);
+    }
+  } else {
+    size_t colon = rest.find(':');
+    h = rest.substr(0, colon);
+    if (colon != std::string::npos) p = rest.substr(colon + 1);
+  }
+  if (h.empty()) return false;
+  unsigned long parsed = kRawPrintPort;
+  if (!p.empty()) {
+    if (p.size() > 5 || p.find_first_not_of("0123456789") != std::string::npos) return false;
+    parsed = std::stoul(p);
+    if (parsed == 0 || parsed > 65535) return false;
+  }
+  if (host) *host = h;
+  if (port) *port = static_cast<uint16_t>(parsed);
+  return true;
+}
+
+std::unique_ptr<TcpTransport> TcpTransport::Connect(const std::string& host,
+                                                    uint16_t port,
+                                                    const TcpConnectOptions& options) {
+  if (!EnsureWinsock()) return nullptr;
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  addrinfo* addresses = nullptr;
+  std::string service = std::to_string(port);
+  if (getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0 || !addresses) {
+    return nullptr;
+  }
+  std::unique_ptr<TcpTransport> transport;
+  for (addrinfo* a = addresses; a && !transport; a = a->ai_next) {
+    NativeSocket s = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (static_cast<uintptr_t>(s) == kInvalidSocket) continue;
+    if (!ConnectWithTimeout(s, a->ai_addr, static_cast<int>(a->ai_addrlen),
+                            options.connect_timeout_ms)) {
+      CloseNative(s);
+      continue;
+    }
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    if (options.send_buffer_bytes > 0) {
+      int size = options.send_buffer_bytes;
+      setsockopt(s, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+    transport = std::make_unique<TcpTransport>(static_cast<uintptr_t>(s));
+    transport->SetNoDelay(options.no_delay);
+  }
+  freeaddrinfo(addresses);
+  return transport;
+}
+
+TcpTransport::TcpTransport(uintptr_t socket) : socket_(socket) {}
+
+TcpTransport::~TcpTransport() {
+  Close();
+}
+
+bool TcpTransport::Write(const uint8_t* data, size_t size) {
+  TransportBuffer buffer{data, size};
+  return WriteGather(&buffer, 1);
+}
+
+bool TcpTransport::WriteGather(const TransportBuffer* buffers, size_t count) {
+  if (socket_ == kInvalidSocket || failed_) return false;
+  // Skip what earlier partial sends already covered: [index] is the first
+  // unsent buffer and [offset] the bytes of it already sent.
+  size_t index = 0;
+  size_t offset = 0;
+  while (index < count && buffers[index].size == 0) index++;
+#ifdef _WIN32
+  std::vector<WSABUF> vec;
+#else
+  std::vector<iovec> vec;
+#endif
+  while (index < count) {
+    vec.clear();
+#ifdef _WIN32
+    const size_t max_segments = 1024;
+#else
+    const size_t max_segments = IOV_MAX;
+#endif
+    for (size_t i = index; i < count && vec.size() < max_segments; i++) {
+      if (buffers[i].size == 0) continue;
+      size_t skip = (i == index) ? offset : 0;
+#ifdef _WIN32
+      WSABUF b;
+      b.buf = reinterpret_cast<char*>(const_cast<uint8_t*>(buffers[i].data + skip));
+      b.len = static_cast<ULONG>(buffers[i].size - skip);
+#else
+      iovec b;
+      b.iov_base = const_cast<uint8_t*>(buffers[i].data + skip);
+      b.iov_len = buffers[i].size - skip;
+#endif
+      vec.push_back(b);
+    }
+    size_t sent = 0;
+#ifdef _WIN32
+    DWORD n = 0;
+    if (WSASend(Native(socket_), vec.data(), static_cast<DWORD>(vec.size()), &n, 0, nullptr,
+                nullptr) != 0) {
+      failed_ = true;
+      return false;
+    }
+    sent = n;
+#else
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec.data();
+    msg.msg_iovlen = vec.size();
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    ssize_t n = sendmsg(Native(socket_), &msg, flags);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      failed_ = true;
+      return false;
+    }
+    sent = static_cast<size_t>(n);
+#endif
+    // Advance past fully sent buffers; a short send resumes mid-buffer.
+    while (index < count && sent > 0) {
+      size_t left = buffers[index].size - offset;
+      if (sent < left) {
+        offset += sent;
+        sent = 0;
+      } else {
+        sent -= left;
+        index++;
+        offset = 0;
+      }
+    }
+    while (index < count && buffers[index].size == 0) index++;
+  }
+  return true;
+}
+
+bool TcpTransport::Flush() {
+  return socket_ != kInvalidSocket && !failed_;
+}
+
+int TcpTransport::Read(uint8_t* buffer, size_t capacity, int timeout_ms) {
+  if (socket_ == kInvalidSocket || failed_) return -1;
+  if (capacity == 0) return 0;
+  int ready = WaitSocket(Native(socket_), false, timeout_ms);
+  if (ready == 0) return 0;
+  if (ready < 0) {
+    failed_ = true;
+    return -1;
+  }
+  int n = static_cast<int>(
+      recv(Native(socket_), reinterpret_cast<char*>(buffer),
+           static_cast<int>(std::min<size_t>(capacity, 1 << 20)), 0));
+  if (n <= 0) {
+    // 0 = orderly close by the printer: no more replies will come.
+    failed_ = true;
+    return -1;
+  }
+  return n;
+}
+
+void TcpTransport::Close() {
+  if (socket_ == kInvalidSocket) return;
+  CloseNative(Native(socket_));
+  socket_ = kInvalidSocket;
+}
+
+bool TcpTransport::SetNoDelay(bool enabled) {
+  if (socket_ == kInvalidSocket) return false;
+  int value = enabled ? 1 : 0;
+  return setsockopt(Native(socket_), IPPROTO_TCP, TCP_NODELAY,
+                    reinterpret_cast<const char*>(&value), sizeof(value)) == 0;
+}
+
+void TcpTransport::Abort() {
+  if (socket_ == kInvalidSocket) return;
+#ifdef _WIN32
+  shutdown(Native(socket_), SD_BOTH);
+#else
+  shutdown(Native(socket_), SHUT_RDWR);
+#endif
+}
+
+bool TcpTransport::IsAlive() {
+  if (socket_ == kInvalidSocket || failed_) return false;
+  int ready = WaitSocket(Native(socket_), false, 0);
+  if (ready == 0) return true;
+  if (ready < 0) {
+    failed_ = true;
+    return false;
+  }
+  // Readable: either printer replies (alive) or EOF / reset (dead).
+  char probe;
+  int n = static_cast<int>(recv(Native(socket_), &probe, 1, MSG_PEEK));
+  if (n <= 0) failed_ = true;
+  return n > 0;
+}
+
+}  // namespace flutter_thermal_printer_windows
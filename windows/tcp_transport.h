@@ -0,0 +1,74 @@
+#ifndef FLUTTER_PLUGIN_TCP_TRANSPORT_H_
+#define FLUTTER_PLUGIN_TCP_TRANSPORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Raw print port (JetDirect / AppSocket) used by LAN thermal printers.
+constexpr uint16_t kRawPrintPort = 9100;
+
+/// Printer ids of the form "tcp:HOST" or "tcp:HOST:PORT" address LAN
+/// printers; HOST may be a name, an IPv4 address or a bracketed IPv6
+/// address ("tcp:[fe80::1]:9100"). Returns false for any other id.
+bool ParseTcpPrinterId(const std::string& id, std::string* host, uint16_t* port);
+
+struct TcpConnectOptions {
+  int connect_timeout_ms = 3000;
+  /// Disable Nagle so a short job or a status request goes out at once
+  /// instead of waiting for the previous segment's ACK.
+  bool no_delay = true;
+  /// SO_SNDBUF in bytes; 0 keeps the system default.
+  int send_buffer_bytes = 0;
+};
+
+/// Blocking TCP socket to a printer's raw port. Write and WriteGather send
+/// straight from the caller's buffers (one writev / WSASend per batch), so
+/// jobs are never concatenated into a staging buffer. Flush has nothing to
+/// push: the kernel sends as soon as data is written.
+///
+/// Same threading rule as PrinterTransport, except Abort(), which may be
+/// called from any thread to unblock a pending Write or Read.
+class TcpTransport : public PrinterTransport {
+ public:
+  /// Resolves [host] and connects to the first address that answers within
+  /// the timeout. Returns nullptr on failure.
+  static std::unique_ptr<TcpTransport> Connect(const std::string& host,
+                                               uint16_t port,
+                                               const TcpConnectOptions& options = TcpConnectOptions());
+
+  /// Takes ownership of an already connected socket (SOCKET or fd).
+  explicit TcpTransport(uintptr_t socket);
+  ~TcpTransport() override;
+
+  TcpTransport(const TcpTransport&) = delete;
+  TcpTransport& operator=(const TcpTransport&) = delete;
+
+  bool Write(const uint8_t* data, size_t size) override;
+  bool WriteGather(const TransportBuffer* buffers, size_t count) override;
+  bool Flush() override;
+  int Read(uint8_t* buffer, size_t capacity, int timeout_ms) override;
+  void Close() override;
+
+  bool SetNoDelay(bool enabled);
+
+  /// Shuts the socket down without closing it; blocked calls return an error.
+  void Abort();
+
+  /// False once an I/O error was seen or the printer closed its end.
+  /// Checks for a pending FIN/RST without consuming printer replies.
+  bool IsAlive() override;
+
+ private:
+  uintptr_t socket_;
+  bool failed_ = false;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TCP_TRANSPORT_H_
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "barcode_raster.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+bool DotAt(const BarcodeBitmap& bitmap, int x, int y) {
+  return (bitmap.bits[static_cast<size_t>(y) * bitmap.row_bytes + (x >> 3)] & (0x80 >> (x & 7))) != 0;
+}
+
+std::vector<uint8_t> Bits(const std::string& ones_and_zeros) {
+  std::vector<uint8_t> out;
+  for (char c : ones_and_zeros) out.push_back(c == '1' ? 1 : 0);
+  return out;
+}
+
+}  // namespace
+
+TEST(BarcodeRaster, Code128SwitchesCodeSets) {
+  std::vector<int> values;
+  ASSERT_TRUE(Code128Values("AB", &values));
+  EXPECT_EQ(values, (std::vector<int>{104, 33, 34, 102, 106}));
+
+  // Leading digits start in code set C.
+  ASSERT_TRUE(Code128Values("123456", &values));
+  EXPECT_EQ(values, (std::vector<int>{105, 12, 34, 56, 44, 106}));
+
+  // An odd trailing run keeps its first digit in code set B.
+  ASSERT_TRUE(Code128Values("AB1234567", &values));
+  EXPECT_EQ(values, (std::vector<int>{104, 33, 34, 17, 99, 23, 45, 67, 64, 106}));
+
+  // Control characters need code set A; a single one is shifted.
+  ASSERT_TRUE(Code128Values("A\tB", &values));
+  EXPECT_EQ(std::vector<int>(values.begin(), values.begin() + 4), (std::vector<int>{103, 33, 73, 34}));
+  ASSERT_TRUE(Code128Values("a\n", &values));
+  EXPECT_EQ(std::vector<int>(values.begin(), values.begin() + 4), (std::vector<int>{104, 65, 98, 74}));
+
+  EXPECT_FALSE(Code128Values("caf\xC3\xA9", &values));
+  EXPECT_FALSE(Code128Values("", &values));
+}
+
+TEST(BarcodeRaster, Code128ModulesUseTheSymbolPatterns) {
+  std::vector<uint8_t> modules;
+  ASSERT_TRUE(EncodeLinearModules(Symbology::kCode128, "AB", &modules));
+  ASSERT_EQ(modules.size(), 4u * 11 + 13);
+  EXPECT_EQ(std::vector<uint8_t>(modules.begin(), modules.begin() + 11), Bits("11010010000"));  // start B
+  EXPECT_EQ(std::vector<uint8_t>(modules.end() - 13, modules.end()), Bits("1100011101011"));   // stop
+}
+
+TEST(BarcodeRaster, EanAddsOrChecksTheCheckDigit) {
+  std::vector<uint8_t> appended;
+  std::vector<uint8_t> full;
+  ASSERT_TRUE(EncodeLinearModules(Symbology::kEan13, "400638133393", &appended));
+  ASSERT_TRUE(EncodeLinearModules(Symbology::kEan13, "4006381333931", &full));
+  EXPECT_EQ(appended, full);
+  ASSERT_EQ(full.size(), 95u);
+  EXPECT_EQ(std::vector<uint8_t>(full.begin(), full.begin() + 3), Bits("101"));
+  // Second digit 0 in odd parity, first right-hand digit 3.
+  EXPECT_EQ(std::vector<uint8_t>(full.begin() + 3, full.begin() + 10), Bits("0001101"));
+  EXPECT_EQ(std::vector<uint8_t>(full.begin() + 45, full.begin() + 50), Bits("01010"));
+  EXPECT_EQ(std::vector<uint8_t>(full.begin() + 50, full.begin() + 57), Bits("1000010"));
+  EXPECT_FALSE(EncodeLinearModules(Symbology::kEan13, "4006381333932", &full));
+  EXPECT_FALSE(EncodeLinearModules(Symbology::kEan13, "40063813339", &full));
+
+  ASSERT_TRUE(EncodeLinearModules(Symbology::kEan8, "9638507", &full));
+  EXPECT_EQ(full.size(), 67u);
+  EXPECT_TRUE(EncodeLinearModules(Symbology::kEan8, "96385074", &full));
+  EXPECT_FALSE(EncodeLinearModules(Symbology::kCode39, "CODE39", &full));
+}
+
+TEST(BarcodeRaster, RastersAreModuleAlignedAndFitTheHead) {
+  BarcodeSpec spec;
+  spec.symbology = Symbology::kQrCode;
+  spec.data = "HELLO WORLD";
+  BarcodeBitmap bitmap;
+  ASSERT_TRUE(RasterizeBarcode(spec, &bitmap));
+  EXPECT_EQ(bitmap.module_dots, 4);
+  EXPECT_EQ(bitmap.width, (21 + 8) * 4);
+  EXPECT_EQ(bitmap.height, bitmap.width);
+  EXPECT_FALSE(DotAt(bitmap, 15, 15));  // quiet zone
+  EXPECT_TRUE(DotAt(bitmap, 16, 16));   // finder corner
+  EXPECT_TRUE(DotAt(bitmap, 19, 19));
+  EXPECT_FALSE(DotAt(bitmap, 20, 20));  // finder's light ring
+
+  spec.max_width_dots = 100;
+  ASSERT_TRUE(RasterizeBarcode(spec, &bitmap));
+  EXPECT_EQ(bitmap.module_dots, 3);
+  EXPECT_EQ(bitmap.width, 29 * 3);
+
+  spec.symbology = Symbology::kCode128;
+  spec.data = "AB";
+  spec.max_width_dots = 0;
+  spec.height_dots = 40;
+  ASSERT_TRUE(RasterizeBarcode(spec, &bitmap));
+  EXPECT_EQ(bitmap.width, (57 + 20) * 3);
+  EXPECT_EQ(bitmap.height, 40);
+  EXPECT_FALSE(DotAt(bitmap, 29, 39));
+  EXPECT_TRUE(DotAt(bitmap, 30, 39));  // first bar, two modules wide
+  EXPECT_TRUE(DotAt(bitmap, 35, 0));
+  EXPECT_FALSE(DotAt(bitmap, 36, 0));
+
+  spec.max_width_dots = 50;  // not even one dot per module
+  EXPECT_FALSE(RasterizeBarcode(spec, &bitmap));
+  spec.symbology = Symbology::kCode39;
+  spec.max_width_dots = 0;
+  EXPECT_FALSE(RasterizeBarcode(spec, &bitmap));
+}
+
+TEST(BarcodeRaster, PrinterCommandsCarryTheSettings) {
+  BarcodeSpec spec;
+  spec.symbology = Symbology::kCode128;
+  spec.data = "A{B";
+  std::vector<uint8_t> out;
+  ASSERT_TRUE(EncodeBarcodeCommands(spec, &out));
+  EXPECT_EQ(out, (std::vector<uint8_t>{0x1D, 0x68, 162, 0x1D, 0x6B, 73, 6, '{', 'B', 'A', '{', '{', 'B'}));
+
+  spec.data = std::string(300, 'x');
+  EXPECT_FALSE(EncodeBarcodeCommands(spec, &out));
+
+  spec.symbology = Symbology::kQrCode;
+  spec.data = "hi";
+  spec.error_correction = QrErrorCorrection::kHigh;
+  ASSERT_TRUE(EncodeBarcodeCommands(spec, &out));
+  const std::vector<uint8_t> level = {0x1D, 0x28, 0x6B, 3, 0, 49, 69, 51};
+  const std::vector<uint8_t> store = {0x1D, 0x28, 0x6B, 5, 0, 49, 80, 48, 'h', 'i'};
+  EXPECT_NE(std::search(out.begin(), out.end(), level.begin(), level.end()), out.end());
+  EXPECT_NE(std::search(out.begin(), out.end(), store.begin(), store.end()), out.end());
+}
+
+TEST(BarcodeRaster, AutoRenderingFollowsCapabilities) {
+  BarcodeSpec spec;
+  spec.symbology = Symbology::kQrCode;
+  spec.data = "https://example.com";
+  RegisteredPrinter unknown;
+  RegisteredPrinter known;
+  known.supports_barcode_commands = true;
+  EXPECT_EQ(ChooseBarcodeRendering(spec, unknown, BarcodeRendering::kAuto), BarcodeRendering::kRaster);
+  EXPECT_EQ(ChooseBarcodeRendering(spec, known, BarcodeRendering::kAuto), BarcodeRendering::kPrinterCommands);
+  EXPECT_EQ(ChooseBarcodeRendering(spec, known, BarcodeRendering::kRaster), BarcodeRendering::kRaster);
+
+  // Code 128 longer than GS k takes is rasterized even on capable printers.
+  spec.symbology = Symbology::kCode128;
+  spec.data = std::string(300, '7');
+  EXPECT_EQ(ChooseBarcodeRendering(spec, known, BarcodeRendering::kAuto), BarcodeRendering::kRaster);
+
+  spec.symbology = Symbology::kCode39;
+  spec.data = "CODE39";
+  EXPECT_EQ(ChooseBarcodeRendering(spec, unknown, BarcodeRendering::kAuto), BarcodeRendering::kPrinterCommands);
+}
+
+TEST(BarcodeRaster, CacheReusesBitmapsAndEvictsTheOldest) {
+  BarcodeBitmapCache cache(8 * 1024);
+  BarcodeSpec spec;
+  spec.symbology = Symbology::kQrCode;
+  spec.data = "table 12";
+  bool hit = true;
+  auto first = cache.Get(spec, &hit);
+  ASSERT_NE(first, nullptr);
+  EXPECT_FALSE(hit);
+  auto second = cache.Get(spec, &hit);
+  EXPECT_TRUE(hit);
+  EXPECT_EQ(first.get(), second.get());
+
+  // Other content or settings render again.
+  spec.error_correction = QrErrorCorrection::kHigh;
+  EXPECT_NE(cache.Get(spec, &hit).get(), first.get());
+  EXPECT_FALSE(hit);
+  EXPECT_EQ(cache.entries(), 2u);
+
+  for (int i = 0; i < 20; i++) {
+    spec.data = "table " + std::to_string(i);
+    cache.Get(spec);
+  }
+  EXPECT_LE(cache.bytes(), 8u * 1024);
+  spec.data = "table 12";
+  spec.error_correction = QrErrorCorrection::kMedium;
+  cache.Get(spec, &hit);
+  EXPECT_FALSE(hit);
+
+  spec.symbology = Symbology::kCode39;
+  EXPECT_EQ(cache.Get(spec), nullptr);
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <future>
+#include <memory>
+#include <string>
+
+#include "bluetooth_winrt.h"
+#include "fake_bluetooth.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+// Runs against fake_bluetooth.cpp, which follows bluetooth_winrt.cpp's
+// rules for keeping and replacing connections.
+
+namespace {
+
+bool ConnectAndWait(const std::string& id) {
+  auto done = std::make_shared<std::promise<bool>>();
+  auto future = done->get_future();
+  BluetoothConnectAsync(id, [done](bool ok) { done->set_value(ok); });
+  return future.get();
+}
+
+}  // namespace
+
+TEST(BluetoothConnect, KeepsLiveConnectionAndReplacesDroppedOne) {
+  const std::string id = FakeBluetoothDeviceId(3);
+  ASSERT_TRUE(ConnectAndWait(id));
+  const uint64_t opened = FakeBluetoothLinksOpened();
+
+  // The app's connect after a startup reconnect keeps the open link.
+  EXPECT_TRUE(ConnectAndWait(id));
+  EXPECT_TRUE(BluetoothConnect(id));
+  EXPECT_EQ(FakeBluetoothLinksOpened(), opened);
+  EXPECT_TRUE(BluetoothIsConnected(id));
+
+  FakeBluetoothDropLink(id);
+  const uint8_t job[] = {0x1B, 0x40};
+  EXPECT_FALSE(BluetoothSend(id, job, sizeof(job)));
+  ASSERT_TRUE(ConnectAndWait(id));
+  EXPECT_EQ(FakeBluetoothLinksOpened(), opened + 1);
+  EXPECT_TRUE(BluetoothSend(id, job, sizeof(job)));
+
+  BluetoothDisconnect(id);
+  EXPECT_FALSE(BluetoothIsConnected(id));
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
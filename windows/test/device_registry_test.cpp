@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "device_registry.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+std::string TempRegistryPath(const char* name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+}  // namespace
+
+TEST(DeviceRegistry, SaveAndLoadRoundTrip) {
+  std::string path = TempRegistryPath("ftpw_registry_roundtrip.ini");
+  std::remove(path.c_str());
+
+  DeviceRegistry registry;
+  registry.SetPath(path);
+  RegisteredPrinter printer;
+  printer.device_id = "Bluetooth#Bluetooth00:11:22:33:44:55-aa:bb:cc:dd:ee:ff#RFCOMM:0:{x}";
+  printer.host_name = "(AA:BB:CC:DD:EE:FF)";
+  printer.service_name = "Bluetooth#Bluetooth00:11:22:33:44:55-aa:bb:cc:dd:ee:ff#RFCOMM:0:{x}";
+  printer.paper_width_mm = 80;
+  printer.supports_partial_cut = true;
+  printer.capabilities_probed = true;
+  printer.model_name = "TM-T20II";
+  printer.manufacturer = "EPSON";
+  printer.dots_per_line = 576;
+  printer.supports_raster = false;
+  printer.supports_barcode_commands = true;
+  printer.supports_status = true;
+  printer.write_chunk_size = 512;
+  printer.last_connect_ms = 1234;
+  printer.auto_reconnect = false;
+  registry.Upsert(printer);
+  ASSERT_TRUE(registry.Save());
+
+  DeviceRegistry loaded;
+  loaded.SetPath(path);
+  ASSERT_TRUE(loaded.Load());
+  RegisteredPrinter out;
+  ASSERT_TRUE(loaded.Find(printer.device_id, &out));
+  EXPECT_EQ(out.host_name, printer.host_name);
+  EXPECT_EQ(out.service_name, printer.service_name);
+  EXPECT_EQ(out.paper_width_mm, 80);
+  EXPECT_TRUE(out.supports_cutting);
+  EXPECT_TRUE(out.supports_partial_cut);
+  EXPECT_TRUE(out.capabilities_probed);
+  EXPECT_EQ(out.model_name, "TM-T20II");
+  EXPECT_EQ(out.manufacturer, "EPSON");
+  EXPECT_TRUE(out.firmware_version.empty());
+  EXPECT_EQ(out.dots_per_line, 576);
+  EXPECT_FALSE(out.supports_raster);
+  EXPECT_TRUE(out.supports_barcode_commands);
+  EXPECT_TRUE(out.supports_status);
+  EXPECT_EQ(out.write_chunk_size, 512u);
+  EXPECT_EQ(out.last_connect_ms, 1234);
+  EXPECT_FALSE(out.auto_reconnect);
+  std::remove(path.c_str());
+}
+
+TEST(DeviceRegistry, UpsertReplacesAndRemoveDeletes) {
+  DeviceRegistry registry;
+  RegisteredPrinter printer;
+  printer.device_id = "dev-1";
+  printer.paper_width_mm = 58;
+  registry.Upsert(printer);
+  printer.paper_width_mm = 80;
+  registry.Upsert(printer);
+  ASSERT_EQ(registry.All().size(), 1u);
+  EXPECT_EQ(registry.All()[0].paper_width_mm, 80);
+  registry.Remove("dev-1");
+  EXPECT_TRUE(registry.All().empty());
+}
+
+TEST(DeviceRegistry, UpdateKeepsConcurrentFieldChanges) {
+  DeviceRegistry registry;
+  EXPECT_FALSE(registry.Update("dev-1", [](RegisteredPrinter&, bool) { FAIL(); }, /*create=*/false));
+
+  // One thread records connections while another records capabilities, as
+  // the Bluetooth worker and a probe callback do.
+  std::thread connects([&registry]() {
+    for (int i = 1; i <= 2000; i++) {
+      registry.Update("dev-1", [i](RegisteredPrinter& p, bool) { p.last_connect_ms = i; });
+    }
+  });
+  std::thread probes([&registry]() {
+    for (int i = 1; i <= 2000; i++) {
+      registry.Update("dev-1", [i](RegisteredPrinter& p, bool) { p.dots_per_line = i; });
+    }
+  });
+  connects.join();
+  probes.join();
+
+  RegisteredPrinter out;
+  ASSERT_TRUE(registry.Find("dev-1", &out));
+  EXPECT_EQ(out.last_connect_ms, 2000);
+  EXPECT_EQ(out.dots_per_line, 2000);
+  EXPECT_EQ(registry.All().size(), 1u);
+
+  bool existed = false;
+  registry.Update("dev-1", [&existed](RegisteredPrinter&, bool e) { existed = e; });
+  EXPECT_TRUE(existed);
+}
+
+TEST(DeviceRegistry, SaveReplacesTheExistingFile) {
+  std::string path = TempRegistryPath("ftpw_registry_replace.ini");
+  std::remove(path.c_str());
+  DeviceRegistry registry;
+  registry.SetPath(path);
+  registry.Update("dev-1", [](RegisteredPrinter& p, bool) { p.paper_width_mm = 58; });
+  ASSERT_TRUE(registry.Save());
+  registry.Update("dev-1", [](RegisteredPrinter& p, bool) { p.paper_width_mm = 80; });
+  ASSERT_TRUE(registry.Save());
+  EXPECT_FALSE(std::filesystem::exists(path + ".tmp"));
+
+  DeviceRegistry loaded;
+  loaded.SetPath(path);
+  ASSERT_TRUE(loaded.Load());
+  ASSERT_EQ(loaded.All().size(), 1u);
+  EXPECT_EQ(loaded.All()[0].paper_width_mm, 80);
+  std::remove(path.c_str());
+}
+
+TEST(DeviceRegistry, MissingFileLoadsEmpty) {
+  DeviceRegistry registry;
+  registry.SetPath(TempRegistryPath("ftpw_registry_does_not_exist.ini"));
+  EXPECT_FALSE(registry.Load());
+  EXPECT_TRUE(registry.All().empty());
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "escpos_optimizer.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes Cat(std::initializer_list<Bytes> parts) {
+  Bytes out;
+  for (const auto& p : parts) out.insert(out.end(), p.begin(), p.end());
+  return out;
+}
+
+Bytes Text(const std::string& s) { return Bytes(s.begin(), s.end()); }
+
+Bytes Optimize(const Bytes& in, EscPosOptimizeStats* stats = nullptr) {
+  return OptimizeEscPos(in.data(), in.size(), stats);
+}
+
+/// Minimal printer model: what gets printed, with the modes in effect.
+/// Used to check that optimisation never changes output.
+std::vector<std::string> Render(const Bytes& in, int initial_state) {
+  int bold = initial_state & 1;
+  int underline = (initial_state >> 1) & 3;
+  int align = (initial_state >> 3) & 3;
+  int size = (initial_state >> 5) & 1 ? 0x11 : 0;
+  std::vector<std::string> events;
+  auto modes = [&]() {
+    return std::to_string(bold) + "/" + std::to_string(underline) + "/" +
+           std::to_string(align) + "/" + std::to_string(size);
+  };
+  size_t i = 0;
+  while (i < in.size()) {
+    uint8_t b = in[i];
+    if (b >= 0x20) {
+      events.push_back(std::string("T") + static_cast<char>(b) + modes());
+      i++;
+    } else if (b == 0x0A) {
+      events.push_back("F" + std::to_string(size));
+      i++;
+    } else if (b == 0x1B && in[i + 1] == '@') {
+      bold = underline = align = size = 0;
+      i += 2;
+    } else if (b == 0x1B && in[i + 1] == 'E') {
+      bold = in[i + 2] & 1;
+      i += 3;
+    } else if (b == 0x1B && (in[i + 1] == '-' || in[i + 1] == 'a')) {
+      int v = in[i + 2] >= '0' ? in[i + 2] - '0' : in[i + 2];
+      (in[i + 1] == '-' ? underline : align) = v;
+      i += 3;
+    } else if (b == 0x1B && in[i + 1] == '!') {
+      bold = (in[i + 2] >> 3) & 1;
+      underline = (in[i + 2] >> 7) & 1;
+      size = 0x100 | in[i + 2];
+      i += 3;
+    } else if (b == 0x1B && in[i + 1] == 'd') {
+      for (int n = 0; n < in[i + 2]; n++) events.push_back("F" + std::to_string(size));
+      i += 3;
+    } else if (b == 0x1D && in[i + 1] == '!') {
+      size = in[i + 2];
+      i += 3;
+    } else if (b == 0x1D && in[i + 1] == 'v') {
+      size_t len = 8 + (in[i + 4] | (in[i + 5] << 8)) * (in[i + 6] | (in[i + 7] << 8));
+      events.push_back("I" + std::to_string(align) + std::string(in.begin() + i + 8, in.begin() + i + len));
+      i += len;
+    } else if (b == 0x1D && in[i + 1] == 'k') {
+      events.push_back("B" + modes() + std::string(in.begin() + i + 4, in.begin() + i + 4 + in[i + 3]));
+      i += 4 + in[i + 3];
+    } else {
+      // Other fixed 3-byte commands in the vocabulary (ESC t, GS V).
+      events.push_back("R" + std::string(in.begin() + i, in.begin() + i + 3));
+      i += 3;
+    }
+  }
+  return events;
+}
+
+Bytes RandomJob(std::mt19937& rng) {
+  const std::vector<Bytes> vocabulary = {
+      {0x1B, '@'},
+      {0x1B, 'E', 0}, {0x1B, 'E', 1},
+      {0x1B, '-', 0}, {0x1B, '-', 1}, {0x1B, '-', '2'},
+      {0x1B, 'a', 0}, {0x1B, 'a', 1}, {0x1B, 'a', '2'},
+      {0x1D, '!', 0}, {0x1D, '!', 0x11},
+      {0x1B, '!', 0x08}, {0x1B, '!', 0x00},
+      {0x1B, 'd', 0}, {0x1B, 'd', 1}, {0x1B, 'd', 3},
+      {0x0A},
+      Text("ab"), Text("Total"),
+      {0x1D, 'v', '0', 0, 1, 0, 2, 0, 0xAA, 0x55},
+      {0x1D, 'V', 0},
+      {0x1B, 't', 2},
+      {0x1D, 'k', 73, 3, '1', '2', '3'},
+  };
+  std::uniform_int_distribution<size_t> pick(0, vocabulary.size() - 1);
+  std::uniform_int_distribution<int> length(1, 40);
+  Bytes job;
+  int n = length(rng);
+  for (int k = 0; k < n; k++) {
+    const Bytes& cmd = vocabulary[pick(rng)];
+    job.insert(job.end(), cmd.begin(), cmd.end());
+  }
+  return job;
+}
+
+}  // namespace
+
+TEST(EscPosOptimizer, DropsRepeatedStyleBetweenItems) {
+  const Bytes style = {0x1B, 'E', 0, 0x1B, '-', 0, 0x1D, '!', 0, 0x1B, 'a', 0};
+  Bytes job = Cat({{0x1B, '@'}, style, Text("A"), {0x0A}, style, Text("B"), {0x0A}});
+  EscPosOptimizeStats stats;
+  Bytes out = Optimize(job, &stats);
+  EXPECT_EQ(out, Cat({{0x1B, '@'}, style, Text("A"), {0x0A}, Text("B"), {0x0A}}));
+  EXPECT_EQ(stats.removed_mode_changes, 4u);
+  EXPECT_EQ(stats.input_bytes, job.size());
+  EXPECT_EQ(stats.output_bytes, out.size());
+}
+
+TEST(EscPosOptimizer, DropsAlignmentToggledAroundNothing) {
+  // Header pattern: centre, text, back to left; then centre again for the footer.
+  Bytes job = Cat({{0x1B, 'a', 1}, Text("Head"), {0x0A}, {0x1B, 'a', 0}, {0x1B, 'a', 1},
+                   Text("Foot"), {0x0A}});
+  EXPECT_EQ(Optimize(job), Cat({{0x1B, 'a', 1}, Text("Head"), {0x0A}, Text("Foot"), {0x0A}}));
+}
+
+TEST(EscPosOptimizer, MergesAdjacentFeeds) {
+  Bytes job = Cat({Text("x"), {0x0A}, {0x1B, 'd', 1}, {0x1B, 'd', 2}, {0x1B, 'd', 0},
+                   {0x1D, 'V', 0}});
+  EscPosOptimizeStats stats;
+  EXPECT_EQ(Optimize(job, &stats), Cat({Text("x"), {0x0A}, {0x1B, 'd', 3}, {0x1D, 'V', 0}}));
+  EXPECT_EQ(stats.merged_feeds, 2u);
+
+  // A mode change between feeds stays between them.
+  job = Cat({{0x1B, 'd', 1}, {0x1B, 'E', 1}, {0x1B, 'd', 2}});
+  EXPECT_EQ(Optimize(job), job);
+}
+
+TEST(EscPosOptimizer, ModeChangesDoNotMoveAcrossLineBreaks) {
+  // Some firmware applies ESC a to the line it arrives on, so one sent
+  // before a line break must go out before it.
+  Bytes job = Cat({Text("left"), {0x1B, 'a', 1}, {0x0A}, Text("centre"), {0x0A}});
+  EXPECT_EQ(Optimize(job), job);
+  job = Cat({{0x1B, 'E', 1}, {0x1B, '-', 1}, {0x0A}, {0x0A}, Text("x")});
+  EXPECT_EQ(Optimize(job), job);
+}
+
+TEST(EscPosOptimizer, KeepsUnknownCommandsAndTailVerbatim) {
+  Bytes job = Cat({{0x1B, 'E', 1}, {0x1B, 'E', 1}, {0x1B, 0x7E, 0x01, 0x1B, 'E', 1}, Text("z")});
+  Bytes out = Optimize(job);
+  EXPECT_EQ(out, Cat({{0x1B, 'E', 1}, {0x1B, 0x7E, 0x01, 0x1B, 'E', 1}, Text("z")}));
+
+  Bytes truncated = {0x1D, 'v', '0', 0, 10, 0, 10};
+  EXPECT_EQ(Optimize(truncated), truncated);
+}
+
+TEST(EscPosOptimizer, NeverChangesRenderedOutput) {
+  std::mt19937 rng(1234);
+  for (int iteration = 0; iteration < 2000; iteration++) {
+    Bytes job = RandomJob(rng);
+    Bytes out = Optimize(job);
+    ASSERT_LE(out.size(), job.size());
+    for (int initial = 0; initial < 64; initial += 13) {
+      ASSERT_EQ(Render(job, initial), Render(out, initial)) << "iteration " << iteration;
+    }
+    ASSERT_EQ(Optimize(out), out);
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -4,9 +4,11 @@
 #include <gtest/gtest.h>
 #include <windows.h>
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "flutter_thermal_printer_windows_plugin.h"
 
@@ -39,5 +41,27 @@ TEST(FlutterThermalPrinterWindowsPlugin, GetPlatformVersion) {
   EXPECT_TRUE(result_string.rfind("Windows ", 0) == 0);
 }
 
+TEST(FlutterThermalPrinterWindowsPlugin, PrintImageRejectsUnknownPixelFormats) {
+  FlutterThermalPrinterWindowsPlugin plugin;
+  EncodableMap printer = {{EncodableValue("id"), EncodableValue("tcp:127.0.0.1")}};
+  EncodableMap args = {
+      {EncodableValue("printer"), EncodableValue(printer)},
+      {EncodableValue("pixels"), EncodableValue(std::vector<uint8_t>(4))},
+      {EncodableValue("width"), EncodableValue(2)},
+      {EncodableValue("height"), EncodableValue(2)},
+      {EncodableValue("format"), EncodableValue(5)},
+  };
+  std::string error_code;
+  plugin.HandleMethodCall(
+      MethodCall("printImage", std::make_unique<EncodableValue>(args)),
+      std::make_unique<MethodResultFunctions<>>(
+          nullptr,
+          [&error_code](const std::string& code, const std::string&, const EncodableValue*) {
+            error_code = code;
+          },
+          nullptr));
+  EXPECT_EQ(error_code, "InvalidArguments");
+}
+
 }  // namespace test
 }  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "image_resample.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+std::vector<uint8_t> Resample(const RasterImageSource& source, int out_w, int out_h, bool simd) {
+  LumaResampler resampler(source, out_w, out_h, simd);
+  std::vector<uint8_t> out(static_cast<size_t>(out_w) * out_h);
+  for (int y = 0; y < out_h; y++) resampler.Row(y, out.data() + static_cast<size_t>(y) * out_w);
+  return out;
+}
+
+RasterImageSource GraySource(const std::vector<uint8_t>& pixels, int width, int height,
+                             ResampleFilter filter) {
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = width;
+  source.height = height;
+  source.filter = filter;
+  return source;
+}
+
+}  // namespace
+
+TEST(ImageResample, SimdLumaMatchesScalar) {
+  std::mt19937 rng(7);
+  std::vector<uint8_t> rgba(4 * 1003);
+  for (auto& b : rgba) b = static_cast<uint8_t>(rng());
+  // Every alpha/luma corner case lands in the SIMD body at least once.
+  for (int i = 0; i < 256; i++) {
+    rgba[i * 4] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = static_cast<uint8_t>(i);
+    rgba[i * 4 + 3] = static_cast<uint8_t>(255 - i);
+  }
+  std::vector<uint8_t> simd(1003);
+  std::vector<uint8_t> scalar(1003);
+  RgbaToLuma(rgba.data(), 1003, simd.data(), true);
+  RgbaToLuma(rgba.data(), 1003, scalar.data(), false);
+  EXPECT_EQ(simd, scalar);
+  // Opaque white and fully transparent both stay white; opaque black is black.
+  const uint8_t px[] = {255, 255, 255, 255, 0, 0, 0, 0, 0, 0, 0, 255};
+  uint8_t luma[3];
+  RgbaToLuma(px, 3, luma, false);
+  EXPECT_EQ(luma[0], 255);
+  EXPECT_EQ(luma[1], 255);
+  EXPECT_EQ(luma[2], 0);
+}
+
+TEST(ImageResample, SimdKernelsMatchScalarForEveryFilter) {
+  std::mt19937 rng(11);
+  const int sizes[][4] = {{640, 480, 384, 288}, {37, 23, 576, 358}, {1001, 7, 384, 3}, {5, 900, 8, 1440}};
+  const ResampleFilter filters[] = {ResampleFilter::kAuto, ResampleFilter::kNearest,
+                                    ResampleFilter::kBilinear, ResampleFilter::kArea};
+  for (const auto& size : sizes) {
+    for (SourcePixelFormat format : {SourcePixelFormat::kGray8, SourcePixelFormat::kRgba8888}) {
+      const int bpp = format == SourcePixelFormat::kRgba8888 ? 4 : 1;
+      std::vector<uint8_t> pixels(static_cast<size_t>(size[0]) * size[1] * bpp);
+      for (auto& b : pixels) b = static_cast<uint8_t>(rng());
+      for (ResampleFilter filter : filters) {
+        RasterImageSource source = GraySource(pixels, size[0], size[1], filter);
+        source.format = format;
+        EXPECT_EQ(Resample(source, size[2], size[3], true), Resample(source, size[2], size[3], false))
+            << size[0] << "x" << size[1] << " filter " << static_cast<int>(filter);
+      }
+    }
+  }
+}
+
+TEST(ImageResample, AreaAveragesEachFootprint) {
+  // 4x2 -> 2x1: each output dot is the mean of a 2x2 block.
+  const std::vector<uint8_t> pixels = {0, 100, 10, 20,
+                                       50, 250, 30, 40};
+  auto out = Resample(GraySource(pixels, 4, 2, ResampleFilter::kArea), 2, 1, true);
+  EXPECT_EQ(out, (std::vector<uint8_t>{100, 25}));
+  // 3 -> 2 splits the middle pixel: (2*0 + 1*90) / 3 and (1*90 + 2*180) / 3.
+  const std::vector<uint8_t> row = {0, 90, 180};
+  out = Resample(GraySource(row, 3, 1, ResampleFilter::kArea), 2, 1, true);
+  EXPECT_EQ(out, (std::vector<uint8_t>{30, 150}));
+}
+
+TEST(ImageResample, SameSizeIsIdentityForEveryFilter) {
+  std::mt19937 rng(3);
+  std::vector<uint8_t> pixels(29 * 13);
+  for (auto& b : pixels) b = static_cast<uint8_t>(rng());
+  for (ResampleFilter filter : {ResampleFilter::kAuto, ResampleFilter::kNearest,
+                                ResampleFilter::kBilinear, ResampleFilter::kArea}) {
+    EXPECT_EQ(Resample(GraySource(pixels, 29, 13, filter), 29, 13, true), pixels);
+  }
+}
+
+TEST(ImageResample, BilinearInterpolatesBetweenCentres) {
+  // 2 -> 4: output centres fall at source 0.25 and 0.75 past the first, clamped at the edges.
+  const std::vector<uint8_t> row = {0, 200};
+  auto out = Resample(GraySource(row, 2, 1, ResampleFilter::kBilinear), 4, 1, true);
+  EXPECT_EQ(out, (std::vector<uint8_t>{0, 50, 150, 200}));
+  // A flat image stays flat when enlarged.
+  const std::vector<uint8_t> flat(3 * 3, 77);
+  out = Resample(GraySource(flat, 3, 3, ResampleFilter::kAuto), 17, 17, true);
+  EXPECT_EQ(out, std::vector<uint8_t>(17 * 17, 77));
+}
+
+TEST(ImageResample, HonoursRowStride) {
+  // 2x2 gray with 3 bytes of padding per row.
+  const std::vector<uint8_t> pixels = {10, 30, 9, 9, 9,
+                                       50, 70, 9, 9, 9};
+  RasterImageSource source = GraySource(pixels, 2, 2, ResampleFilter::kArea);
+  source.stride = 5;
+  EXPECT_EQ(Resample(source, 1, 1, true), (std::vector<uint8_t>{40}));
+}
+
+TEST(ImageResample, UnknownFormatsReadAsGray) {
+  const std::vector<uint8_t> pixels = {10, 30, 50, 70};
+  RasterImageSource source = GraySource(pixels, 2, 2, ResampleFilter::kArea);
+  source.format = static_cast<SourcePixelFormat>(7);
+  EXPECT_EQ(Resample(source, 1, 1, true), (std::vector<uint8_t>{40}));
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
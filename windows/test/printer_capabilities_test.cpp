@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "fake_printer_transport.h"
+#include "printer_capabilities.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+TEST(PrinterCapabilities, ProbeReadsIdsAndExtendedNames) {
+  FakePrinterOptions options;
+  options.id_reply = {0x02};
+  options.model_name = "TM-T20II";
+  options.manufacturer = "EPSON";
+  options.firmware_version = "1.01 ESC/POS";
+  FakePrinterTransport printer(options);
+
+  PrinterIdentity identity;
+  ASSERT_TRUE(ProbePrinterIdentity(&printer, 1000, &identity));
+  EXPECT_TRUE(identity.answered);
+  EXPECT_EQ(identity.model_id, 0x02);
+  EXPECT_EQ(identity.type_id, 0x02);
+  EXPECT_EQ(identity.model_name, "TM-T20II");
+  EXPECT_EQ(identity.manufacturer, "EPSON");
+  EXPECT_EQ(identity.firmware_version, "1.01 ESC/POS");
+  EXPECT_TRUE(identity.supports_status);
+}
+
+TEST(PrinterCapabilities, PrinterWithoutExtendedIdsKeepsBasicAnswers) {
+  FakePrinterOptions options;
+  options.model_name.clear();
+  options.manufacturer.clear();
+  options.firmware_version.clear();
+  FakePrinterTransport printer(options);
+
+  PrinterIdentity identity;
+  ASSERT_TRUE(ProbePrinterIdentity(&printer, 10, &identity));
+  EXPECT_TRUE(identity.answered);
+  EXPECT_TRUE(identity.model_name.empty());
+  EXPECT_TRUE(identity.supports_status);
+
+  // Without a model name the type id is not trusted.
+  RegisteredPrinter record;
+  ApplyPrinterIdentity(identity, &record);
+  EXPECT_TRUE(record.capabilities_probed);
+  EXPECT_TRUE(record.supports_cutting);
+  EXPECT_EQ(record.write_chunk_size, 0u);
+}
+
+TEST(PrinterCapabilities, SilentPrinterIsProbedWithDefaults) {
+  FakePrinterOptions options;
+  options.id_reply.clear();
+  options.status_reply.clear();
+  FakePrinterTransport printer(options);
+
+  PrinterIdentity identity;
+  ASSERT_TRUE(ProbePrinterIdentity(&printer, 10, &identity));
+  EXPECT_FALSE(identity.answered);
+  EXPECT_FALSE(identity.supports_status);
+
+  RegisteredPrinter record;
+  ApplyPrinterIdentity(identity, &record);
+  EXPECT_TRUE(record.capabilities_probed);
+  EXPECT_EQ(record.paper_width_mm, 58);
+  EXPECT_EQ(record.dots_per_line, 0);
+  EXPECT_TRUE(record.supports_raster);
+  EXPECT_FALSE(record.supports_barcode_commands);
+}
+
+TEST(PrinterCapabilities, ClosedTransportFails) {
+  FakePrinterTransport printer;
+  printer.Close();
+  PrinterIdentity identity;
+  EXPECT_FALSE(ProbePrinterIdentity(&printer, 10, &identity));
+}
+
+TEST(PrinterCapabilities, KnownModelsTakeTheirProfile) {
+  ASSERT_NE(FindPrinterModelProfile("TM-T88VI"), nullptr);
+  EXPECT_EQ(FindPrinterModelProfile("TM-T88VI")->dots_per_line, 512);
+  EXPECT_EQ(FindPrinterModelProfile("XP-58"), nullptr);
+  EXPECT_EQ(FindPrinterModelProfile(""), nullptr);
+
+  PrinterIdentity identity;
+  identity.answered = true;
+  identity.model_name = "TM-m30II";
+  identity.type_id = 0x00;
+  RegisteredPrinter record;
+  record.last_connect_ms = 42;
+  ApplyPrinterIdentity(identity, &record);
+  EXPECT_EQ(record.model_name, "TM-m30II");
+  EXPECT_EQ(record.paper_width_mm, 80);
+  EXPECT_EQ(record.dots_per_line, 576);
+  EXPECT_TRUE(record.supports_cutting);
+  EXPECT_TRUE(record.supports_partial_cut);
+  EXPECT_EQ(record.write_chunk_size, 4096u);
+  EXPECT_TRUE(record.supports_barcode_commands);
+  EXPECT_EQ(record.last_connect_ms, 42);
+
+  // Unknown models with full GS I support report their cutter themselves.
+  identity.model_name = "XP-58IIH";
+  identity.type_id = 0x00;
+  RegisteredPrinter other;
+  ApplyPrinterIdentity(identity, &other);
+  EXPECT_FALSE(other.supports_cutting);
+  EXPECT_FALSE(other.supports_barcode_commands);
+  EXPECT_EQ(other.paper_width_mm, 58);
+}
+
+TEST(PrinterCapabilities, ImagesFitTheHead) {
+  // Not probed: the head of the paper width.
+  RegisteredPrinter fresh;
+  EXPECT_EQ(ImageTargetWidth(fresh, 0), 384);
+  EXPECT_EQ(ImageTargetWidth(fresh, 1000), 384);
+  EXPECT_EQ(ImageTargetWidth(fresh, 200), 200);
+  fresh.paper_width_mm = 80;
+  EXPECT_EQ(ImageTargetWidth(fresh, 0), 576);
+
+  RegisteredPrinter probed;
+  probed.paper_width_mm = 80;
+  probed.dots_per_line = 512;
+  EXPECT_EQ(PrintableWidthDots(probed), 512);
+  EXPECT_EQ(ImageTargetWidth(probed, 0), 512);
+  EXPECT_EQ(ImageTargetWidth(probed, 576), 512);
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "printer_job_queue.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+TEST(PrinterJobQueue, RunsOnePrintersJobsInOrderWithoutOverlap) {
+  std::mutex mutex;
+  std::vector<int> order;
+  std::atomic<int> running{0};
+  std::atomic<bool> overlapped{false};
+  {
+    PrinterJobQueue queue(4);
+    for (int i = 0; i < 20; i++) {
+      queue.Post("printer-a", [&, i]() {
+        if (running.fetch_add(1) != 0) overlapped = true;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          order.push_back(i);
+        }
+        running.fetch_sub(1);
+      });
+    }
+  }  // waits for the jobs
+  EXPECT_FALSE(overlapped);
+  ASSERT_EQ(order.size(), 20u);
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST(PrinterJobQueue, BoundsThreadsAcrossPrinters) {
+  std::atomic<int> running{0};
+  std::atomic<int> peak{0};
+  std::atomic<int> finished{0};
+  {
+    PrinterJobQueue queue(2);
+    for (int p = 0; p < 6; p++) {
+      for (int i = 0; i < 3; i++) {
+        queue.Post("printer-" + std::to_string(p), [&]() {
+          const int now = running.fetch_add(1) + 1;
+          int seen = peak.load();
+          while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          running.fetch_sub(1);
+          finished++;
+        });
+      }
+    }
+    EXPECT_GT(queue.Pending("printer-5"), 0u);
+  }
+  EXPECT_EQ(finished.load(), 18);
+  EXPECT_LE(peak.load(), 2);
+  EXPECT_GE(peak.load(), 1);
+}
+
+TEST(PrinterJobQueue, KeepsGoingAfterAJobThrows) {
+  std::atomic<int> ran{0};
+  {
+    PrinterJobQueue queue(1);
+    queue.Post("printer-a", []() { throw std::runtime_error("band failed"); });
+    queue.Post("printer-a", [&ran]() { ran++; });
+  }
+  EXPECT_EQ(ran.load(), 1);
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
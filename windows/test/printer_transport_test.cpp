@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "fake_printer_transport.h"
+#include "printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+TEST(PrinterTransport, WritesInChunksOfTheReceiveBuffer) {
+  const std::vector<uint8_t> job(1000, 0x55);
+
+  FakePrinterTransport whole;
+  ASSERT_TRUE(WriteInChunks(&whole, job.data(), job.size(), 0));
+  EXPECT_EQ(whole.writes(), 1u);
+  EXPECT_EQ(whole.flushes(), 1u);
+
+  FakePrinterTransport chunked;
+  ASSERT_TRUE(WriteInChunks(&chunked, job.data(), job.size(), 256));
+  EXPECT_EQ(chunked.writes(), 4u);
+  EXPECT_EQ(chunked.flushes(), 4u);
+  EXPECT_EQ(chunked.bytes_written(), job.size());
+
+  FakePrinterTransport closed;
+  closed.Close();
+  EXPECT_FALSE(WriteInChunks(&closed, job.data(), job.size(), 256));
+  EXPECT_EQ(closed.writes(), 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
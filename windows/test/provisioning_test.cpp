@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "provisioning.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+struct Outcome {
+  std::vector<ProvisionResult> results;
+  std::vector<ProvisionEvent> events;
+};
+
+/// Runs a provisioner to completion; events are only touched on its thread.
+Outcome Provision(std::vector<std::string> ids, ProvisionOptions options, Provisioner::StepRunner runner) {
+  auto run = std::make_shared<Outcome>();
+  std::promise<void> finished;
+  Provisioner::Start(
+      std::move(ids), options, std::move(runner),
+      [run](const ProvisionEvent& event) { run->events.push_back(event); },
+      [run, &finished](const std::vector<ProvisionResult>& results) {
+        run->results = results;
+        finished.set_value();
+      });
+  finished.get_future().wait();
+  return *run;
+}
+
+/// Completes each step from another thread after [delay_ms], as the
+/// Bluetooth and TCP backends do.
+void CompleteLater(std::function<void(bool)> done, bool ok, int delay_ms) {
+  std::thread([done, ok, delay_ms]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+    done(ok);
+  }).detach();
+}
+
+}  // namespace
+
+TEST(Provisioning, RunsStepsInOrderWithBoundedConcurrency) {
+  struct Counters {
+    std::atomic<int> in_flight{0};
+    std::atomic<int> max_in_flight{0};
+    std::mutex mutex;
+    std::vector<std::pair<std::string, ProvisionStep>> calls;
+  };
+  auto counters = std::make_shared<Counters>();
+  ProvisionOptions options;
+  options.max_concurrent = 3;
+  std::vector<std::string> ids;
+  for (int i = 0; i < 10; i++) ids.push_back("printer-" + std::to_string(i));
+
+  Outcome run = Provision(ids, options, [counters](const std::string& id, ProvisionStep step, auto done) {
+    int now = ++counters->in_flight;
+    int seen = counters->max_in_flight.load();
+    while (now > seen && !counters->max_in_flight.compare_exchange_weak(seen, now)) {
+    }
+    {
+      std::lock_guard<std::mutex> lock(counters->mutex);
+      counters->calls.emplace_back(id, step);
+    }
+    CompleteLater(
+        [counters, done](bool ok) {
+          counters->in_flight--;
+          done(ok);
+        },
+        true, 2);
+  });
+
+  ASSERT_EQ(run.results.size(), 10u);
+  for (size_t i = 0; i < ids.size(); i++) {
+    EXPECT_EQ(run.results[i].device_id, ids[i]);
+    EXPECT_TRUE(run.results[i].ok);
+    EXPECT_EQ(run.results[i].attempts, 4);
+    EXPECT_EQ(run.results[i].last_step, ProvisionStep::kTestPrint);
+  }
+  EXPECT_LE(counters->max_in_flight.load(), 3);
+  EXPECT_GE(counters->max_in_flight.load(), 2);
+  std::vector<ProvisionStep> first_device;
+  for (const auto& call : counters->calls) {
+    if (call.first == ids[0]) first_device.push_back(call.second);
+  }
+  EXPECT_EQ(first_device, (std::vector<ProvisionStep>{ProvisionStep::kPair, ProvisionStep::kConnect,
+                                                       ProvisionStep::kProbe, ProvisionStep::kTestPrint}));
+}
+
+TEST(Provisioning, RetriesFailedStepsWithBackoff) {
+  ProvisionOptions options;
+  options.initial_backoff_ms = 5;
+  options.max_backoff_ms = 8;
+  options.max_attempts = 3;
+  options.pair = false;
+  options.probe = false;
+  auto connects = std::make_shared<std::atomic<int>>(0);
+  Outcome run = Provision({"b"}, options, [connects](const std::string&, ProvisionStep step, auto done) {
+    // Connecting fails twice, then works.
+    done(step != ProvisionStep::kConnect || ++*connects > 2);
+  });
+
+  ASSERT_EQ(run.results.size(), 1u);
+  EXPECT_TRUE(run.results[0].ok);
+  EXPECT_EQ(run.results[0].attempts, 4);
+  std::vector<int64_t> delays;
+  for (const auto& event : run.events) {
+    if (event.kind == ProvisionEventKind::kStepRetrying) {
+      EXPECT_EQ(event.step, ProvisionStep::kConnect);
+      delays.push_back(event.retry_in_ms);
+    }
+  }
+  EXPECT_EQ(delays, (std::vector<int64_t>{5, 8}));
+  EXPECT_EQ(run.events.back().kind, ProvisionEventKind::kDeviceSucceeded);
+}
+
+TEST(Provisioning, GivesUpAfterMaxAttemptsAndSkipsLaterSteps) {
+  ProvisionOptions options;
+  options.initial_backoff_ms = 1;
+  options.max_attempts = 2;
+  auto test_prints = std::make_shared<std::atomic<int>>(0);
+  Outcome run = Provision({"ok", "broken"}, options,
+                      [test_prints](const std::string& id, ProvisionStep step, auto done) {
+                        if (step == ProvisionStep::kTestPrint) ++*test_prints;
+                        CompleteLater(done, !(id == "broken" && step == ProvisionStep::kProbe), 1);
+                      });
+
+  ASSERT_EQ(run.results.size(), 2u);
+  EXPECT_TRUE(run.results[0].ok);
+  EXPECT_FALSE(run.results[1].ok);
+  EXPECT_EQ(run.results[1].last_step, ProvisionStep::kProbe);
+  EXPECT_EQ(run.results[1].attempts, 2 + 2);  // pair, connect, probe twice
+  EXPECT_EQ(test_prints->load(), 1);
+}
+
+TEST(Provisioning, StepTimeoutCountsAsFailure) {
+  ProvisionOptions options;
+  options.step_timeout_ms = 10;
+  options.max_attempts = 1;
+  auto stuck = std::make_shared<std::vector<std::function<void(bool)>>>();
+  Outcome run = Provision({"silent"}, options, [stuck](const std::string&, ProvisionStep, auto done) {
+    stuck->push_back(done);  // e.g. a pairing prompt nobody answers
+  });
+
+  ASSERT_EQ(run.results.size(), 1u);
+  EXPECT_FALSE(run.results[0].ok);
+  EXPECT_EQ(run.results[0].last_step, ProvisionStep::kPair);
+  ASSERT_EQ(stuck->size(), 1u);
+  (*stuck)[0](true);  // late completion after the run: ignored
+}
+
+TEST(Provisioning, BackoffDoublesUpToTheCap) {
+  ProvisionOptions options;
+  options.initial_backoff_ms = 500;
+  options.max_backoff_ms = 3000;
+  EXPECT_EQ(Provisioner::BackoffMs(options, 1), 500);
+  EXPECT_EQ(Provisioner::BackoffMs(options, 2), 1000);
+  EXPECT_EQ(Provisioner::BackoffMs(options, 3), 2000);
+  EXPECT_EQ(Provisioner::BackoffMs(options, 4), 3000);
+  EXPECT_EQ(Provisioner::BackoffMs(options, 40), 3000);
+}
+
+TEST(Provisioning, EmptyListCompletesImmediately) {
+  Outcome run = Provision({}, ProvisionOptions(), [](const std::string&, ProvisionStep, auto done) { done(true); });
+  EXPECT_TRUE(run.results.empty());
+  EXPECT_TRUE(run.events.empty());
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
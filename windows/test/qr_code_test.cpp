@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "qr_code.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+/// Dark modules of the 7x7 finder pattern at ([x], [y]).
+bool HasFinder(const QrSymbol& symbol, int x, int y) {
+  for (int dy = 0; dy < 7; dy++) {
+    for (int dx = 0; dx < 7; dx++) {
+      const int ring = std::max(std::abs(dx - 3), std::abs(dy - 3));
+      if (symbol.Dark(x + dx, y + dy) != (ring != 2)) return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(QrCode, EncodesAlphanumericDataCodewords) {
+  // ISO/IEC 18004 style example: "HELLO WORLD" at version 1-M.
+  std::vector<uint8_t> codewords;
+  ASSERT_TRUE(QrDataCodewords("HELLO WORLD", QrErrorCorrection::kMedium, 1, &codewords));
+  EXPECT_EQ(codewords, (std::vector<uint8_t>{32, 91, 11, 120, 209, 114, 220, 77, 67, 64, 236, 17, 236, 17, 236, 17}));
+  EXPECT_EQ(QrErrorCorrectionCodewords(codewords, 10),
+            (std::vector<uint8_t>{196, 35, 39, 119, 235, 215, 231, 226, 93, 23}));
+}
+
+TEST(QrCode, DataCapacityMatchesTheStandard) {
+  struct Capacity {
+    QrErrorCorrection level;
+    int version;
+    size_t codewords;
+  };
+  const Capacity capacities[] = {
+      {QrErrorCorrection::kLow, 1, 19},       {QrErrorCorrection::kMedium, 1, 16},
+      {QrErrorCorrection::kQuartile, 1, 13},  {QrErrorCorrection::kHigh, 1, 9},
+      {QrErrorCorrection::kMedium, 10, 216},  {QrErrorCorrection::kLow, 40, 2956},
+      {QrErrorCorrection::kMedium, 40, 2334}, {QrErrorCorrection::kQuartile, 40, 1666},
+      {QrErrorCorrection::kHigh, 40, 1276},
+  };
+  for (const auto& c : capacities) {
+    std::vector<uint8_t> codewords;
+    ASSERT_TRUE(QrDataCodewords("", c.level, c.version, &codewords));
+    EXPECT_EQ(codewords.size(), c.codewords) << "version " << c.version;
+  }
+}
+
+TEST(QrCode, FormatBitsMatchTheStandardTable) {
+  EXPECT_EQ(QrFormatBits(QrErrorCorrection::kLow, 0), 0x77C4u);
+  EXPECT_EQ(QrFormatBits(QrErrorCorrection::kMedium, 0), 0x5412u);
+  EXPECT_EQ(QrFormatBits(QrErrorCorrection::kQuartile, 0), 0x355Fu);
+  EXPECT_EQ(QrFormatBits(QrErrorCorrection::kHigh, 0), 0x1689u);
+  EXPECT_EQ(QrFormatBits(QrErrorCorrection::kLow, 7), 0x6976u);
+}
+
+TEST(QrCode, PicksTheSmallestVersionAndDrawsFunctionPatterns) {
+  QrSymbol symbol;
+  ASSERT_TRUE(EncodeQrCode("HELLO WORLD", QrErrorCorrection::kMedium, &symbol));
+  EXPECT_EQ(symbol.version, 1);
+  EXPECT_EQ(symbol.size, 21);
+  EXPECT_EQ(symbol.modules.size(), 21u * 21u);
+  EXPECT_TRUE(HasFinder(symbol, 0, 0));
+  EXPECT_TRUE(HasFinder(symbol, 14, 0));
+  EXPECT_TRUE(HasFinder(symbol, 0, 14));
+  for (int i = 8; i < 13; i++) {
+    EXPECT_EQ(symbol.Dark(i, 6), i % 2 == 0);
+    EXPECT_EQ(symbol.Dark(6, i), i % 2 == 0);
+  }
+  EXPECT_TRUE(symbol.Dark(8, symbol.size - 8));
+
+  // The format information next to the top-left finder names level and mask.
+  const uint32_t format = QrFormatBits(QrErrorCorrection::kMedium, symbol.mask);
+  for (int i = 0; i <= 5; i++) EXPECT_EQ(symbol.Dark(8, i), ((format >> i) & 1) != 0);
+
+  // 100 bytes fit version 5 at level L; level H needs a larger symbol.
+  ASSERT_TRUE(EncodeQrCode(std::string(100, 'x'), QrErrorCorrection::kLow, &symbol));
+  EXPECT_EQ(symbol.version, 5);
+  ASSERT_TRUE(EncodeQrCode(std::string(100, 'x'), QrErrorCorrection::kHigh, &symbol));
+  EXPECT_EQ(symbol.version, 10);
+}
+
+TEST(QrCode, LargeVersionsCarryVersionInformation) {
+  QrSymbol symbol;
+  ASSERT_TRUE(EncodeQrCode(std::string(150, 'a'), QrErrorCorrection::kLow, &symbol));
+  EXPECT_EQ(symbol.version, 7);
+  // Version 7 information is 000111 110010 010100, bit 0 at (size - 11, 0).
+  const uint32_t bits = 0x07C94;
+  for (int i = 0; i < 18; i++) {
+    EXPECT_EQ(symbol.Dark(symbol.size - 11 + i % 3, i / 3), ((bits >> i) & 1) != 0) << i;
+    EXPECT_EQ(symbol.Dark(i / 3, symbol.size - 11 + i % 3), ((bits >> i) & 1) != 0) << i;
+  }
+}
+
+TEST(QrCode, RejectsDataBeyondVersion40) {
+  QrSymbol symbol;
+  EXPECT_TRUE(EncodeQrCode(std::string(2953, 'a'), QrErrorCorrection::kLow, &symbol));
+  EXPECT_EQ(symbol.version, 40);
+  EXPECT_FALSE(EncodeQrCode(std::string(2954, 'a'), QrErrorCorrection::kLow, &symbol));
+  // Digits pack 3 per 10 bits.
+  EXPECT_TRUE(EncodeQrCode(std::string(7089, '7'), QrErrorCorrection::kLow, &symbol));
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "raster_pipeline.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+TEST(RasterPipeline, EncodesBandsWithByteWidthHeaders) {
+  std::vector<uint8_t> pixels(16 * 50, 0);  // all black, 16x50
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = 16;
+  source.height = 50;
+  source.dither = false;
+  source.band_height = 24;
+
+  std::vector<std::vector<uint8_t>> bands;
+  ASSERT_TRUE(StreamRasterImage(source, [&](const uint8_t* data, size_t size) {
+    bands.emplace_back(data, data + size);
+    return true;
+  }));
+  ASSERT_EQ(bands.size(), 3u);  // 24 + 24 + 2 rows
+  const std::vector<uint8_t>& first = bands[0];
+  EXPECT_EQ(first[0], 0x1D);
+  EXPECT_EQ(first[1], 0x76);
+  EXPECT_EQ(first[2], 0x30);
+  EXPECT_EQ(first[4], 2);   // 16 dots = 2 bytes per row
+  EXPECT_EQ(first[6], 24);
+  EXPECT_EQ(first.size(), 8u + 2 * 24);
+  EXPECT_EQ(first[8], 0xFF);
+  EXPECT_EQ(bands[2][6], 2);
+  EXPECT_EQ(bands[2].size(), 8u + 2 * 2);
+}
+
+TEST(RasterPipeline, EncodesEscStarColumnStrips) {
+  std::vector<uint8_t> pixels(10 * 30, 255);
+  for (int x = 0; x < 10; x++) {
+    pixels[x] = 0;            // row 0
+    pixels[25 * 10 + x] = 0;  // row 25 = second strip, row 1
+  }
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = 10;
+  source.height = 30;
+  source.dither = false;
+  source.band_height = 100;  // ignored: strips are 24 rows
+  source.command = RasterCommand::kEscStar24;
+
+  std::vector<std::vector<uint8_t>> strips;
+  ASSERT_TRUE(StreamRasterImage(source, [&](const uint8_t* data, size_t size) {
+    strips.emplace_back(data, data + size);
+    return true;
+  }));
+  ASSERT_EQ(strips.size(), 2u);
+  const std::vector<uint8_t> header = {0x1B, 0x33, 24, 0x1B, 0x2A, 33, 10, 0};
+  EXPECT_TRUE(std::equal(header.begin(), header.end(), strips[0].begin()));
+  ASSERT_EQ(strips[0].size(), 8u + 3 * 10 + 1);
+  EXPECT_EQ(strips[0][8], 0x80);
+  EXPECT_EQ(strips[0][9], 0x00);
+  EXPECT_EQ(strips[0][10], 0x00);
+  EXPECT_EQ(strips[0].back(), 0x0A);
+  // The last strip restores the default line spacing.
+  ASSERT_EQ(strips[1].size(), 8u + 3 * 10 + 3);
+  EXPECT_EQ(strips[1][8], 0x40);
+  EXPECT_EQ(strips[1][8 + 3 * 9], 0x40);
+  EXPECT_EQ(strips[1][strips[1].size() - 3], 0x0A);
+  EXPECT_EQ(strips[1][strips[1].size() - 2], 0x1B);
+  EXPECT_EQ(strips[1].back(), 0x32);
+}
+
+TEST(RasterPipeline, ReusesOneBandBufferRegardlessOfHeight) {
+  std::vector<uint8_t> pixels(8 * 10000, 255);
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = 8;
+  source.height = 10000;
+  source.band_height = 16;
+
+  const uint8_t* buffer = nullptr;
+  size_t calls = 0;
+  ASSERT_TRUE(StreamRasterImage(source, [&](const uint8_t* data, size_t) {
+    if (!buffer) buffer = data;
+    EXPECT_EQ(data, buffer);
+    calls++;
+    return true;
+  }));
+  EXPECT_EQ(calls, 625u);
+}
+
+TEST(RasterPipeline, ScalesToTargetWidthKeepingAspectRatio) {
+  std::vector<uint8_t> pixels(100 * 50 * 4, 0);
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = 100;
+  source.height = 50;
+  source.format = SourcePixelFormat::kRgba8888;
+  source.target_width = 384;
+  int w = 0;
+  int h = 0;
+  ASSERT_TRUE(RasterOutputSize(source, &w, &h));
+  EXPECT_EQ(w, 384);
+  EXPECT_EQ(h, 192);
+}
+
+TEST(RasterPipeline, TransparentRgbaPrintsWhite) {
+  std::vector<uint8_t> pixels(8 * 1 * 4, 0);  // black but fully transparent
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = 8;
+  source.height = 1;
+  source.format = SourcePixelFormat::kRgba8888;
+  source.dither = false;
+  std::vector<uint8_t> band;
+  ASSERT_TRUE(StreamRasterImage(source, [&](const uint8_t* data, size_t size) {
+    band.assign(data, data + size);
+    return true;
+  }));
+  ASSERT_EQ(band.size(), 9u);
+  EXPECT_EQ(band[8], 0x00);
+}
+
+TEST(RasterPipeline, StopsWhenSinkFails) {
+  std::vector<uint8_t> pixels(8 * 100, 0);
+  RasterImageSource source;
+  source.pixels = pixels.data();
+  source.width = 8;
+  source.height = 100;
+  source.band_height = 10;
+  int calls = 0;
+  EXPECT_FALSE(StreamRasterImage(source, [&](const uint8_t*, size_t) {
+    return ++calls < 3;
+  }));
+  EXPECT_EQ(calls, 3);
+}
+
+TEST(RasterPipeline, StreamsPackedBitmapsWithoutConversion) {
+  // 12 dots wide, stored 4 bytes apart; rows alternate black and white.
+  std::vector<uint8_t> bits(4 * 30, 0);
+  for (int y = 0; y < 30; y += 2) {
+    bits[y * 4] = 0xFF;
+    bits[y * 4 + 1] = 0xF0;
+  }
+  std::vector<std::vector<uint8_t>> bands;
+  auto sink = [&](const uint8_t* data, size_t size) {
+    bands.emplace_back(data, data + size);
+    return true;
+  };
+  ASSERT_TRUE(StreamBitmapBands(bits.data(), 12, 30, 4, RasterCommand::kGsV0, 16, sink));
+  ASSERT_EQ(bands.size(), 2u);
+  EXPECT_EQ(bands[0][4], 2);  // 12 dots = 2 bytes per row
+  EXPECT_EQ(bands[0][6], 16);
+  EXPECT_EQ(bands[0].size(), 8u + 2 * 16);
+  EXPECT_EQ(bands[0][8], 0xFF);
+  EXPECT_EQ(bands[0][9], 0xF0);
+  EXPECT_EQ(bands[0][10], 0x00);
+  EXPECT_EQ(bands[1][6], 14);
+
+  bands.clear();
+  ASSERT_TRUE(StreamBitmapBands(bits.data(), 12, 30, 4, RasterCommand::kEscStar24, 16, sink));
+  ASSERT_EQ(bands.size(), 2u);
+  EXPECT_EQ(bands[0][5], 33);
+  EXPECT_EQ(bands[0][8], 0xAA);  // column 0, rows 0..7
+  EXPECT_FALSE(StreamBitmapBands(bits.data(), 40, 30, 4, RasterCommand::kGsV0, 16, sink));
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "single_flight.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+struct ManualClock {
+  int64_t now = 0;
+  std::function<int64_t()> fn() {
+    return [this]() { return now; };
+  }
+};
+
+}  // namespace
+
+TEST(SingleFlight, ConcurrentCallersShareOneQuery) {
+  SingleFlight<int> flights;
+  int starts = 0;
+  SingleFlight<int>::Callback pending;
+  std::vector<int> results;
+  auto start = [&](SingleFlight<int>::Callback done) {
+    starts++;
+    pending = done;
+  };
+  EXPECT_EQ(flights.Do("scan", [&](const int& v) { results.push_back(v); }, start), FlightJoin::kStarted);
+  EXPECT_EQ(flights.Do("scan", [&](const int& v) { results.push_back(v + 100); }, start), FlightJoin::kJoined);
+  EXPECT_EQ(flights.Do("other", [&](const int& v) { results.push_back(v + 1000); }, [](auto) {}),
+            FlightJoin::kStarted);
+  EXPECT_EQ(starts, 1);
+  pending(7);
+  pending(8);  // a second completion is ignored
+  EXPECT_EQ(results, (std::vector<int>{7, 107}));
+
+  // Without a TTL the next call starts a new query.
+  EXPECT_EQ(flights.Do("scan", [](const int&) {}, start), FlightJoin::kStarted);
+  EXPECT_EQ(starts, 2);
+}
+
+TEST(SingleFlight, CachesForTtl) {
+  ManualClock clock;
+  SingleFlight<std::string> flights(clock.fn());
+  flights.SetTtlMs(500);
+  int starts = 0;
+  auto start = [&](SingleFlight<std::string>::Callback done) {
+    starts++;
+    done("devices#" + std::to_string(starts));
+  };
+  std::string got;
+  EXPECT_EQ(flights.Do("scan", [&](const std::string& v) { got = v; }, start), FlightJoin::kStarted);
+  EXPECT_EQ(got, "devices#1");
+  clock.now = 499;
+  EXPECT_EQ(flights.Do("scan", [&](const std::string& v) { got = v; }, start), FlightJoin::kCached);
+  EXPECT_EQ(got, "devices#1");
+  clock.now = 500;
+  EXPECT_EQ(flights.Do("scan", [&](const std::string& v) { got = v; }, start), FlightJoin::kStarted);
+  EXPECT_EQ(got, "devices#2");
+  flights.Invalidate("scan");
+  EXPECT_EQ(flights.Do("scan", [&](const std::string& v) { got = v; }, start), FlightJoin::kStarted);
+  EXPECT_EQ(starts, 3);
+}
+
+TEST(SingleFlight, InvalidateDuringFlightStartsFreshQuery) {
+  SingleFlight<int> flights;
+  flights.SetTtlMs(60000);
+  std::vector<SingleFlight<int>::Callback> pending;
+  auto start = [&](SingleFlight<int>::Callback done) { pending.push_back(done); };
+  std::vector<int> results;
+  flights.Do("scan", [&](const int& v) { results.push_back(v); }, start);
+  flights.Invalidate("scan");  // e.g. a printer was paired meanwhile
+  EXPECT_EQ(flights.Do("scan", [&](const int& v) { results.push_back(v); }, start), FlightJoin::kStarted);
+  ASSERT_EQ(pending.size(), 2u);
+  pending[0](1);  // stale: answers its caller but is not cached
+  pending[1](2);
+  EXPECT_EQ(results, (std::vector<int>{1, 2}));
+  int cached = 0;
+  EXPECT_EQ(flights.Do("scan", [&](const int& v) { cached = v; }, start), FlightJoin::kCached);
+  EXPECT_EQ(cached, 2);
+}
+
+TEST(SingleFlight, CompletesFromAnotherThreadAndAllowsReentry) {
+  SingleFlight<int> flights;
+  std::atomic<int> starts{0};
+  std::vector<std::thread> workers;
+  std::promise<void> go;
+  std::shared_future<void> released = go.get_future().share();
+  auto start = [&](SingleFlight<int>::Callback done) {
+    starts++;
+    workers.emplace_back([done, released]() {
+      released.wait();
+      done(42);
+    });
+  };
+  std::atomic<int> delivered{0};
+  // The callback of the first query issues another one; no lock is held.
+  flights.Do("scan",
+             [&](const int& v) {
+               delivered += v;
+               flights.Do("status", [&](const int& s) { delivered += s; },
+                          [](SingleFlight<int>::Callback done) { done(1); });
+             },
+             start);
+  for (int i = 0; i < 10; i++) flights.Do("scan", [&](const int& v) { delivered += v; }, start);
+  go.set_value();
+  for (auto& t : workers) t.join();
+  EXPECT_EQ(starts.load(), 1);
+  EXPECT_EQ(delivered.load(), 11 * 42 + 1);
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
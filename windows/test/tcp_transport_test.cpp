@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_tcp_printer.h"
+#include "printer_status.h"
+#include "tcp_printers.h"
+#include "tcp_transport.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+bool WaitForBytes(const FakeTcpPrinter& printer, uint64_t count) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (printer.bytes_received() < count) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+bool SendAndWait(const std::string& id, std::vector<uint8_t> data) {
+  auto done = std::make_shared<std::promise<bool>>();
+  auto future = done->get_future();
+  TcpSendAsync(id, std::move(data), [done](bool ok) { done->set_value(ok); });
+  return future.get();
+}
+
+}  // namespace
+
+TEST(TcpTransport, ParsesPrinterIds) {
+  std::string host;
+  uint16_t port = 0;
+  ASSERT_TRUE(ParseTcpPrinterId("tcp:192.168.1.50", &host, &port));
+  EXPECT_EQ(host, "192.168.1.50");
+  EXPECT_EQ(port, kRawPrintPort);
+  ASSERT_TRUE(ParseTcpPrinterId("tcp:printer.local:9101", &host, &port));
+  EXPECT_EQ(host, "printer.local");
+  EXPECT_EQ(port, 9101);
+  ASSERT_TRUE(ParseTcpPrinterId("tcp:[fe80::1]:9100", &host, &port));
+  EXPECT_EQ(host, "fe80::1");
+  EXPECT_FALSE(ParseTcpPrinterId("tcp:", &host, &port));
+  EXPECT_FALSE(ParseTcpPrinterId("tcp:host:0", &host, &port));
+  EXPECT_FALSE(ParseTcpPrinterId("tcp:host:99999", &host, &port));
+  EXPECT_FALSE(ParseTcpPrinterId("BluetoothDevice#Bluetooth00:11:22", &host, &port));
+  EXPECT_FALSE(IsTcpPrinterId("00:11:22:33:44:55"));
+}
+
+TEST(TcpTransport, GatheredWriteArrivesInOrder) {
+  FakeTcpPrinter printer;
+  ASSERT_TRUE(printer.Start());
+  auto socket = TcpTransport::Connect("127.0.0.1", printer.port());
+  ASSERT_NE(socket, nullptr);
+  // Large enough that the kernel accepts it in several partial sends.
+  std::vector<uint8_t> big(4 << 20);
+  for (size_t i = 0; i < big.size(); i++) big[i] = static_cast<uint8_t>(i * 7);
+  const uint8_t head[] = {0x1B, 0x40};
+  const uint8_t tail[] = {'o', 'k', 0x0A};
+  TransportBuffer buffers[] = {{head, sizeof(head)}, {nullptr, 0}, {big.data(), big.size()},
+                               {tail, sizeof(tail)}};
+  ASSERT_TRUE(socket->WriteGather(buffers, 4));
+  ASSERT_TRUE(socket->Flush());
+  ASSERT_TRUE(WaitForBytes(printer, sizeof(head) + big.size() + sizeof(tail)));
+  std::vector<uint8_t> expected(head, head + sizeof(head));
+  expected.insert(expected.end(), big.begin(), big.end());
+  expected.insert(expected.end(), tail, tail + sizeof(tail));
+  EXPECT_EQ(printer.received(), expected);
+}
+
+TEST(TcpTransport, DecodesRealTimeStatus) {
+  FakePrinterOptions options;
+  options.status_reply = {0x12};
+  FakeTcpPrinter healthy(options);
+  ASSERT_TRUE(healthy.Start());
+  auto socket = TcpTransport::Connect("127.0.0.1", healthy.port());
+  ASSERT_NE(socket, nullptr);
+  PrinterStatusReport report;
+  ASSERT_TRUE(QueryPrinterStatus(socket.get(), 1000, &report));
+  EXPECT_FALSE(report.offline || report.cover_open || report.paper_out || report.error);
+
+  options.status_reply = {0x7E};  // every flag set
+  FakeTcpPrinter failing(options);
+  ASSERT_TRUE(failing.Start());
+  socket = TcpTransport::Connect("127.0.0.1", failing.port());
+  ASSERT_NE(socket, nullptr);
+  ASSERT_TRUE(QueryPrinterStatus(socket.get(), 1000, &report));
+  EXPECT_TRUE(report.offline && report.cover_open && report.paper_near_end && report.paper_out &&
+              report.error);
+
+  options.status_reply.clear();
+  FakeTcpPrinter silent(options);
+  ASSERT_TRUE(silent.Start());
+  socket = TcpTransport::Connect("127.0.0.1", silent.port());
+  ASSERT_NE(socket, nullptr);
+  EXPECT_FALSE(QueryPrinterStatus(socket.get(), 20, &report));
+}
+
+TEST(TcpPrinters, ReusesConnectionAndReplacesDroppedOne) {
+  FakeTcpPrinter printer;
+  ASSERT_TRUE(printer.Start());
+  const std::string id = printer.printer_id();
+  EXPECT_FALSE(TcpIsConnected(id));
+  std::vector<uint8_t> job = {0x1B, 0x40, 'a', 0x0A};
+  for (int i = 0; i < 3; i++) ASSERT_TRUE(SendAndWait(id, job));
+  EXPECT_TRUE(TcpIsConnected(id));
+  EXPECT_EQ(printer.connections(), 1u);
+  ASSERT_TRUE(WaitForBytes(printer, 3 * job.size()));
+
+  printer.DropConnections();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_TRUE(SendAndWait(id, job));
+  EXPECT_EQ(printer.connections(), 2u);
+  ASSERT_TRUE(WaitForBytes(printer, 4 * job.size()));
+
+  TcpDisconnect(id);
+  EXPECT_FALSE(TcpIsConnected(id));
+}
+
+TEST(TcpPrinters, QueuedJobsKeepOrder) {
+  FakeTcpPrinter printer;
+  ASSERT_TRUE(printer.Start());
+  const std::string id = printer.printer_id();
+  std::vector<std::future<bool>> results;
+  std::vector<uint8_t> expected;
+  for (int i = 0; i < 50; i++) {
+    std::vector<uint8_t> job(100 + i, static_cast<uint8_t>(i));
+    expected.insert(expected.end(), job.begin(), job.end());
+    auto done = std::make_shared<std::promise<bool>>();
+    results.push_back(done->get_future());
+    TcpSendAsync(id, std::move(job), [done](bool ok) { done->set_value(ok); });
+  }
+  for (auto& r : results) EXPECT_TRUE(r.get());
+  ASSERT_TRUE(WaitForBytes(printer, expected.size()));
+  EXPECT_EQ(printer.received(), expected);
+  TcpDisconnect(id);
+}
+
+TEST(TcpPrinters, DisconnectDoesNotWaitForAConnectInProgress) {
+  // Non-routable: the connect hangs until its timeout (or fails at once
+  // where there is no route at all).
+  const std::string id = "tcp:10.255.255.1:9100";
+  auto done = std::make_shared<std::promise<bool>>();
+  auto future = done->get_future();
+  TcpConnectAsync(id, [done](bool ok) { done->set_value(ok); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto start = std::chrono::steady_clock::now();
+  TcpDisconnect(id);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+  EXPECT_FALSE(TcpIsConnected(id));
+  EXPECT_FALSE(future.get());
+}
+
+TEST(TcpPrinters, ReportsUnreachablePrinter) {
+  uint16_t closed_port;
+  {
+    FakeTcpPrinter printer;
+    ASSERT_TRUE(printer.Start());
+    closed_port = printer.port();
+  }
+  const std::string id = "tcp:127.0.0.1:" + std::to_string(closed_port);
+  auto done = std::make_shared<std::promise<bool>>();
+  auto future = done->get_future();
+  TcpConnectAsync(id, [done](bool ok) { done->set_value(ok); });
+  EXPECT_FALSE(future.get());
+  EXPECT_FALSE(TcpIsConnected(id));
+  TcpDisconnectAll();
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace_capture.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+/// Accepts everything and answers reads with one status byte.
+class NullTransport : public PrinterTransport {
+ public:
+  bool Write(const uint8_t*, size_t) override { return true; }
+  bool Flush() override { return true; }
+  int Read(uint8_t* buffer, size_t capacity, int) override {
+    if (capacity == 0) return 0;
+    buffer[0] = 0x12;
+    return 1;
+  }
+  void Close() override {}
+};
+
+/// Takes [write_ms] per write, like a slow link.
+class SlowTransport : public NullTransport {
+ public:
+  explicit SlowTransport(int write_ms) : write_ms_(write_ms) {}
+  bool Write(const uint8_t*, size_t) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(write_ms_));
+    return true;
+  }
+
+ private:
+  int write_ms_;
+};
+
+std::string TempTracePath(const char* name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+}  // namespace
+
+TEST(TraceCapture, RecordsWritesFlushesReadsAndJobs) {
+  std::string path = TempTracePath("ftpw_trace_roundtrip.bin");
+  ASSERT_TRUE(TraceStart(path));
+  TracingTransport a("printer-a", std::make_unique<NullTransport>());
+  TracingTransport b("printer-b", std::make_unique<NullTransport>());
+  const uint8_t payload[] = {0x1B, 0x40, 'H', 'i', 0x0A};
+  uint64_t job = TraceJobBegin("printer-a", sizeof(payload));
+  EXPECT_NE(job, 0u);
+  a.Write(payload, sizeof(payload));
+  a.Flush();
+  b.Write(payload, 2);
+  uint8_t status = 0;
+  a.Read(&status, 1, 100);
+  TraceJobEnd("printer-a", job, true);
+  EXPECT_EQ(TraceStop(), 6u);
+  EXPECT_EQ(TraceStop(), 0u);  // nothing running any more
+
+  TraceReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  std::vector<TraceRecord> records;
+  TraceRecord record;
+  while (reader.Next(&record)) records.push_back(record);
+  ASSERT_EQ(records.size(), 6u);
+  EXPECT_EQ(records[0].type, TraceRecordType::kJobBegin);
+  EXPECT_EQ(records[0].value, job);
+  EXPECT_EQ(records[0].size, sizeof(payload));
+  EXPECT_EQ(records[1].type, TraceRecordType::kWrite);
+  EXPECT_EQ(records[1].device_id, "printer-a");
+  EXPECT_EQ(records[1].data, std::vector<uint8_t>(payload, payload + sizeof(payload)));
+  EXPECT_EQ(records[2].type, TraceRecordType::kFlush);
+  EXPECT_EQ(records[3].device_id, "printer-b");
+  EXPECT_EQ(records[3].data.size(), 2u);
+  EXPECT_EQ(records[4].type, TraceRecordType::kRead);
+  EXPECT_EQ(records[4].data, std::vector<uint8_t>{0x12});
+  EXPECT_EQ(records[5].type, TraceRecordType::kJobEnd);
+  EXPECT_TRUE(records[5].ok);
+  for (size_t i = 1; i < records.size(); i++) {
+    EXPECT_GE(records[i].timestamp_us, records[i - 1].timestamp_us);
+  }
+  std::remove(path.c_str());
+}
+
+TEST(TraceCapture, InactiveCaptureRecordsNothing) {
+  EXPECT_FALSE(TraceIsActive());
+  EXPECT_EQ(TraceJobBegin("printer-a", 10), 0u);
+  TracingTransport a("printer-a", std::make_unique<NullTransport>());
+  const uint8_t byte = 0x0A;
+  EXPECT_TRUE(a.Write(&byte, 1));
+  EXPECT_EQ(TraceStop(), 0u);
+}
+
+TEST(TraceCapture, StampsOpsWhenTheyStart) {
+  std::string path = TempTracePath("ftpw_trace_start_times.bin");
+  ASSERT_TRUE(TraceStart(path));
+  TracingTransport a("printer-a", std::make_unique<SlowTransport>(30));
+  const uint8_t byte = 0x0A;
+  a.Write(&byte, 1);
+  a.Flush();
+  EXPECT_EQ(TraceStop(), 2u);
+
+  TraceReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  TraceRecord write;
+  TraceRecord flush;
+  ASSERT_TRUE(reader.Next(&write));
+  ASSERT_TRUE(reader.Next(&flush));
+  EXPECT_EQ(write.type, TraceRecordType::kWrite);
+  // The write is stamped before its 30 ms, the flush after them.
+  EXPECT_LT(write.timestamp_us, 20000u);
+  EXPECT_GE(flush.timestamp_us - write.timestamp_us, 30000u);
+  std::remove(path.c_str());
+}
+
+TEST(TraceCapture, RejectsFilesWithoutHeader) {
+  std::string path = TempTracePath("ftpw_trace_garbage.bin");
+  std::FILE* f = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(f, nullptr);
+  std::fputs("not a trace", f);
+  std::fclose(f);
+  TraceReader reader;
+  EXPECT_FALSE(reader.Open(path));
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace_spans.h"
+
+namespace flutter_thermal_printer_windows {
+namespace test {
+
+namespace {
+
+size_t CountOf(const std::string& text, const std::string& needle) {
+  size_t count = 0;
+  for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1)) count++;
+  return count;
+}
+
+/// Starts each test from empty rings.
+class TraceSpansTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SpansSetActive(false);
+    SpansExportChromeJson(true);
+  }
+  void TearDown() override { SpansSetActive(false); }
+};
+
+}  // namespace
+
+TEST_F(TraceSpansTest, InactiveRecordsNothing) {
+  { ScopedSpan span("Idle"); }
+  EXPECT_EQ(SpansRecorded(), 0u);
+  EXPECT_EQ(CountOf(SpansExportChromeJson(false), "\"Idle\""), 0u);
+}
+
+TEST_F(TraceSpansTest, ExportsCompleteAndAsyncSpans) {
+  SpansSetActive(true);
+  SpanSetThreadName("test-main");
+  { ScopedSpan span("WriteBytes", "FAKE-BT-0001"); }
+  SpanRecordAsync("RunOnMtaAsync.wait", 100, 25);
+  ASSERT_EQ(SpansRecorded(), 2u);
+
+  std::string json = SpansExportChromeJson(true);
+  EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+  EXPECT_NE(json.find("\"args\":{\"name\":\"test-main\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"name\":\"WriteBytes\",\"cat\":\"ftpw\",\"ph\":\"X\""), std::string::npos);
+  EXPECT_NE(json.find("\"args\":{\"detail\":\"FAKE-BT-0001\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"b\",\"ts\":100,\"id\":1"), std::string::npos);
+  EXPECT_NE(json.find("\"ph\":\"e\",\"ts\":125,\"id\":1"), std::string::npos);
+  EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+
+  // Cleared spans are not exported twice.
+  EXPECT_EQ(SpansRecorded(), 0u);
+  EXPECT_EQ(CountOf(SpansExportChromeJson(false), "\"cat\":\"ftpw\""), 0u);
+}
+
+TEST_F(TraceSpansTest, ThreadsRecordIntoTheirOwnRings) {
+  SpansSetActive(true);
+  constexpr int kThreads = 4;
+  constexpr int kSpans = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < kSpans; i++) ScopedSpan span("StoreAsync");
+    });
+  }
+  // Exports while the threads record must not disturb them.
+  for (int i = 0; i < 20; i++) SpansExportChromeJson(false);
+  for (auto& thread : threads) thread.join();
+
+  std::string json = SpansExportChromeJson(true);
+  EXPECT_EQ(CountOf(json, "\"name\":\"StoreAsync\""), static_cast<size_t>(kThreads * kSpans));
+}
+
+TEST_F(TraceSpansTest, FullRingKeepsTheNewestSpans) {
+  SpansSetActive(true);
+  std::thread([]() {
+    for (size_t i = 0; i < kSpanRingSize + 10; i++) SpanRecord("FlushAsync", 1000 + static_cast<int64_t>(i), 1);
+  }).join();
+
+  std::string json = SpansExportChromeJson(true);
+  EXPECT_EQ(CountOf(json, "\"name\":\"FlushAsync\""), kSpanRingSize);
+  EXPECT_EQ(json.find("\"ts\":1009,"), std::string::npos);
+  EXPECT_NE(json.find("\"ts\":1010,"), std::string::npos);
+}
+
+TEST_F(TraceSpansTest, InternedNamesAreEscaped) {
+  SpansSetActive(true);
+  const char* name = SpanInternName("say \"hi\"\n");
+  EXPECT_EQ(name, SpanInternName("say \"hi\"\n"));
+  SpanRecord(name, 1, 1);
+  std::string json = SpansExportChromeJson(true);
+  EXPECT_NE(json.find("\"name\":\"say \\\"hi\\\"\\u000a\""), std::string::npos);
+}
+
+}  // namespace test
+}  // namespace flutter_thermal_printer_windows
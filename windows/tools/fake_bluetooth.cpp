@@ -0,0 +1,331 @@
+#include "fake_bluetooth.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "bluetooth_winrt.h"
+#include "device_registry.h"
+#include "trace_spans.h"
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+/// Same per-reply probe timeout as the real backend.
+constexpr int kProbeTimeoutMs = 300;
+
+/// Worker and device state. Leaked on purpose: the worker is detached, as in
+/// the real backend, and may still be running during static destruction.
+struct FakeStack {
+  std::mutex mutex;
+  std::condition_variable cv_task;
+  std::condition_variable cv_done;
+  std::deque<std::function<void()>> tasks;
+  std::once_flag worker_once;
+  FakeBluetoothOptions options;
+  /// Open connections. Worker thread only.
+  std::unordered_map<std::string, std::unique_ptr<FakePrinterTransport>> transports;
+  /// Keys of transports, readable without the worker (BluetoothIsConnected).
+  std::mutex connected_mutex;
+  std::unordered_set<std::string> connected;
+  std::atomic<uint64_t> bytes_received{0};
+  std::atomic<uint64_t> tasks_run{0};
+  std::atomic<uint64_t> links_opened{0};
+};
+
+FakeStack& Stack() {
+  static FakeStack* stack = new FakeStack();
+  return *stack;
+}
+
+void SleepUs(int us) {
+  if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void WorkerThread() {
+  FakeStack& s = Stack();
+  SpanSetThreadName("mta-worker");
+  std::unique_lock<std::mutex> lock(s.mutex);
+  for (;;) {
+    s.cv_task.wait(lock, [&s] { return !s.tasks.empty(); });
+    std::function<void()> task = std::move(s.tasks.front());
+    s.tasks.pop_front();
+    lock.unlock();
+    {
+      ScopedSpan span("MtaTask");
+      task();
+    }
+    s.tasks_run++;
+    lock.lock();
+  }
+}
+
+void StartWorker() {
+  std::call_once(Stack().worker_once, []() { std::thread(WorkerThread).detach(); });
+}
+
+/// Queue waits are recorded under the real backend's span names.
+void RunOnWorkerAsync(std::function<void()> f) {
+  StartWorker();
+  if (SpansActive()) {
+    f = [f = std::move(f), posted_us = SpanNowUs()]() {
+      SpanRecordAsync("RunOnMtaAsync.wait", posted_us, SpanNowUs() - posted_us);
+      f();
+    };
+  }
+  FakeStack& s = Stack();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.tasks.push_back(std::move(f));
+  s.cv_task.notify_one();
+}
+
+/// Blocks the caller until [f] has run on the worker, like RunOnMta.
+void RunOnWorker(const std::function<void()>& f) {
+  StartWorker();
+  FakeStack& s = Stack();
+  bool done = false;
+  const int64_t posted_us = SpansActive() ? SpanNowUs() : -1;
+  std::unique_lock<std::mutex> lock(s.mutex);
+  s.tasks.push_back([&f, &done, &s, posted_us]() {
+    if (posted_us >= 0) SpanRecordAsync("RunOnMta.wait", posted_us, SpanNowUs() - posted_us);
+    f();
+    std::lock_guard<std::mutex> done_lock(s.mutex);
+    done = true;
+    s.cv_done.notify_all();
+  });
+  s.cv_task.notify_one();
+  s.cv_done.wait(lock, [&done] { return done; });
+}
+
+bool IsKnownDevice(const std::string& device_id) {
+  const int count = Stack().options.device_count;
+  for (int i = 0; i < count; i++) {
+    if (FakeBluetoothDeviceId(i) == device_id) return true;
+  }
+  return false;
+}
+
+std::vector<SppDeviceInfo> ScanImpl() {
+  FakeStack& s = Stack();
+  SleepUs(s.options.scan_latency_us);
+  std::vector<SppDeviceInfo> devices;
+  for (int i = 0; i < s.options.device_count; i++) {
+    SppDeviceInfo info;
+    info.id = FakeBluetoothDeviceId(i);
+    info.name = "Fake POS " + std::to_string(i);
+    char mac[18];
+    std::snprintf(mac, sizeof(mac), "00:11:22:33:%02X:%02X", (i >> 8) & 0xFF, i & 0xFF);
+    info.mac_address = mac;
+    info.signal_strength = -50;
+    info.is_paired = true;
+    info.is_connected = s.transports.count(info.id) != 0;
+    devices.push_back(std::move(info));
+  }
+  return devices;
+}
+
+/// Worker thread only. True if [device_id] has a link that has not dropped.
+bool HasLiveTransport(const std::string& device_id) {
+  FakeStack& s = Stack();
+  auto it = s.transports.find(device_id);
+  return it != s.transports.end() && it->second->IsAlive();
+}
+
+/// Worker thread only; the link setup itself is [connect_latency_us].
+bool InstallImpl(const std::string& device_id) {
+  FakeStack& s = Stack();
+  if (HasLiveTransport(device_id)) return true;
+  if (!IsKnownDevice(device_id)) return false;
+  s.transports[device_id] = std::make_unique<FakePrinterTransport>(s.options.printer);
+  s.links_opened++;
+  std::lock_guard<std::mutex> lock(s.connected_mutex);
+  s.connected.insert(device_id);
+  return true;
+}
+
+/// Marks [device_id] disconnected; the worker drops the transport itself.
+void ForgetConnected(const std::string& device_id) {
+  FakeStack& s = Stack();
+  std::lock_guard<std::mutex> lock(s.connected_mutex);
+  s.connected.erase(device_id);
+}
+
+bool ConnectImpl(const std::string& device_id) {
+  if (HasLiveTransport(device_id)) return true;
+  SleepUs(Stack().options.connect_latency_us);
+  return InstallImpl(device_id);
+}
+
+bool SendImpl(const std::string& device_id, const uint8_t* data, size_t size) {
+  FakeStack& s = Stack();
+  auto it = s.transports.find(device_id);
+  if (it == s.transports.end()) return false;
+  if (size == 0) return true;
+  // Pieces of the probed receive buffer size, as in BluetoothSendImpl.
+  RegisteredPrinter printer;
+  const size_t chunk_size = GetDeviceRegistry().Find(device_id, &printer) ? printer.write_chunk_size : 0;
+  for (size_t offset = 0; offset < size;) {
+    const size_t piece = chunk_size > 0 ? std::min(chunk_size, size - offset) : size - offset;
+    {
+      ScopedSpan span("StoreAsync");
+      if (!it->second->Write(data + offset, piece)) return false;
+    }
+    {
+      ScopedSpan span("FlushAsync");
+      if (!it->second->Flush()) return false;
+    }
+    offset += piece;
+  }
+  s.bytes_received += size;
+  return true;
+}
+
+}  // namespace
+
+void FakeBluetoothConfigure(const FakeBluetoothOptions& options) {
+  RunOnWorker([options]() { Stack().options = options; });
+}
+
+std::string FakeBluetoothDeviceId(int index) {
+  char id[16];
+  std::snprintf(id, sizeof(id), "FAKE-BT-%04d", index);
+  return id;
+}
+
+uint64_t FakeBluetoothBytesReceived() {
+  return Stack().bytes_received.load();
+}
+
+uint64_t FakeBluetoothTasksRun() {
+  return Stack().tasks_run.load();
+}
+
+uint64_t FakeBluetoothLinksOpened() {
+  return Stack().links_opened.load();
+}
+
+void FakeBluetoothDropLink(const std::string& device_id) {
+  RunOnWorker([&device_id]() {
+    auto it = Stack().transports.find(device_id);
+    if (it != Stack().transports.end()) it->second->Close();
+  });
+}
+
+// --- bluetooth_winrt.h ---
+
+void BluetoothWinRtInit() {
+  StartWorker();
+}
+
+std::vector<SppDeviceInfo> BluetoothFindAllSppDevices() {
+  std::vector<SppDeviceInfo> devices;
+  RunOnWorker([&devices]() { devices = ScanImpl(); });
+  return devices;
+}
+
+void BluetoothFindAllSppDevicesAsync(std::function<void(std::vector<SppDeviceInfo>)> callback) {
+  RunOnWorkerAsync([callback]() { callback(ScanImpl()); });
+}
+
+bool BluetoothPairDevice(const std::string& device_id) {
+  return IsKnownDevice(device_id);
+}
+
+void BluetoothPairDeviceAsync(const std::string& device_id, std::function<void(bool)> callback) {
+  RunOnWorkerAsync([device_id, callback]() { callback(IsKnownDevice(device_id)); });
+}
+
+void BluetoothPairDeviceAsyncSta(const std::string& device_id, std::function<void(bool)> callback) {
+  BluetoothPairDeviceAsync(device_id, std::move(callback));
+}
+
+bool BluetoothUnpairDevice(const std::string& device_id) {
+  BluetoothDisconnect(device_id);
+  return IsKnownDevice(device_id);
+}
+
+void BluetoothUnpairDeviceAsync(const std::string& device_id, std::function<void(bool)> callback) {
+  RunOnWorkerAsync([device_id, callback]() {
+    ForgetConnected(device_id);
+    Stack().transports.erase(device_id);
+    callback(IsKnownDevice(device_id));
+  });
+}
+
+bool BluetoothConnect(const std::string& device_id) {
+  bool ok = false;
+  RunOnWorker([&]() { ok = ConnectImpl(device_id); });
+  return ok;
+}
+
+void BluetoothConnectAsync(const std::string& device_id, std::function<void(bool)> callback) {
+  RunOnWorkerAsync([device_id, callback]() { callback(ConnectImpl(device_id)); });
+}
+
+void BluetoothConnectConcurrentAsync(const std::string& device_id, std::function<void(bool)> callback) {
+  RunOnWorkerAsync([device_id, callback]() {
+    if (HasLiveTransport(device_id)) {
+      callback(true);
+      return;
+    }
+    // The latency passes off the worker, as with Completed handlers.
+    int latency_us = Stack().options.connect_latency_us;
+    std::thread([device_id, callback, latency_us]() {
+      SleepUs(latency_us);
+      RunOnWorkerAsync([device_id, callback]() { callback(InstallImpl(device_id)); });
+    }).detach();
+  });
+}
+
+void BluetoothDisconnect(const std::string& device_id) {
+  ForgetConnected(device_id);
+  RunOnWorkerAsync([device_id]() {
+    ForgetConnected(device_id);
+    Stack().transports.erase(device_id);
+  });
+}
+
+bool BluetoothIsConnected(const std::string& device_id) {
+  FakeStack& s = Stack();
+  std::lock_guard<std::mutex> lock(s.connected_mutex);
+  return s.connected.count(device_id) != 0;
+}
+
+bool BluetoothSend(const std::string& device_id, const uint8_t* data, size_t size) {
+  bool ok = false;
+  RunOnWorker([&]() { ok = SendImpl(device_id, data, size); });
+  return ok;
+}
+
+void BluetoothSendAsync(const std::string& device_id,
+                        const uint8_t* data,
+                        size_t size,
+                        std::function<void(bool)> callback) {
+  auto copy = std::make_shared<std::vector<uint8_t>>(data, data + size);
+  RunOnWorkerAsync([device_id, copy, callback]() {
+    callback(SendImpl(device_id, copy->data(), copy->size()));
+  });
+}
+
+void BluetoothProbeAsync(const std::string& device_id,
+                         std::function<void(bool, const PrinterIdentity&)> callback) {
+  RunOnWorkerAsync([device_id, callback]() {
+    PrinterIdentity identity;
+    auto it = Stack().transports.find(device_id);
+    bool ok = it != Stack().transports.end() && ProbePrinterIdentity(it->second.get(), kProbeTimeoutMs, &identity);
+    callback(ok, identity);
+  });
+}
+
+}  // namespace flutter_thermal_printer_windows
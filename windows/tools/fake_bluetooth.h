@@ -0,0 +1,55 @@
+#ifndef FLUTTER_PLUGIN_TOOLS_FAKE_BLUETOOTH_H_
+#define FLUTTER_PLUGIN_TOOLS_FAKE_BLUETOOTH_H_
+
+#include <cstdint>
+#include <string>
+
+#include "fake_printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Simulated Bluetooth stack for host builds.
+///
+/// fake_bluetooth.cpp implements every function in bluetooth_winrt.h, so a
+/// host binary links it in place of bluetooth_winrt.cpp and the plugin's
+/// HandleMethodCall runs unchanged. Like the real backend, all device work
+/// runs on one FIFO worker thread (the MTA worker), a connect keeps a live
+/// link and replaces a dropped one, and each send is Write + Flush on a
+/// per-device PrinterTransport (here a FakePrinterTransport), in pieces of
+/// the registry's write chunk size.
+struct FakeBluetoothOptions {
+  /// Devices reported by scans: "FAKE-BT-0000" .. "FAKE-BT-{count-1}", all
+  /// paired. Connecting to any other id fails.
+  int device_count = 8;
+  /// Time the worker spends in FromIdAsync + ConnectAsync.
+  int connect_latency_us = 0;
+  /// Time the worker spends in a scan.
+  int scan_latency_us = 0;
+  /// Link model of every connected printer.
+  FakePrinterOptions printer;
+};
+
+/// Replaces the options. Call before the plugin is created; devices already
+/// connected keep their old link model.
+void FakeBluetoothConfigure(const FakeBluetoothOptions& options);
+
+/// Id of simulated device [index].
+std::string FakeBluetoothDeviceId(int index);
+
+/// Bytes received by all simulated printers, including disconnected ones.
+uint64_t FakeBluetoothBytesReceived();
+
+/// Tasks run on the simulated MTA worker so far.
+uint64_t FakeBluetoothTasksRun();
+
+/// Links opened so far (each one pays [connect_latency_us]).
+uint64_t FakeBluetoothLinksOpened();
+
+/// Drops the link to [device_id] as if the printer went out of range: its
+/// transport fails from now on but stays registered, like a dead socket.
+/// Returns after the worker has done it.
+void FakeBluetoothDropLink(const std::string& device_id);
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TOOLS_FAKE_BLUETOOTH_H_
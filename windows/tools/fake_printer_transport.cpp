@@ -0,0 +1,104 @@
+#include "fake_printer_transport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+void SleepMicros(int64_t us) {
+  if (us > 0) std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+}  // namespace
+
+FakePrinterTransport::FakePrinterTransport(FakePrinterOptions options)
+    : options_(std::move(options)) {}
+
+bool FakePrinterTransport::Write(const uint8_t* data, size_t size) {
+  if (closed_.load()) return false;
+  int64_t cost_us = options_.write_latency_us;
+  if (options_.bytes_per_second > 0) {
+    cost_us += static_cast<int64_t>(size * 1e6 / options_.bytes_per_second);
+  }
+  SleepMicros(cost_us);
+  ScanForRequests(data, size);
+  bytes_written_ += size;
+  writes_++;
+  return true;
+}
+
+bool FakePrinterTransport::Flush() {
+  if (closed_.load()) return false;
+  SleepMicros(options_.flush_latency_us);
+  flushes_++;
+  return true;
+}
+
+int FakePrinterTransport::Read(uint8_t* buffer, size_t capacity, int timeout_ms) {
+  if (closed_.load()) return -1;
+  reads_++;
+  {
+    std::lock_guard<std::mutex> lock(reply_mutex_);
+    if (!replies_.empty()) {
+      size_t n = std::min(capacity, replies_.size());
+      std::copy(replies_.begin(), replies_.begin() + n, buffer);
+      replies_.erase(replies_.begin(), replies_.begin() + n);
+      return static_cast<int>(n);
+    }
+  }
+  // Nothing requested: behave like a silent printer and time out.
+  SleepMicros(static_cast<int64_t>(timeout_ms) * 1000);
+  return 0;
+}
+
+void FakePrinterTransport::Close() {
+  closed_.store(true);
+}
+
+void FakePrinterTransport::ScanForRequests(const uint8_t* data, size_t size) {
+  // Requests are three bytes; each is matched when its last byte arrives,
+  // looking back over the previous write's last two bytes.
+  auto at = [&](size_t i) -> uint8_t { return i < 2 ? tail_[i] : data[i - 2]; };
+  auto extended = [this](const std::string& text) {
+    if (text.empty()) return;
+    replies_.push_back(0x5F);
+    replies_.insert(replies_.end(), text.begin(), text.end());
+    replies_.push_back(0x00);
+  };
+  std::lock_guard<std::mutex> lock(reply_mutex_);
+  for (size_t i = 2; i < size + 2; i++) {
+    uint8_t a = at(i - 2);
+    uint8_t b = at(i - 1);
+    uint8_t n = at(i);
+    if (a == 0x10 && b == 0x04) {
+      replies_.insert(replies_.end(), options_.status_reply.begin(), options_.status_reply.end());
+    } else if (a == 0x1D && b == 0x49) {
+      switch (n) {
+        case 67:
+          extended(options_.model_name);
+          break;
+        case 66:
+          extended(options_.manufacturer);
+          break;
+        case 65:
+          extended(options_.firmware_version);
+          break;
+        default:
+          replies_.insert(replies_.end(), options_.id_reply.begin(), options_.id_reply.end());
+          break;
+      }
+    }
+  }
+  if (size >= 2) {
+    tail_[0] = data[size - 2];
+    tail_[1] = data[size - 1];
+  } else if (size == 1) {
+    tail_[0] = tail_[1];
+    tail_[1] = data[0];
+  }
+}
+
+}  // namespace flutter_thermal_printer_windows
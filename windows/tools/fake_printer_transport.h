@@ -0,0 +1,68 @@
+#ifndef FLUTTER_PLUGIN_TOOLS_FAKE_PRINTER_TRANSPORT_H_
+#define FLUTTER_PLUGIN_TOOLS_FAKE_PRINTER_TRANSPORT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Link and firmware behaviour of the simulated printer.
+struct FakePrinterOptions {
+  /// Sustained link throughput; 0 = unlimited. Bluetooth SPP is ~10-20 KB/s.
+  double bytes_per_second = 0;
+  /// Fixed cost per Write and per Flush (round trip on the link).
+  int write_latency_us = 0;
+  int flush_latency_us = 0;
+  /// Reply to DLE EOT n (real-time status). 0x12 = online, no error.
+  std::vector<uint8_t> status_reply = {0x12};
+  /// Reply to GS I 1..3 (printer ID).
+  std::vector<uint8_t> id_reply = {0x20};
+  /// Sent as '_' + text + NUL for GS I 67, 66 and 65; empty = the request is
+  /// ignored, like on printers without the extended IDs.
+  std::string model_name = "FAKE-58";
+  std::string manufacturer = "FAKE";
+  std::string firmware_version = "1.00";
+};
+
+/// In-process printer for host tools: sleeps to model the link, counts
+/// traffic and answers status/ID requests. Counters are safe to read from
+/// other threads.
+class FakePrinterTransport : public PrinterTransport {
+ public:
+  explicit FakePrinterTransport(FakePrinterOptions options = FakePrinterOptions());
+
+  bool Write(const uint8_t* data, size_t size) override;
+  bool Flush() override;
+  int Read(uint8_t* buffer, size_t capacity, int timeout_ms) override;
+  void Close() override;
+  bool IsAlive() override { return !closed_.load(); }
+
+  uint64_t bytes_written() const { return bytes_written_.load(); }
+  uint64_t writes() const { return writes_.load(); }
+  uint64_t flushes() const { return flushes_.load(); }
+  uint64_t reads() const { return reads_.load(); }
+
+ private:
+  void ScanForRequests(const uint8_t* data, size_t size);
+
+  FakePrinterOptions options_;
+  std::atomic<bool> closed_{false};
+  std::atomic<uint64_t> bytes_written_{0};
+  std::atomic<uint64_t> writes_{0};
+  std::atomic<uint64_t> flushes_{0};
+  std::atomic<uint64_t> reads_{0};
+  std::mutex reply_mutex_;
+  std::deque<uint8_t> replies_;
+  /// Tail of the previous write, so requests split across writes are still seen.
+  uint8_t tail_[2] = {0, 0};
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TOOLS_FAKE_PRINTER_TRANSPORT_H_
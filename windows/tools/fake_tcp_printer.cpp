@@ -0,0 +1,143 @@
+#include "fake_tcp_printer.h"
+
+#include <cstring>
+
+#include "tcp_transport.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_thermal_printer_windows {
+
+namespace {
+
+constexpr uintptr_t kInvalidSocket = static_cast<uintptr_t>(-1);
+
+#ifdef _WIN32
+using NativeSocket = SOCKET;
+void CloseListener(uintptr_t s) { closesocket(static_cast<SOCKET>(s)); }
+#else
+using NativeSocket = int;
+void CloseListener(uintptr_t s) {
+  // shutdown wakes a thread blocked in accept(); close alone does not on Linux.
+  shutdown(static_cast<int>(s), SHUT_RDWR);
+  close(static_cast<int>(s));
+}
+#endif
+
+}  // namespace
+
+FakeTcpPrinter::FakeTcpPrinter(FakePrinterOptions options)
+    : options_(std::move(options)), listener_(kInvalidSocket) {}
+
+FakeTcpPrinter::~FakeTcpPrinter() {
+  Stop();
+}
+
+bool FakeTcpPrinter::Start() {
+#ifdef _WIN32
+  WSADATA data;
+  if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+#endif
+  NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (static_cast<uintptr_t>(s) == kInvalidSocket) return false;
+  sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 16) != 0 ||
+      getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    CloseListener(static_cast<uintptr_t>(s));
+    return false;
+  }
+  listener_ = static_cast<uintptr_t>(s);
+  port_ = ntohs(addr.sin_port);
+  stopping_.store(false);
+  accept_thread_ = std::thread([this]() { AcceptLoop(); });
+  return true;
+}
+
+void FakeTcpPrinter::Stop() {
+  if (stopping_.exchange(true)) return;
+  if (listener_ != kInvalidSocket) {
+    CloseListener(listener_);
+    listener_ = kInvalidSocket;
+  }
+  if (accept_thread_.joinable()) accept_thread_.join();
+  DropConnections();
+  std::vector<std::unique_ptr<Client>> clients;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients.swap(clients_);
+  }
+  for (auto& client : clients) {
+    if (client->thread.joinable()) client->thread.join();
+  }
+}
+
+std::string FakeTcpPrinter::printer_id() const {
+  return "tcp:127.0.0.1:" + std::to_string(port_);
+}
+
+std::vector<uint8_t> FakeTcpPrinter::received() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return received_;
+}
+
+void FakeTcpPrinter::DropConnections() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& client : clients_) client->socket->Abort();
+}
+
+void FakeTcpPrinter::AcceptLoop() {
+  while (!stopping_.load()) {
+    NativeSocket s = accept(static_cast<NativeSocket>(listener_), nullptr, nullptr);
+    if (static_cast<uintptr_t>(s) == kInvalidSocket) {
+      if (stopping_.load()) return;
+      continue;
+    }
+    connections_++;
+    auto client = std::make_unique<Client>();
+    client->socket = std::make_unique<TcpTransport>(static_cast<uintptr_t>(s));
+    TcpTransport* socket = client->socket.get();
+    std::lock_guard<std::mutex> lock(mutex_);
+    client->thread = std::thread([this, socket]() { Serve(socket); });
+    clients_.push_back(std::move(client));
+  }
+}
+
+void FakeTcpPrinter::Serve(TcpTransport* socket) {
+  FakePrinterTransport printer(options_);
+  std::vector<uint8_t> buffer(64 * 1024);
+  uint8_t reply[64];
+  while (!stopping_.load()) {
+    int n = socket->Read(buffer.data(), buffer.size(), 50);
+    if (n < 0) break;
+    if (n == 0) continue;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      received_.insert(received_.end(), buffer.begin(), buffer.begin() + n);
+    }
+    bytes_received_ += static_cast<uint64_t>(n);
+    printer.Write(buffer.data(), static_cast<size_t>(n));
+    int r;
+    while ((r = printer.Read(reply, sizeof(reply), 0)) > 0) {
+      if (!socket->Write(reply, static_cast<size_t>(r))) break;
+    }
+  }
+  // The socket is closed by Stop(), after DropConnections() can no longer reach it.
+}
+
+}  // namespace flutter_thermal_printer_windows
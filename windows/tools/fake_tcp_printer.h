@@ -0,0 +1,69 @@
+#ifndef FLUTTER_PLUGIN_TOOLS_FAKE_TCP_PRINTER_H_
+#define FLUTTER_PLUGIN_TOOLS_FAKE_TCP_PRINTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+class TcpTransport;
+
+/// LAN printer on a loopback raw port for tests and tools. Each accepted
+/// connection feeds a FakePrinterTransport, so throughput limits and
+/// status/ID replies behave as in the in-process fake.
+class FakeTcpPrinter {
+ public:
+  explicit FakeTcpPrinter(FakePrinterOptions options = FakePrinterOptions());
+  ~FakeTcpPrinter();
+
+  FakeTcpPrinter(const FakeTcpPrinter&) = delete;
+  FakeTcpPrinter& operator=(const FakeTcpPrinter&) = delete;
+
+  /// Listens on 127.0.0.1 at an ephemeral port. Returns false on failure.
+  bool Start();
+  void Stop();
+
+  uint16_t port() const { return port_; }
+  /// "tcp:127.0.0.1:PORT", the id the plugin uses for this printer.
+  std::string printer_id() const;
+
+  uint64_t connections() const { return connections_.load(); }
+  uint64_t bytes_received() const { return bytes_received_.load(); }
+  /// Everything received so far, over all connections, in arrival order.
+  std::vector<uint8_t> received() const;
+
+  /// Close every open connection from the printer side, like firmware that
+  /// drops idle clients.
+  void DropConnections();
+
+ private:
+  struct Client {
+    std::unique_ptr<TcpTransport> socket;
+    std::thread thread;
+  };
+
+  void AcceptLoop();
+  void Serve(TcpTransport* socket);
+
+  FakePrinterOptions options_;
+  uintptr_t listener_;
+  uint16_t port_ = 0;
+  std::atomic<bool> stopping_{false};
+  std::thread accept_thread_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Client>> clients_;
+  std::vector<uint8_t> received_;
+  std::atomic<uint64_t> connections_{0};
+  std::atomic<uint64_t> bytes_received_{0};
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TOOLS_FAKE_TCP_PRINTER_H_
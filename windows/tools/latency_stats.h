@@ -0,0 +1,48 @@
+#ifndef FLUTTER_PLUGIN_TOOLS_LATENCY_STATS_H_
+#define FLUTTER_PLUGIN_TOOLS_LATENCY_STATS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+/// Latency samples (microseconds) with nearest-rank percentiles. Not thread-safe.
+class LatencyStats {
+ public:
+  void Add(int64_t us) {
+    samples_.push_back(us);
+    sorted_ = false;
+  }
+
+  void Merge(const LatencyStats& other) {
+    samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+    sorted_ = false;
+  }
+
+  size_t count() const { return samples_.size(); }
+
+  /// [p] in 0..100. Returns 0 with no samples.
+  int64_t Percentile(double p) {
+    if (samples_.empty()) return 0;
+    if (!sorted_) {
+      std::sort(samples_.begin(), samples_.end());
+      sorted_ = true;
+    }
+    double rank = std::ceil(p / 100.0 * samples_.size());
+    size_t index = rank < 1 ? 0 : static_cast<size_t>(rank) - 1;
+    return samples_[std::min(index, samples_.size() - 1)];
+  }
+
+  int64_t Max() { return Percentile(100); }
+
+ private:
+  std::vector<int64_t> samples_;
+  bool sorted_ = true;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TOOLS_LATENCY_STATS_H_
@@ -0,0 +1,448 @@
+// End-to-end load test of the plugin's native path: method-call decoding,
+// HandleMethodCall dispatch, worker queueing, the transport and the reply
+// reaching a flutter::MethodResultFunctions. Runs headless on a host build:
+// fake_bluetooth.cpp stands in for the WinRT backend, or --tcp uses loopback
+// FakeTcpPrinters through the real TCP transport.
+//
+//   load_harness [--printers N] [--calls N] [--in-flight N] [--job-bytes N]
+//                [--mix SEND:CONNECT:STATE] [--tcp] [--link-bps N]
+//                [--write-latency-us N] [--connect-latency-us N]
+//                [--timeout-s N] [--seed N] [--spans FILE]
+//
+// Calls are issued from one thread, as the Flutter platform thread does, with
+// at most --in-flight outstanding. Latency runs from the encoded call
+// arriving to the reply envelope being encoded. Exits 1 if any result was
+// lost (never completed or dropped without a reply) or completed twice.
+// --spans records native spans during the run and writes them to FILE as
+// Chrome trace-event JSON (open in Perfetto or chrome://tracing).
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_call.h>
+#include <flutter/method_result_functions.h>
+#include <flutter/standard_method_codec.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fake_bluetooth.h"
+#include "fake_tcp_printer.h"
+#include "flutter_thermal_printer_windows_plugin.h"
+#include "latency_stats.h"
+#include "tcp_printers.h"
+#include "trace_spans.h"
+
+using namespace flutter_thermal_printer_windows;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Method { kSend = 0, kConnect = 1, kState = 2, kMethodCount = 3 };
+const char* const kMethodNames[kMethodCount] = {"sendRawCommands", "connectToDevice",
+                                                "getConnectionState"};
+
+enum class Outcome : int { kPending = 0, kSuccess, kError, kNotImplemented };
+
+struct CallSlot {
+  Method method = kSend;
+  Clock::time_point start;
+  std::atomic<int> replies{0};
+  std::atomic<bool> released{false};
+  std::atomic<int> outcome{static_cast<int>(Outcome::kPending)};
+  std::atomic<int64_t> latency_us{0};
+};
+
+/// Bookkeeping for every issued call. Replies arrive on worker threads.
+class CallTracker {
+ public:
+  explicit CallTracker(size_t capacity) : slots_(capacity) {}
+
+  CallSlot& slot(size_t index) { return slots_[index]; }
+
+  void Begin(size_t index, Method method) {
+    slots_[index].method = method;
+    slots_[index].start = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_++;
+    live_results_++;
+  }
+
+  void Reply(size_t index, Outcome outcome, const std::string& error_code) {
+    CallSlot& s = slots_[index];
+    const int64_t us =
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - s.start).count();
+    if (s.replies.fetch_add(1) != 0) {
+      duplicates_++;
+      return;
+    }
+    s.latency_us.store(us);
+    s.outcome.store(static_cast<int>(outcome));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (outcome == Outcome::kError) error_codes_[error_code]++;
+    last_reply_ = Clock::now();
+    in_flight_--;
+    cv_.notify_all();
+  }
+
+  /// The plugin destroyed the result; without a reply this call is lost.
+  void Released(size_t index) {
+    CallSlot& s = slots_[index];
+    s.released.store(true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (s.replies.load() == 0) in_flight_--;
+    live_results_--;
+    cv_.notify_all();
+  }
+
+  void WaitForInFlightBelow(size_t limit) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return in_flight_ < limit; });
+  }
+
+  /// Waits until every call has replied and the plugin has released every
+  /// result, so no worker touches the tracker afterwards. Returns false if
+  /// calls are still outstanding at [deadline].
+  bool WaitForAll(Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_until(lock, deadline, [&] { return in_flight_ == 0 && live_results_ == 0; });
+  }
+
+  uint64_t duplicates() const { return duplicates_.load(); }
+
+  Clock::time_point last_reply() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_reply_;
+  }
+
+  std::map<std::string, uint64_t> error_codes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_codes_;
+  }
+
+ private:
+  std::vector<CallSlot> slots_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t in_flight_ = 0;
+  size_t live_results_ = 0;
+  Clock::time_point last_reply_;
+  std::map<std::string, uint64_t> error_codes_;
+  std::atomic<uint64_t> duplicates_{0};
+};
+
+/// MethodResultFunctions that encode the reply envelope, as the engine
+/// channel would, and report to the tracker, including being dropped.
+class TrackedResult : public flutter::MethodResultFunctions<EncodableValue> {
+ public:
+  TrackedResult(CallTracker* tracker, size_t index)
+      : flutter::MethodResultFunctions<EncodableValue>(
+            [tracker, index](const EncodableValue* value) {
+              flutter::StandardMethodCodec::GetInstance().EncodeSuccessEnvelope(value);
+              tracker->Reply(index, Outcome::kSuccess, "");
+            },
+            [tracker, index](const std::string& code, const std::string& message,
+                             const EncodableValue* details) {
+              flutter::StandardMethodCodec::GetInstance().EncodeErrorEnvelope(code, message, details);
+              tracker->Reply(index, Outcome::kError, code);
+            },
+            [tracker, index]() { tracker->Reply(index, Outcome::kNotImplemented, ""); }),
+        tracker_(tracker),
+        index_(index) {}
+
+  ~TrackedResult() override { tracker_->Released(index_); }
+
+ private:
+  CallTracker* tracker_;
+  size_t index_;
+};
+
+struct Options {
+  int printers = 32;
+  size_t calls = 20000;
+  size_t in_flight = 1000;
+  size_t job_bytes = 512;
+  int mix[kMethodCount] = {70, 10, 20};
+  bool tcp = false;
+  double link_bps = 0;
+  int write_latency_us = 0;
+  int connect_latency_us = 0;
+  int timeout_s = 60;
+  uint32_t seed = 1;
+  std::string spans_path;
+};
+
+void Usage(const char* argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--printers N] [--calls N] [--in-flight N] [--job-bytes N]\n"
+               "          [--mix SEND:CONNECT:STATE] [--tcp] [--link-bps N]\n"
+               "          [--write-latency-us N] [--connect-latency-us N]\n"
+               "          [--timeout-s N] [--seed N] [--spans FILE]\n",
+               argv0);
+}
+
+bool ParseArgs(int argc, char** argv, Options* o) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (arg == "--tcp") {
+      o->tcp = true;
+      continue;
+    }
+    if (!value) return false;
+    i++;
+    if (arg == "--printers") {
+      o->printers = std::max(1, std::atoi(value));
+    } else if (arg == "--calls") {
+      o->calls = static_cast<size_t>(std::max(1, std::atoi(value)));
+    } else if (arg == "--in-flight") {
+      o->in_flight = static_cast<size_t>(std::max(1, std::atoi(value)));
+    } else if (arg == "--job-bytes") {
+      o->job_bytes = static_cast<size_t>(std::max(1, std::atoi(value)));
+    } else if (arg == "--mix") {
+      if (std::sscanf(value, "%d:%d:%d", &o->mix[0], &o->mix[1], &o->mix[2]) != 3 ||
+          o->mix[0] < 0 || o->mix[1] < 0 || o->mix[2] < 0 || o->mix[0] + o->mix[1] + o->mix[2] == 0) {
+        return false;
+      }
+    } else if (arg == "--link-bps") {
+      o->link_bps = std::atof(value);
+    } else if (arg == "--write-latency-us") {
+      o->write_latency_us = std::atoi(value);
+    } else if (arg == "--connect-latency-us") {
+      o->connect_latency_us = std::atoi(value);
+    } else if (arg == "--timeout-s") {
+      o->timeout_s = std::max(1, std::atoi(value));
+    } else if (arg == "--seed") {
+      o->seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (arg == "--spans") {
+      o->spans_path = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// A receipt-like job of about [size] bytes with redundant mode changes, so
+/// the peephole optimizer has work to do.
+std::vector<uint8_t> MakeJob(size_t size) {
+  std::vector<uint8_t> job = {0x1B, 0x40};
+  int line = 0;
+  while (job.size() < size) {
+    const uint8_t bold = static_cast<uint8_t>(line % 2);
+    const uint8_t chunk[] = {0x1B, 0x45, bold, 0x1B, 0x45, bold, 'I', 't', 'e', 'm', ' ',
+                             static_cast<uint8_t>('0' + line % 10), 0x0A};
+    job.insert(job.end(), chunk, chunk + sizeof(chunk));
+    line++;
+  }
+  job.resize(size);
+  return job;
+}
+
+EncodableValue PrinterMap(const std::string& id) {
+  EncodableMap printer;
+  printer[EncodableValue("id")] = EncodableValue(id);
+  printer[EncodableValue("name")] = EncodableValue("Load test printer");
+  printer[EncodableValue("macAddress")] = EncodableValue(id);
+  return EncodableValue(printer);
+}
+
+std::unique_ptr<std::vector<uint8_t>> EncodeCall(Method method, const std::string& id,
+                                                 const std::vector<uint8_t>& job) {
+  EncodableMap args;
+  switch (method) {
+    case kSend:
+      args[EncodableValue("printer")] = PrinterMap(id);
+      args[EncodableValue("bytes")] = EncodableValue(job);
+      break;
+    case kConnect:
+      args = std::get<EncodableMap>(PrinterMap(id));
+      break;
+    case kState:
+      args[EncodableValue("printerId")] = EncodableValue(id);
+      break;
+    default:
+      break;
+  }
+  flutter::MethodCall<EncodableValue> call(kMethodNames[method],
+                                           std::make_unique<EncodableValue>(args));
+  return flutter::StandardMethodCodec::GetInstance().EncodeMethodCall(call);
+}
+
+/// Decodes [message] and hands it to the plugin, like the engine channel.
+void Dispatch(FlutterThermalPrinterWindowsPlugin& plugin, CallTracker& tracker, size_t index,
+              Method method, const std::vector<uint8_t>& message) {
+  tracker.Begin(index, method);
+  auto call = flutter::StandardMethodCodec::GetInstance().DecodeMethodCall(message.data(),
+                                                                           message.size());
+  plugin.HandleMethodCall(*call, std::make_unique<TrackedResult>(&tracker, index));
+}
+
+double Seconds(Clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseArgs(argc, argv, &options)) {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  FakePrinterOptions link;
+  link.bytes_per_second = options.link_bps;
+  link.write_latency_us = options.write_latency_us;
+  std::vector<std::unique_ptr<FakeTcpPrinter>> tcp_printers;
+  std::vector<std::string> ids;
+  if (options.tcp) {
+    for (int i = 0; i < options.printers; i++) {
+      tcp_printers.push_back(std::make_unique<FakeTcpPrinter>(link));
+      if (!tcp_printers.back()->Start()) {
+        std::fprintf(stderr, "could not start fake TCP printer %d\n", i);
+        return 2;
+      }
+      ids.push_back(tcp_printers.back()->printer_id());
+    }
+  } else {
+    FakeBluetoothOptions bt;
+    bt.device_count = options.printers;
+    bt.connect_latency_us = options.connect_latency_us;
+    bt.printer = link;
+    FakeBluetoothConfigure(bt);
+    for (int i = 0; i < options.printers; i++) ids.push_back(FakeBluetoothDeviceId(i));
+  }
+
+  FlutterThermalPrinterWindowsPlugin plugin;
+  const std::vector<uint8_t> job = MakeJob(options.job_bytes);
+  const size_t warmup = ids.size();
+  CallTracker tracker(warmup + options.calls);
+  const auto timeout = std::chrono::seconds(options.timeout_s);
+
+  // Connect every printer first so sends measure the steady state.
+  for (size_t i = 0; i < warmup; i++) {
+    Dispatch(plugin, tracker, i, kConnect, *EncodeCall(kConnect, ids[i], job));
+  }
+  if (!tracker.WaitForAll(Clock::now() + timeout)) {
+    std::fprintf(stderr, "warm-up connects did not complete within %d s\n", options.timeout_s);
+    return 1;
+  }
+
+  std::mt19937 rng(options.seed);
+  std::discrete_distribution<int> pick_method({static_cast<double>(options.mix[0]),
+                                               static_cast<double>(options.mix[1]),
+                                               static_cast<double>(options.mix[2])});
+  std::uniform_int_distribution<size_t> pick_printer(0, ids.size() - 1);
+  uint64_t expected_bytes = 0;
+  if (!options.spans_path.empty()) SpansSetActive(true);
+  const Clock::time_point run_start = Clock::now();
+  for (size_t n = 0; n < options.calls; n++) {
+    const Method method = static_cast<Method>(pick_method(rng));
+    const std::string& id = ids[pick_printer(rng)];
+    auto message = EncodeCall(method, id, job);
+    tracker.WaitForInFlightBelow(options.in_flight);
+    Dispatch(plugin, tracker, warmup + n, method, *message);
+  }
+  const Clock::time_point issued = Clock::now();
+  const bool drained = tracker.WaitForAll(issued + timeout);
+  const Clock::time_point run_end = drained ? tracker.last_reply() : Clock::now();
+  if (!options.spans_path.empty()) {
+    SpansSetActive(false);
+    const std::string json = SpansExportChromeJson(true);
+    std::FILE* file = std::fopen(options.spans_path.c_str(), "wb");
+    if (!file || std::fwrite(json.data(), 1, json.size(), file) != json.size()) {
+      std::fprintf(stderr, "could not write spans to %s\n", options.spans_path.c_str());
+    }
+    if (file) std::fclose(file);
+  }
+
+  LatencyStats per_method[kMethodCount];
+  LatencyStats all;
+  uint64_t ok[kMethodCount] = {};
+  uint64_t errors[kMethodCount] = {};
+  uint64_t calls[kMethodCount] = {};
+  uint64_t pending = 0;
+  uint64_t dropped = 0;
+  for (size_t i = warmup; i < warmup + options.calls; i++) {
+    CallSlot& s = tracker.slot(i);
+    calls[s.method]++;
+    const Outcome outcome = static_cast<Outcome>(s.outcome.load());
+    if (outcome == Outcome::kPending) {
+      (s.released.load() ? dropped : pending)++;
+      continue;
+    }
+    if (outcome == Outcome::kSuccess) {
+      ok[s.method]++;
+      if (s.method == kSend) expected_bytes += job.size();
+    } else {
+      errors[s.method]++;
+    }
+    per_method[s.method].Add(s.latency_us.load());
+    all.Add(s.latency_us.load());
+  }
+
+  std::printf("%s printers: %d, calls: %zu, in flight: %zu, job: %zu bytes, mix %d:%d:%d\n",
+              options.tcp ? "TCP" : "Bluetooth (fake)", options.printers, options.calls,
+              options.in_flight, options.job_bytes, options.mix[0], options.mix[1], options.mix[2]);
+  std::printf("\n%-20s %8s %8s %6s %9s %9s %9s %9s\n", "method", "calls", "ok", "err", "p50 us",
+              "p99 us", "p999 us", "max us");
+  auto row = [](const char* name, uint64_t n, uint64_t good, uint64_t bad, LatencyStats& stats) {
+    std::printf("%-20s %8llu %8llu %6llu %9lld %9lld %9lld %9lld\n", name,
+                static_cast<unsigned long long>(n), static_cast<unsigned long long>(good),
+                static_cast<unsigned long long>(bad), static_cast<long long>(stats.Percentile(50)),
+                static_cast<long long>(stats.Percentile(99)),
+                static_cast<long long>(stats.Percentile(99.9)), static_cast<long long>(stats.Max()));
+  };
+  uint64_t total_ok = 0;
+  uint64_t total_errors = 0;
+  for (int m = 0; m < kMethodCount; m++) {
+    row(kMethodNames[m], calls[m], ok[m], errors[m], per_method[m]);
+    total_ok += ok[m];
+    total_errors += errors[m];
+  }
+  row("all", options.calls, total_ok, total_errors, all);
+
+  const double wall = Seconds(run_end - run_start);
+  std::printf("\nissue time: %.3f s, wall time to last reply: %.3f s\n", Seconds(issued - run_start),
+              wall);
+  std::printf("throughput: %.0f completed calls/s\n", wall > 0 ? all.count() / wall : 0.0);
+  uint64_t delivered = 0;
+  if (options.tcp) {
+    for (auto& p : tcp_printers) delivered += p->bytes_received();
+  } else {
+    delivered = FakeBluetoothBytesReceived();
+  }
+  std::printf("bytes at printers: %llu (%llu sent by successful sendRawCommands before optimizing)\n",
+              static_cast<unsigned long long>(delivered),
+              static_cast<unsigned long long>(expected_bytes));
+  for (const auto& entry : tracker.error_codes()) {
+    std::printf("error %s: %llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+  }
+  const uint64_t duplicates = tracker.duplicates();
+  std::printf("lost results: %llu (never completed: %llu, dropped without reply: %llu), "
+              "duplicate replies: %llu\n",
+              static_cast<unsigned long long>(pending + dropped),
+              static_cast<unsigned long long>(pending), static_cast<unsigned long long>(dropped),
+              static_cast<unsigned long long>(duplicates));
+  const int status = pending + dropped + duplicates == 0 ? 0 : 1;
+  if (!drained) {
+    // Workers still hold results that point at the tracker; do not unwind.
+    std::fflush(stdout);
+    std::_Exit(status);
+  }
+  if (options.tcp) TcpDisconnectAll();
+  return status;
+}
@@ -0,0 +1,125 @@
+// Throughput of the native image path: luma conversion + resampling to the
+// printer dot width, with and without the SIMD kernels, and the full
+// StreamRasterImage pipeline (resample + dither + GS v 0 bands).
+//
+//   resample_bench [--iterations N]
+//
+// Reports source megapixels per second; higher is better.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "image_resample.h"
+#include "raster_pipeline.h"
+
+using namespace flutter_thermal_printer_windows;
+
+namespace {
+
+struct Case {
+  const char* name;
+  int width;
+  int height;
+  int target_width;
+};
+
+const char* FilterName(ResampleFilter filter) {
+  switch (filter) {
+    case ResampleFilter::kAuto:
+      return "auto";
+    case ResampleFilter::kNearest:
+      return "nearest";
+    case ResampleFilter::kBilinear:
+      return "bilinear";
+    case ResampleFilter::kArea:
+      return "area";
+  }
+  return "?";
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Runs [body] [iterations] times and returns source megapixels per second.
+template <typename Body>
+double Measure(const Case& c, int iterations, Body body) {
+  body();  // warm caches and page in the buffers
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) body();
+  double seconds = SecondsSince(start);
+  return static_cast<double>(c.width) * c.height * iterations / seconds / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = 20;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = std::max(1, std::atoi(argv[++i]));
+    } else {
+      std::fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  const Case cases[] = {
+      {"photo 2048x1536 -> 576", 2048, 1536, 576},
+      {"logo 1000x400 -> 384", 1000, 400, 384},
+      {"icon 120x120 -> 576", 120, 120, 576},
+  };
+  const ResampleFilter filters[] = {ResampleFilter::kNearest, ResampleFilter::kBilinear,
+                                    ResampleFilter::kArea};
+  std::mt19937 rng(1);
+
+  std::printf("%-26s %-5s %-9s %12s %12s %8s\n", "case", "fmt", "filter", "scalar MP/s", "simd MP/s",
+              "speedup");
+  for (const Case& c : cases) {
+    for (SourcePixelFormat format : {SourcePixelFormat::kGray8, SourcePixelFormat::kRgba8888}) {
+      const int bpp = format == SourcePixelFormat::kRgba8888 ? 4 : 1;
+      std::vector<uint8_t> pixels(static_cast<size_t>(c.width) * c.height * bpp);
+      for (auto& b : pixels) b = static_cast<uint8_t>(rng());
+      RasterImageSource source;
+      source.pixels = pixels.data();
+      source.width = c.width;
+      source.height = c.height;
+      source.format = format;
+      source.target_width = c.target_width;
+      int out_w = 0;
+      int out_h = 0;
+      RasterOutputSize(source, &out_w, &out_h);
+      std::vector<uint8_t> row(out_w);
+
+      for (ResampleFilter filter : filters) {
+        source.filter = filter;
+        double mp[2];
+        for (int simd = 0; simd < 2; simd++) {
+          mp[simd] = Measure(c, iterations, [&]() {
+            LumaResampler resampler(source, out_w, out_h, simd != 0);
+            for (int y = 0; y < out_h; y++) resampler.Row(y, row.data());
+          });
+        }
+        std::printf("%-26s %-5s %-9s %12.1f %12.1f %7.2fx\n", c.name, bpp == 4 ? "rgba" : "gray",
+                    FilterName(filter), mp[0], mp[1], mp[1] / mp[0]);
+      }
+
+      source.filter = ResampleFilter::kAuto;
+      size_t bytes = 0;
+      double pipeline = Measure(c, iterations, [&]() {
+        StreamRasterImage(source, [&](const uint8_t*, size_t size) {
+          bytes += size;
+          return true;
+        });
+      });
+      std::printf("%-26s %-5s %-9s %12s %12.1f   (StreamRasterImage, dithered)\n", c.name,
+                  bpp == 4 ? "rgba" : "gray", "pipeline", "-", pipeline);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,240 @@
+// Replays a trace captured with startTraceCapture through the transport layer.
+//
+//   trace_replay TRACE [--speed N] [--bytes-per-sec N] [--write-latency-us N]
+//                      [--flush-latency-us N] [--read-timeout-ms N]
+//                      [--tcp HOST[:PORT]]
+//
+// --speed 1 keeps the captured pace, 10 replays ten times faster and 0 runs
+// as fast as the transport allows. Each device replays on its own thread so
+// overlap between printers is preserved. Runs on any host against the fake
+// printer, so production traffic can be benchmarked off Windows. With --tcp
+// every device replays over its own connection to a LAN printer's raw port
+// instead (the fake-printer options are then ignored).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "fake_printer_transport.h"
+#include "latency_stats.h"
+#include "printer_transport.h"
+#include "tcp_transport.h"
+#include "trace_capture.h"
+
+namespace ftpw = flutter_thermal_printer_windows;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ReplayOptions {
+  std::string trace_path;
+  double speed = 1.0;
+  int read_timeout_ms = 20;
+  ftpw::FakePrinterOptions printer;
+  /// Replay against a LAN printer instead of the fake when set.
+  std::string tcp_host;
+  uint16_t tcp_port = ftpw::kRawPrintPort;
+};
+
+struct DeviceResult {
+  std::string device_id;
+  uint64_t bytes = 0;
+  uint64_t writes = 0;
+  uint64_t flushes = 0;
+  uint64_t reads = 0;
+  uint64_t failures = 0;
+  /// Worst delay between an op's scheduled and actual start.
+  int64_t max_lateness_us = 0;
+  ftpw::LatencyStats job_latency;
+};
+
+void PrintUsage() {
+  std::fprintf(stderr,
+               "usage: trace_replay TRACE [--speed N] [--bytes-per-sec N]\n"
+               "                          [--write-latency-us N] [--flush-latency-us N]\n"
+               "                          [--read-timeout-ms N] [--tcp HOST[:PORT]]\n");
+}
+
+bool ParseArgs(int argc, char** argv, ReplayOptions* options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    auto value = [&](double* out) {
+      if (i + 1 >= argc) return false;
+      *out = std::atof(argv[++i]);
+      return true;
+    };
+    double v = 0;
+    if (arg == "--speed") {
+      if (!value(&options->speed) || options->speed < 0) return false;
+    } else if (arg == "--bytes-per-sec") {
+      if (!value(&options->printer.bytes_per_second)) return false;
+    } else if (arg == "--write-latency-us") {
+      if (!value(&v)) return false;
+      options->printer.write_latency_us = static_cast<int>(v);
+    } else if (arg == "--flush-latency-us") {
+      if (!value(&v)) return false;
+      options->printer.flush_latency_us = static_cast<int>(v);
+    } else if (arg == "--tcp") {
+      if (i + 1 >= argc ||
+          !ftpw::ParseTcpPrinterId(std::string("tcp:") + argv[++i], &options->tcp_host,
+                                   &options->tcp_port)) {
+        return false;
+      }
+    } else if (arg == "--read-timeout-ms") {
+      if (!value(&v)) return false;
+      options->read_timeout_ms = static_cast<int>(v);
+    } else if (!arg.empty() && arg[0] != '-' && options->trace_path.empty()) {
+      options->trace_path = arg;
+    } else {
+      return false;
+    }
+  }
+  return !options->trace_path.empty();
+}
+
+std::unique_ptr<ftpw::PrinterTransport> MakeReplayTransport(const ReplayOptions& options) {
+  if (!options.tcp_host.empty()) {
+    return ftpw::TcpTransport::Connect(options.tcp_host, options.tcp_port);
+  }
+  return std::make_unique<ftpw::FakePrinterTransport>(options.printer);
+}
+
+void ReplayDevice(const ReplayOptions& options,
+                  const std::vector<ftpw::TraceRecord>& records,
+                  Clock::time_point start,
+                  DeviceResult* result) {
+  std::unique_ptr<ftpw::PrinterTransport> transport = MakeReplayTransport(options);
+  if (!transport) {
+    std::fprintf(stderr, "trace_replay: %s: cannot connect to %s:%u\n", result->device_id.c_str(),
+                 options.tcp_host.c_str(), static_cast<unsigned>(options.tcp_port));
+    result->failures++;
+    return;
+  }
+  std::unordered_map<uint64_t, Clock::time_point> job_start;
+  Clock::time_point last_op_done = start;
+  std::vector<uint8_t> read_buffer;
+  for (const auto& record : records) {
+    // Ops are stamped when they started, so each is issued at its captured
+    // start; the replay transport's own duration is not added to a wait.
+    if (options.speed > 0) {
+      auto due = start + std::chrono::microseconds(
+                             static_cast<int64_t>(record.timestamp_us / options.speed));
+      std::this_thread::sleep_until(due);
+      int64_t late = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - due).count();
+      if (late > result->max_lateness_us) result->max_lateness_us = late;
+    }
+    bool ok = true;
+    switch (record.type) {
+      case ftpw::TraceRecordType::kWrite:
+        ok = transport->Write(record.data.data(), record.data.size());
+        result->bytes += record.data.size();
+        result->writes++;
+        last_op_done = Clock::now();
+        break;
+      case ftpw::TraceRecordType::kFlush:
+        ok = transport->Flush();
+        result->flushes++;
+        last_op_done = Clock::now();
+        break;
+      case ftpw::TraceRecordType::kRead:
+        read_buffer.resize(record.value > 0 ? static_cast<size_t>(record.value) : 1);
+        ok = transport->Read(read_buffer.data(), read_buffer.size(), options.read_timeout_ms) >= 0;
+        result->reads++;
+        last_op_done = Clock::now();
+        break;
+      case ftpw::TraceRecordType::kJobBegin:
+        job_start[record.value] = Clock::now();
+        break;
+      case ftpw::TraceRecordType::kJobEnd: {
+        auto it = job_start.find(record.value);
+        if (it != job_start.end()) {
+          // Time until the job's last op finished, not until the captured end mark.
+          auto end = last_op_done > it->second ? last_op_done : it->second;
+          result->job_latency.Add(
+              std::chrono::duration_cast<std::chrono::microseconds>(end - it->second).count());
+          job_start.erase(it);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    if (!ok) result->failures++;
+  }
+  transport->Close();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ReplayOptions options;
+  if (!ParseArgs(argc, argv, &options)) {
+    PrintUsage();
+    return 2;
+  }
+  ftpw::TraceReader reader;
+  if (!reader.Open(options.trace_path)) {
+    std::fprintf(stderr, "trace_replay: cannot open trace %s\n", options.trace_path.c_str());
+    return 1;
+  }
+  std::map<std::string, std::vector<ftpw::TraceRecord>> by_device;
+  ftpw::TraceRecord record;
+  uint64_t total_records = 0;
+  uint64_t trace_duration_us = 0;
+  while (reader.Next(&record)) {
+    trace_duration_us = record.timestamp_us;
+    by_device[record.device_id].push_back(std::move(record));
+    total_records++;
+  }
+
+  std::vector<DeviceResult> results(by_device.size());
+  std::vector<std::thread> threads;
+  Clock::time_point start = Clock::now();
+  size_t index = 0;
+  for (const auto& entry : by_device) {
+    results[index].device_id = entry.first;
+    threads.emplace_back(ReplayDevice, std::cref(options), std::cref(entry.second), start,
+                         &results[index]);
+    index++;
+  }
+  for (auto& t : threads) t.join();
+  double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::printf("trace: %s, %llu records, %zu devices, captured %.3f s\n",
+              options.trace_path.c_str(), static_cast<unsigned long long>(total_records),
+              by_device.size(), trace_duration_us / 1e6);
+  std::printf("replay: speed %g, wall %.3f s\n", options.speed, wall_s);
+  ftpw::LatencyStats all_jobs;
+  uint64_t total_bytes = 0;
+  uint64_t total_failures = 0;
+  for (auto& r : results) {
+    std::printf(
+        "  %s: %llu bytes, %llu writes, %llu flushes, %llu reads, %zu jobs, "
+        "job p50 %lld us, p99 %lld us, max %lld us, max lateness %lld us, failures %llu\n",
+        r.device_id.c_str(), static_cast<unsigned long long>(r.bytes),
+        static_cast<unsigned long long>(r.writes), static_cast<unsigned long long>(r.flushes),
+        static_cast<unsigned long long>(r.reads), r.job_latency.count(),
+        static_cast<long long>(r.job_latency.Percentile(50)),
+        static_cast<long long>(r.job_latency.Percentile(99)),
+        static_cast<long long>(r.job_latency.Max()), static_cast<long long>(r.max_lateness_us),
+        static_cast<unsigned long long>(r.failures));
+    all_jobs.Merge(r.job_latency);
+    total_bytes += r.bytes;
+    total_failures += r.failures;
+  }
+  std::printf("total: %llu bytes, %.1f KB/s, %zu jobs, job p50 %lld us, p99 %lld us, failures %llu\n",
+              static_cast<unsigned long long>(total_bytes),
+              wall_s > 0 ? total_bytes / 1024.0 / wall_s : 0.0, all_jobs.count(),
+              static_cast<long long>(all_jobs.Percentile(50)),
+              static_cast<long long>(all_jobs.Percentile(99)),
+              static_cast<unsigned long long>(total_failures));
+  return total_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+#include "trace_capture.h"
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace flutter_thermal_printer_windows {
+
+std::atomic<bool> g_trace_active{false};
+
+namespace {
+
+constexpr char kTraceMagic[4] = {'F', 'T', 'P', 'T'};
+constexpr uint8_t kTraceVersion = 1;
+constexpr size_t kTraceFileBuffer = 1 << 16;
+/// Upper bound for one payload so a corrupt length cannot allocate gigabytes.
+constexpr uint64_t kMaxTracePayload = 64ull << 20;
+
+std::mutex g_trace_mutex;
+std::FILE* g_trace_file = nullptr;
+std::chrono::steady_clock::time_point g_trace_start;
+uint64_t g_trace_last_us = 0;
+uint64_t g_trace_records = 0;
+uint64_t g_trace_next_job = 1;
+std::unordered_map<std::string, uint64_t> g_trace_devices;
+
+void PutByte(uint8_t b) {
+  std::fputc(b, g_trace_file);
+}
+
+void PutVarint(uint64_t v) {
+  while (v >= 0x80) {
+    PutByte(static_cast<uint8_t>(v | 0x80));
+    v >>= 7;
+  }
+  PutByte(static_cast<uint8_t>(v));
+}
+
+void PutBytes(const uint8_t* data, size_t size) {
+  PutVarint(size);
+  if (size > 0) std::fwrite(data, 1, size, g_trace_file);
+}
+
+/// Caller holds g_trace_mutex.
+uint64_t ElapsedUs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - g_trace_start).count());
+}
+
+/// Caller holds g_trace_mutex and has checked g_trace_file. Writes the common
+/// record prefix stamped [at_us], emitting a kDevice record first for unseen
+/// devices. Deltas are unsigned, so an op that started before the previous
+/// record (another device's) is stamped with that record's time.
+void BeginRecord(TraceRecordType type, const std::string& device_id, uint64_t at_us) {
+  uint64_t now_us = at_us;
+  if (now_us < g_trace_last_us) now_us = g_trace_last_us;
+  uint64_t delta = now_us - g_trace_last_us;
+  g_trace_last_us = now_us;
+
+  auto it = g_trace_devices.find(device_id);
+  if (it == g_trace_devices.end()) {
+    uint64_t index = g_trace_devices.size();
+    it = g_trace_devices.emplace(device_id, index).first;
+    PutByte(static_cast<uint8_t>(TraceRecordType::kDevice));
+    PutVarint(delta);
+    PutVarint(index);
+    PutBytes(reinterpret_cast<const uint8_t*>(device_id.data()), device_id.size());
+    delta = 0;
+  }
+  PutByte(static_cast<uint8_t>(type));
+  PutVarint(delta);
+  PutVarint(it->second);
+  g_trace_records++;
+}
+
+}  // namespace
+
+bool TraceStart(const std::string& path) {
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (g_trace_file) {
+    std::fclose(g_trace_file);
+    g_trace_file = nullptr;
+  }
+  g_trace_file = std::fopen(path.c_str(), "wb");
+  if (!g_trace_file) {
+    g_trace_active.store(false);
+    return false;
+  }
+  std::setvbuf(g_trace_file, nullptr, _IOFBF, kTraceFileBuffer);
+  std::fwrite(kTraceMagic, 1, sizeof(kTraceMagic), g_trace_file);
+  const uint8_t version[4] = {kTraceVersion, 0, 0, 0};
+  std::fwrite(version, 1, sizeof(version), g_trace_file);
+  g_trace_start = std::chrono::steady_clock::now();
+  g_trace_last_us = 0;
+  g_trace_records = 0;
+  g_trace_next_job = 1;
+  g_trace_devices.clear();
+  g_trace_active.store(true);
+  return true;
+}
+
+uint64_t TraceStop() {
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  g_trace_active.store(false);
+  if (!g_trace_file) return 0;
+  std::fclose(g_trace_file);
+  g_trace_file = nullptr;
+  const uint64_t records = g_trace_records;
+  g_trace_records = 0;
+  return records;
+}
+
+uint64_t TraceNowUs() {
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  return ElapsedUs();
+}
+
+void TraceWrite(const std::string& device_id, uint64_t start_us, const uint8_t* data, size_t size, bool ok) {
+  if (!TraceIsActive()) return;
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (!g_trace_file) return;
+  BeginRecord(TraceRecordType::kWrite, device_id, start_us);
+  PutByte(ok ? 1 : 0);
+  PutBytes(data, size);
+}
+
+void TraceFlush(const std::string& device_id, uint64_t start_us, bool ok) {
+  if (!TraceIsActive()) return;
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (!g_trace_file) return;
+  BeginRecord(TraceRecordType::kFlush, device_id, start_us);
+  PutByte(ok ? 1 : 0);
+}
+
+void TraceRead(const std::string& device_id, uint64_t start_us, size_t requested, const uint8_t* data, int result) {
+  if (!TraceIsActive()) return;
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (!g_trace_file) return;
+  BeginRecord(TraceRecordType::kRead, device_id, start_us);
+  PutVarint(requested);
+  PutByte(result >= 0 ? 1 : 0);
+  PutBytes(data, result > 0 ? static_cast<size_t>(result) : 0);
+}
+
+uint64_t TraceJobBegin(const std::string& device_id, size_t size) {
+  if (!TraceIsActive()) return 0;
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (!g_trace_file) return 0;
+  uint64_t job_id = g_trace_next_job++;
+  BeginRecord(TraceRecordType::kJobBegin, device_id, ElapsedUs());
+  PutVarint(job_id);
+  PutVarint(size);
+  return job_id;
+}
+
+void TraceJobEnd(const std::string& device_id, uint64_t job_id, bool ok) {
+  if (job_id == 0 || !TraceIsActive()) return;
+  std::lock_guard<std::mutex> lock(g_trace_mutex);
+  if (!g_trace_file) return;
+  BeginRecord(TraceRecordType::kJobEnd, device_id, ElapsedUs());
+  PutVarint(job_id);
+  PutByte(ok ? 1 : 0);
+}
+
+TraceReader::~TraceReader() {
+  if (file_) std::fclose(file_);
+}
+
+bool TraceReader::Open(const std::string& path) {
+  if (file_) std::fclose(file_);
+  file_ = std::fopen(path.c_str(), "rb");
+  if (!file_) return false;
+  char header[8];
+  if (std::fread(header, 1, sizeof(header), file_) != sizeof(header) ||
+      std::memcmp(header, kTraceMagic, sizeof(kTraceMagic)) != 0 ||
+      static_cast<uint8_t>(header[4]) != kTraceVersion) {
+    std::fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  timestamp_us_ = 0;
+  devices_.clear();
+  return true;
+}
+
+bool TraceReader::ReadVarint(uint64_t* out) {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = std::fgetc(file_);
+    if (c == EOF) return false;
+    v |= static_cast<uint64_t>(c & 0x7F) << shift;
+    if ((c & 0x80) == 0) {
+      *out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TraceReader::ReadBytes(std::vector<uint8_t>* out, size_t size) {
+  out->resize(size);
+  return size == 0 || std::fread(out->data(), 1, size, file_) == size;
+}
+
+bool TraceReader::Next(TraceRecord* out) {
+  if (!file_) return false;
+  for (;;) {
+    int type = std::fgetc(file_);
+    if (type == EOF) return false;
+    uint64_t delta = 0;
+    uint64_t device = 0;
+    if (!ReadVarint(&delta) || !ReadVarint(&device)) return false;
+    timestamp_us_ += delta;
+    uint64_t len = 0;
+    if (static_cast<TraceRecordType>(type) == TraceRecordType::kDevice) {
+      std::vector<uint8_t> id;
+      if (!ReadVarint(&len) || len > kMaxTracePayload || !ReadBytes(&id, len)) return false;
+      if (device != devices_.size()) return false;
+      devices_.emplace_back(id.begin(), id.end());
+      continue;
+    }
+    if (device >= devices_.size()) return false;
+    TraceRecord record;
+    record.type = static_cast<TraceRecordType>(type);
+    record.timestamp_us = timestamp_us_;
+    record.device_id = devices_[device];
+    int ok = 1;
+    switch (record.type) {
+      case TraceRecordType::kWrite:
+        ok = std::fgetc(file_);
+        if (!ReadVarint(&len) || len > kMaxTracePayload || !ReadBytes(&record.data, len)) return false;
+        break;
+      case TraceRecordType::kFlush:
+        ok = std::fgetc(file_);
+        break;
+      case TraceRecordType::kRead:
+        if (!ReadVarint(&record.value)) return false;
+        ok = std::fgetc(file_);
+        if (!ReadVarint(&len) || len > kMaxTracePayload || !ReadBytes(&record.data, len)) return false;
+        break;
+      case TraceRecordType::kJobBegin:
+        if (!ReadVarint(&record.value) || !ReadVarint(&record.size)) return false;
+        break;
+      case TraceRecordType::kJobEnd:
+        if (!ReadVarint(&record.value)) return false;
+        ok = std::fgetc(file_);
+        break;
+      default:
+        return false;
+    }
+    if (ok == EOF) return false;
+    record.ok = ok != 0;
+    *out = std::move(record);
+    return true;
+  }
+}
+
+TracingTransport::TracingTransport(std::string device_id, std::unique_ptr<PrinterTransport> inner)
+    : device_id_(std::move(device_id)), inner_(std::move(inner)) {}
+
+bool TracingTransport::Write(const uint8_t* data, size_t size) {
+  const uint64_t start_us = TraceIsActive() ? TraceNowUs() : 0;
+  bool ok = inner_->Write(data, size);
+  TraceWrite(device_id_, start_us, data, size, ok);
+  return ok;
+}
+
+bool TracingTransport::WriteGather(const TransportBuffer* buffers, size_t count) {
+  const uint64_t start_us = TraceIsActive() ? TraceNowUs() : 0;
+  bool ok = inner_->WriteGather(buffers, count);
+  // Recorded per buffer, as if written one by one, so replay needs no new record type.
+  for (size_t i = 0; i < count; i++) {
+    TraceWrite(device_id_, start_us, buffers[i].data, buffers[i].size, ok);
+  }
+  return ok;
+}
+
+bool TracingTransport::Flush() {
+  const uint64_t start_us = TraceIsActive() ? TraceNowUs() : 0;
+  bool ok = inner_->Flush();
+  TraceFlush(device_id_, start_us, ok);
+  return ok;
+}
+
+int TracingTransport::Read(uint8_t* buffer, size_t capacity, int timeout_ms) {
+  const uint64_t start_us = TraceIsActive() ? TraceNowUs() : 0;
+  int n = inner_->Read(buffer, capacity, timeout_ms);
+  TraceRead(device_id_, start_us, capacity, buffer, n);
+  return n;
+}
+
+void TracingTransport::Close() {
+  inner_->Close();
+}
+
+}  // namespace flutter_thermal_printer_windows
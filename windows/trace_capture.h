@@ -0,0 +1,119 @@
+#ifndef FLUTTER_PLUGIN_TRACE_CAPTURE_H_
+#define FLUTTER_PLUGIN_TRACE_CAPTURE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "printer_transport.h"
+
+namespace flutter_thermal_printer_windows {
+
+/// Binary per-device traffic trace (opt-in, see startTraceCapture).
+///
+/// File layout: "FTPT" magic, u8 version, 3 reserved bytes, then records:
+///   u8 type | varint timestamp delta (us, monotonic) | varint device index | payload
+/// Writes, flushes and reads are stamped when the call started, so replay
+/// issues each op at its captured time instead of after its duration.
+/// Payloads: kDevice = varint len + id (assigns the next device index),
+/// kWrite = u8 ok + varint len + bytes, kFlush = u8 ok,
+/// kRead = varint requested + u8 ok + varint len + bytes,
+/// kJobBegin = varint job id + varint size, kJobEnd = varint job id + u8 ok.
+enum class TraceRecordType : uint8_t {
+  kDevice = 0,
+  kWrite = 1,
+  kFlush = 2,
+  kRead = 3,
+  kJobBegin = 4,
+  kJobEnd = 5,
+};
+
+struct TraceRecord {
+  TraceRecordType type = TraceRecordType::kWrite;
+  /// Microseconds since capture start (start of the call for kWrite, kFlush
+  /// and kRead). Never earlier than the record before it.
+  uint64_t timestamp_us = 0;
+  std::string device_id;
+  /// Written bytes (kWrite) or bytes read back (kRead).
+  std::vector<uint8_t> data;
+  /// Job id (kJobBegin/kJobEnd), requested bytes (kRead).
+  uint64_t value = 0;
+  /// Job size in bytes (kJobBegin).
+  uint64_t size = 0;
+  bool ok = true;
+};
+
+extern std::atomic<bool> g_trace_active;
+
+/// Cheap check for the send path; capture calls below are no-ops when false.
+inline bool TraceIsActive() {
+  return g_trace_active.load(std::memory_order_relaxed);
+}
+
+/// Start capturing to [path] (truncates). Returns false if the file cannot be opened.
+bool TraceStart(const std::string& path);
+
+/// Stop capturing and close the file. Returns the number of records written,
+/// 0 if no capture was running.
+uint64_t TraceStop();
+
+/// Microseconds since capture start; taken before a transport call and passed
+/// as [start_us] below once it returns.
+uint64_t TraceNowUs();
+
+void TraceWrite(const std::string& device_id, uint64_t start_us, const uint8_t* data, size_t size, bool ok);
+void TraceFlush(const std::string& device_id, uint64_t start_us, bool ok);
+void TraceRead(const std::string& device_id, uint64_t start_us, size_t requested, const uint8_t* data, int result);
+
+/// Mark the start of a print job. Returns a job id for TraceJobEnd, 0 when not capturing.
+uint64_t TraceJobBegin(const std::string& device_id, size_t size);
+void TraceJobEnd(const std::string& device_id, uint64_t job_id, bool ok);
+
+/// Sequential reader for trace files (replay tool, tests).
+class TraceReader {
+ public:
+  TraceReader() = default;
+  ~TraceReader();
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  bool Open(const std::string& path);
+
+  /// Next non-kDevice record (device ids are resolved). False at end or on a corrupt record.
+  bool Next(TraceRecord* out);
+
+ private:
+  bool ReadVarint(uint64_t* out);
+  bool ReadBytes(std::vector<uint8_t>* out, size_t size);
+
+  std::FILE* file_ = nullptr;
+  uint64_t timestamp_us_ = 0;
+  std::vector<std::string> devices_;
+};
+
+/// Records every Write/Flush/Read of [inner] under [device_id] while capture is active.
+class TracingTransport : public PrinterTransport {
+ public:
+  TracingTransport(std::string device_id, std::unique_ptr<PrinterTransport> inner);
+
+  bool Write(const uint8_t* data, size_t size) override;
+  bool WriteGather(const TransportBuffer* buffers, size_t count) override;
+  bool Flush() override;
+  int Read(uint8_t* buffer, size_t capacity, int timeout_ms) override;
+  void Close() override;
+  bool IsAlive() override { return inner_->IsAlive(); }
+
+  PrinterTransport* inner() const { return inner_.get(); }
+
+ private:
+  std::string device_id_;
+  std::unique_ptr<PrinterTransport> inner_;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TRACE_CAPTURE_H_
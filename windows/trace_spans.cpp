@@ -0,0 +1,273 @@
+#include "trace_spans.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace flutter_thermal_printer_windows {
+
+std::atomic<bool> g_spans_active{false};
+
+namespace {
+
+const std::chrono::steady_clock::time_point g_span_epoch = std::chrono::steady_clock::now();
+
+/// Fields are atomic so the exporter may read a slot while its thread
+/// overwrites it; such slots are detected and skipped.
+struct SpanSlot {
+  std::atomic<const char*> name{nullptr};
+  std::atomic<const char*> detail{nullptr};
+  std::atomic<int64_t> start_us{0};
+  std::atomic<int64_t> duration_us{0};
+  std::atomic<uint32_t> tid{0};
+  std::atomic<bool> async{false};
+};
+
+/// Written by its owning thread only. A ring whose thread has exited is
+/// handed to the next new thread, keeping the spans already in it.
+struct SpanRing {
+  /// Index of the next span; slot = index % kSpanRingSize.
+  std::atomic<uint64_t> head{0};
+  /// 2 * index + 1 while span [index] is being written, 2 * (index + 1)
+  /// after; lets the exporter tell which slots it may have read torn.
+  std::atomic<uint64_t> sequence{0};
+  /// Spans below this index were exported with clear.
+  std::atomic<uint64_t> floor{0};
+  std::atomic<bool> in_use{false};
+  SpanSlot slots[kSpanRingSize];
+};
+
+struct SpanRegistry {
+  /// Guards everything below; taken when a thread records its first span,
+  /// for interning and for exports, never per span.
+  std::mutex mutex;
+  std::vector<std::unique_ptr<SpanRing>> rings;
+  std::map<uint32_t, const char*> thread_names;
+  /// Node-based, so interned pointers stay valid.
+  std::unordered_set<std::string> names;
+  uint32_t next_tid = 1;
+};
+
+/// Leaked on purpose: threads may record during static destruction.
+SpanRegistry& Registry() {
+  static auto* registry = new SpanRegistry();
+  return *registry;
+}
+
+struct ThreadSpans {
+  SpanRing* ring = nullptr;
+  uint32_t tid = 0;
+  const char* name = nullptr;
+  ~ThreadSpans() {
+    if (ring) ring->in_use.store(false, std::memory_order_release);
+  }
+};
+
+thread_local ThreadSpans t_spans;
+
+void ClaimRing(ThreadSpans* thread) {
+  SpanRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  thread->tid = registry.next_tid++;
+  if (thread->name) registry.thread_names[thread->tid] = thread->name;
+  for (const auto& ring : registry.rings) {
+    bool idle = false;
+    if (ring->in_use.compare_exchange_strong(idle, true, std::memory_order_acquire)) {
+      thread->ring = ring.get();
+      return;
+    }
+  }
+  registry.rings.push_back(std::make_unique<SpanRing>());
+  thread->ring = registry.rings.back().get();
+  thread->ring->in_use.store(true, std::memory_order_relaxed);
+}
+
+void Push(const char* name, const char* detail, int64_t start_us, int64_t duration_us, bool async) {
+  if (!name) return;
+  ThreadSpans& thread = t_spans;
+  if (!thread.ring) ClaimRing(&thread);
+  SpanRing& ring = *thread.ring;
+  const uint64_t index = ring.head.load(std::memory_order_relaxed);
+  // An exporter that sees any of this slot's stores also sees the odd
+  // sequence.
+  ring.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  SpanSlot& slot = ring.slots[index % kSpanRingSize];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.detail.store(detail, std::memory_order_relaxed);
+  slot.start_us.store(start_us, std::memory_order_relaxed);
+  slot.duration_us.store(std::max<int64_t>(duration_us, 0), std::memory_order_relaxed);
+  slot.tid.store(thread.tid, std::memory_order_relaxed);
+  slot.async.store(async, std::memory_order_relaxed);
+  ring.sequence.store(2 * index + 2, std::memory_order_release);
+  ring.head.store(index + 1, std::memory_order_release);
+}
+
+struct Span {
+  const char* name;
+  const char* detail;
+  int64_t start_us;
+  int64_t duration_us;
+  uint32_t tid;
+  bool async;
+};
+
+/// Copies the valid spans of [ring] into [out]. Returns the head read.
+uint64_t CollectRing(const SpanRing& ring, std::vector<Span>* out) {
+  const uint64_t head = ring.head.load(std::memory_order_acquire);
+  uint64_t first = head > kSpanRingSize ? head - kSpanRingSize : 0;
+  first = std::max(first, ring.floor.load(std::memory_order_relaxed));
+  const size_t start = out->size();
+  for (uint64_t i = first; i < head; i++) {
+    const SpanSlot& slot = ring.slots[i % kSpanRingSize];
+    out->push_back(Span{slot.name.load(std::memory_order_relaxed), slot.detail.load(std::memory_order_relaxed),
+                        slot.start_us.load(std::memory_order_relaxed),
+                        slot.duration_us.load(std::memory_order_relaxed), slot.tid.load(std::memory_order_relaxed),
+                        slot.async.load(std::memory_order_relaxed)});
+  }
+  // Slots the owner started overwriting while they were copied are dropped:
+  // the spans started so far reuse every slot index below
+  // touched - kSpanRingSize.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t sequence = ring.sequence.load(std::memory_order_relaxed);
+  const uint64_t touched = (sequence + 1) / 2;  // spans started so far
+  if (touched > kSpanRingSize && touched - kSpanRingSize > first) {
+    const size_t torn = static_cast<size_t>(std::min(touched - kSpanRingSize, head) - first);
+    out->erase(out->begin() + start, out->begin() + start + torn);
+  }
+  return head;
+}
+
+void AppendEscaped(std::string* out, const char* s) {
+  for (; *s; s++) {
+    const unsigned char c = static_cast<unsigned char>(*s);
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(static_cast<char>(c));
+    } else if (c < 0x20) {
+      char escaped[8];
+      std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      out->append(escaped);
+    } else {
+      out->push_back(static_cast<char>(c));
+    }
+  }
+}
+
+void AppendEvent(std::string* out,
+                 const Span& span,
+                 const char* phase,
+                 int64_t ts,
+                 uint64_t async_id,
+                 bool with_args) {
+  if (out->back() != '[') out->append(",\n");
+  out->append("{\"name\":\"");
+  AppendEscaped(out, span.name);
+  out->append("\",\"cat\":\"ftpw\",\"ph\":\"");
+  out->append(phase);
+  out->append("\",\"ts\":" + std::to_string(ts));
+  if (phase[0] == 'X') out->append(",\"dur\":" + std::to_string(span.duration_us));
+  if (async_id) out->append(",\"id\":" + std::to_string(async_id));
+  out->append(",\"pid\":1,\"tid\":" + std::to_string(span.tid));
+  if (with_args && span.detail) {
+    out->append(",\"args\":{\"detail\":\"");
+    AppendEscaped(out, span.detail);
+    out->append("\"}");
+  }
+  out->push_back('}');
+}
+
+}  // namespace
+
+int64_t SpanNowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - g_span_epoch)
+      .count();
+}
+
+void SpansSetActive(bool active) {
+  g_spans_active.store(active, std::memory_order_relaxed);
+}
+
+void SpanRecord(const char* name, int64_t start_us, int64_t duration_us, const char* detail) {
+  Push(name, detail, start_us, duration_us, false);
+}
+
+void SpanRecordAsync(const char* name, int64_t start_us, int64_t duration_us, const char* detail) {
+  Push(name, detail, start_us, duration_us, true);
+}
+
+const char* SpanInternName(const std::string& name) {
+  thread_local std::unordered_map<std::string, const char*> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) return it->second;
+  const char* interned;
+  {
+    SpanRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    interned = registry.names.insert(name).first->c_str();
+  }
+  cache.emplace(name, interned);
+  return interned;
+}
+
+void SpanSetThreadName(const char* name) {
+  ThreadSpans& thread = t_spans;
+  thread.name = name;
+  if (thread.tid == 0) return;
+  SpanRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.thread_names[thread.tid] = name;
+}
+
+std::string SpansExportChromeJson(bool clear) {
+  SpanRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<Span> spans;
+  for (const auto& ring : registry.rings) {
+    const uint64_t head = CollectRing(*ring, &spans);
+    if (clear) ring->floor.store(head, std::memory_order_relaxed);
+  }
+  std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.start_us < b.start_us; });
+
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  out.append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"flutter_thermal_printer_windows\"}}");
+  for (const auto& entry : registry.thread_names) {
+    out.append(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(entry.first) +
+               ",\"args\":{\"name\":\"");
+    AppendEscaped(&out, entry.second);
+    out.append("\"}}");
+  }
+  uint64_t next_async_id = 1;
+  for (const auto& span : spans) {
+    if (span.async) {
+      const uint64_t id = next_async_id++;
+      AppendEvent(&out, span, "b", span.start_us, id, true);
+      AppendEvent(&out, span, "e", span.start_us + span.duration_us, id, false);
+    } else {
+      AppendEvent(&out, span, "X", span.start_us, 0, true);
+    }
+  }
+  out.append("]}\n");
+  return out;
+}
+
+size_t SpansRecorded() {
+  SpanRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  size_t total = 0;
+  for (const auto& ring : registry.rings) {
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t first = head > kSpanRingSize ? head - kSpanRingSize : 0;
+    first = std::max(first, ring->floor.load(std::memory_order_relaxed));
+    total += static_cast<size_t>(head - first);
+  }
+  return total;
+}
+
+}  // namespace flutter_thermal_printer_windows
@@ -0,0 +1,76 @@
+#ifndef FLUTTER_PLUGIN_TRACE_SPANS_H_
+#define FLUTTER_PLUGIN_TRACE_SPANS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace flutter_thermal_printer_windows {
+
+/// Timing spans of native stages (opt-in, see setSpanTracing), exported as
+/// Chrome trace-event JSON for chrome://tracing or Perfetto.
+///
+/// Each thread records into its own fixed-size ring, written without locks
+/// by that thread only; when a ring is full the oldest spans are dropped.
+/// Names are not copied: pass string literals or SpanInternName results.
+
+extern std::atomic<bool> g_spans_active;
+
+/// Cheap check for hot paths; recording is skipped when false.
+inline bool SpansActive() {
+  return g_spans_active.load(std::memory_order_relaxed);
+}
+
+/// Spans kept per thread.
+constexpr size_t kSpanRingSize = 8192;
+
+/// Microseconds on the steady clock since the plugin was loaded.
+int64_t SpanNowUs();
+
+/// Starts or stops recording. Recorded spans stay until exported with clear.
+void SpansSetActive(bool active);
+
+/// Records a span that ran on the calling thread.
+void SpanRecord(const char* name, int64_t start_us, int64_t duration_us, const char* detail = nullptr);
+
+/// Records a span that started elsewhere, e.g. queue wait or a WinRT
+/// operation finishing on a Completed handler. Exported as an async slice,
+/// so overlapping ones do not have to nest.
+void SpanRecordAsync(const char* name, int64_t start_us, int64_t duration_us, const char* detail = nullptr);
+
+/// Stable copy of a runtime string for span names and details, kept for the
+/// life of the process. Only a thread's first request for a string takes a
+/// lock; call it when SpansActive() or once per connection.
+const char* SpanInternName(const std::string& name);
+
+/// Names the calling thread's track in the export ([name] is not copied).
+void SpanSetThreadName(const char* name);
+
+/// Chrome trace-event JSON of all recorded spans. With [clear], exported
+/// spans are not exported again.
+std::string SpansExportChromeJson(bool clear);
+
+/// Spans currently held in all rings (tests).
+size_t SpansRecorded();
+
+/// Records the enclosing scope as a span when tracing is active.
+class ScopedSpan {
+ public:
+  explicit ScopedSpan(const char* name, const char* detail = nullptr)
+      : name_(name), detail_(detail), start_us_(SpansActive() ? SpanNowUs() : -1) {}
+  ~ScopedSpan() {
+    if (start_us_ >= 0) SpanRecord(name_, start_us_, SpanNowUs() - start_us_, detail_);
+  }
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+ private:
+  const char* name_;
+  const char* detail_;
+  int64_t start_us_;
+};
+
+}  // namespace flutter_thermal_printer_windows
+
+#endif  // FLUTTER_PLUGIN_TRACE_SPANS_H_